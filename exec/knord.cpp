@@ -25,6 +25,11 @@
 #include "dist_task_coordinator.hpp"
 #include "dist_coordinator.hpp"
 #include "io.hpp"
+#include "matrix_file.hpp"
+#include "numa_mem.hpp"
+#include "topology.hpp"
+#include "kmeans.hpp"
+#include "mpi.hpp"
 
 static int rank;
 static int nprocs;
@@ -46,6 +51,9 @@ int main(int argc, char* argv[]) {
 
     std::string dist_type = "eucl";
     std::string centersfn = "";
+    std::string weightsfn = "";
+    std::string asgnfn = ""; // Non-empty means predict with the -C centers
+    std::string distfn = "";
 	unsigned max_iters=std::numeric_limits<unsigned>::max();
 	std::string init = "kmeanspp";
 	unsigned nthread = kpmbase::get_num_omp_threads();
@@ -54,13 +62,16 @@ int main(int argc, char* argv[]) {
     bool no_prune = false;
     unsigned nnodes = numa_num_task_nodes();
     std::string outdir = "";
+    kpmbase::read_opts io_opts; // How the pthread engines read the data
+    kpmbase::bind_policy_t bind_policy = kpmbase::bind_policy_t::NODE;
+    bool bind_smt = false; // Pin threads to SMT siblings too
 
     // Increase by 3 -- getopt ignores argv[0]
 	argv += 3;
 	argc -= 3;
 
 	signal(SIGINT, kpmbase::int_handler);
-	while ((opt = getopt(argc, argv, "l:i:t:T:d:C:PN:o:")) != -1) {
+	while ((opt = getopt(argc, argv, "l:i:t:T:d:C:PN:o:w:A:D:q:uG:b:Y")) != -1) {
 		num_opts++;
 		switch (opt) {
 			case 'l':
@@ -102,6 +113,38 @@ int main(int argc, char* argv[]) {
 				outdir = std::string(optarg);
 				num_opts++;
 				break;
+			case 'w':
+				weightsfn = std::string(optarg);
+				num_opts++;
+				break;
+			case 'A':
+				asgnfn = std::string(optarg);
+				num_opts++;
+				break;
+			case 'D':
+				distfn = std::string(optarg);
+				num_opts++;
+				break;
+			case 'q':
+				io_opts.depth = atoi(optarg);
+				num_opts++;
+				break;
+			case 'u':
+				io_opts.direct = true;
+				num_opts++;
+				break;
+			case 'G':
+				io_opts.page_bytes = kpmbase::get_page_bytes(optarg);
+				num_opts++;
+				break;
+			case 'b':
+				bind_policy = kpmbase::get_bind_policy(optarg);
+				num_opts++;
+				break;
+			case 'Y':
+				bind_smt = true;
+				num_opts++;
+				break;
 			default:
 				print_usage();
                 exit(EXIT_FAILURE);
@@ -111,7 +154,22 @@ int main(int argc, char* argv[]) {
     BOOST_ASSERT_MSG(!(init=="none" && centersfn.empty()),
             "Centers file name doesn't exit!");
 
-    if (kpmbase::filesize(datafn.c_str()) != (sizeof(double)*nrow*ncol))
+    if (init == "subsample")
+        throw kpmbase::thread_exception("The 'subsample' init is only"
+                " supported by knori");
+
+    // A file with a header gives its own shape. 0 on the command line => use it
+    kpmbase::matrix_header hdr;
+    const bool has_header = kpmbase::read_header(datafn, hdr);
+    if (has_header) {
+        if ((nrow && nrow != hdr.nrow) || (ncol && ncol != hdr.ncol))
+            throw kpmbase::io_exception("The file header says " +
+                    std::to_string(hdr.nrow) + " x " +
+                    std::to_string(hdr.ncol) + ".");
+        nrow = hdr.nrow;
+        ncol = hdr.ncol;
+    } else if (kpmbase::filesize(datafn.c_str()) !=
+            (sizeof(double)*nrow*ncol))
         throw kpmbase::io_exception("File size does not match input size.");
 
     double* p_centers = NULL;
@@ -123,6 +181,56 @@ int main(int argc, char* argv[]) {
         printf("Read centers!\n");
     }
 
+    if (!asgnfn.empty()) {
+        if (NULL == p_centers)
+            throw kpmbase::not_implemented_exception();
+        if (MPI_Init(&argc, &argv) != MPI_SUCCESS)
+            throw std::runtime_error("MPI_Init error\n");
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+
+        // The outputs are written in place by every process, never truncated
+        if (rank == root) {
+            remove(asgnfn.c_str());
+            if (!distfn.empty())
+                remove(distfn.c_str());
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+
+        // Same row partitioning as the engines: the last process takes the
+        //  remainder
+        const size_t start_row = (nrow/nprocs)*rank;
+        const size_t nlocal = (rank == nprocs - 1) ?
+            (nrow/nprocs) + (nrow % nprocs) : nrow/nprocs;
+        std::vector<size_t> local_cnt(k), clust_asgn_cnt(k);
+        kpmeans::omp::predict_file(datafn, start_row, nlocal, p_centers, ncol,
+                k, asgnfn, distfn, &local_cnt[0], nthread,
+                kpmeans::omp::DEFAULT_PREDICT_CHUNK_ROWS, dist_type,
+                kpmbase::get_data_offset(datafn));
+        kpmeans::mpi::mpi::reduce_size_t(&local_cnt[0], &clust_asgn_cnt[0],
+                k);
+
+        if (rank == root) {
+            printf("Cluster counts: ");
+            kpmbase::print_vector<size_t>(clust_asgn_cnt);
+        }
+        MPI_Finalize();
+        delete [] p_centers;
+        return EXIT_SUCCESS;
+    }
+
+    // One double per row. Every process reads all & keeps its partition
+    std::vector<double> weights;
+    if (!weightsfn.empty()) {
+        if (kpmbase::filesize(weightsfn.c_str()) != (sizeof(double)*nrow))
+            throw kpmbase::io_exception("Weights file size does not match"
+                    " the number of rows.");
+        weights.resize(nrow);
+        kpmbase::bin_io<double> bw(weightsfn, nrow, 1);
+        bw.read(&weights);
+    }
+    const double* p_weights = weights.empty() ? NULL : &weights[0];
+
     kpmbase::kmeans_t ret; // Only root fills this
 
     if (no_prune) {
@@ -130,6 +238,10 @@ int main(int argc, char* argv[]) {
             kpmeans::dist::dist_coordinator::create(argc, argv,
                     datafn, nrow, ncol, k, max_iters, nnodes, nthread,
                     p_centers, init, tolerance, dist_type);
+        dc->set_weights(p_weights);
+        dc->set_read_opts(io_opts);
+        if (bind_policy != kpmbase::bind_policy_t::NODE)
+            dc->set_thread_binding(bind_policy, bind_smt);
         std::static_pointer_cast<kpmeans::dist::dist_coordinator>(
                 dc)->run_kmeans(ret, outdir);
     } else {
@@ -137,6 +249,10 @@ int main(int argc, char* argv[]) {
             kpmeans::prune::dist_task_coordinator::create(argc, argv,
                     datafn, nrow, ncol, k, max_iters, nnodes, nthread,
                     p_centers, init, tolerance, dist_type);
+        dc->set_weights(p_weights);
+        dc->set_read_opts(io_opts);
+        if (bind_policy != kpmbase::bind_policy_t::NODE)
+            dc->set_thread_binding(bind_policy, bind_smt);
         std::static_pointer_cast<kpmeans::prune::dist_task_coordinator>(
                 dc)->run_kmeans(ret, outdir);
     }
@@ -159,4 +275,20 @@ void print_usage() {
     fprintf(stderr, "-P DO NOT use the minimal triangle inequality (~Elkan's alg)\n");
     fprintf(stderr, "-N No. of numa nodes you want to use\n");
     fprintf(stderr, "-o Write output to an output directory of this name\n");
+    fprintf(stderr, "-w File of `nsamples' binary doubles weighing each row"
+            " in the means & the kmeans++ sampling\n");
+    fprintf(stderr, "-A File to write each row's nearest -C center to"
+            " (binary unsigned). Only labels the rows: no clustering\n");
+    fprintf(stderr, "-D With -A, file to write each row's distance to its"
+            " center to (binary double)\n");
+    fprintf(stderr, "-q depth: Reads each thread keeps in flight loading its"
+            " rows (4)\n");
+    fprintf(stderr, "-u Load the rows with direct I/O (O_DIRECT)\n");
+    fprintf(stderr, "-G page_size: Back the rows & per-row arrays of the"
+            " pthread engines with huge pages: 2M or 1G (4K)\n");
+    fprintf(stderr, "-b policy: Pin the pthread engines' threads to cores."
+            " pack: fill a node first, spread: over the nodes by core count,"
+            " node: bind to a node only (node)\n");
+    fprintf(stderr, "-Y With -b, also pin threads to SMT siblings"
+            " (hyperthreads)\n");
 }
@@ -23,13 +23,20 @@
 
 #include "signal.h"
 #include "io.hpp"
+#include "matrix_file.hpp"
+#include "numa_mem.hpp"
+#include "topology.hpp"
 #include "kmeans.hpp"
 
 #include "kmeans_coordinator.hpp"
 #include "kmeans_task_coordinator.hpp"
+#include "kmeans_minibatch_coordinator.hpp"
+#include "kmeans_sweep_coordinator.hpp"
+#include "kmeans_xmeans_coordinator.hpp"
 #include "util.hpp"
 
 static void print_usage();
+static std::vector<unsigned> parse_ks(const std::string arg);
 
 int main(int argc, char* argv[]) {
 
@@ -46,22 +53,45 @@ int main(int argc, char* argv[]) {
 
     std::string dist_type = "eucl";
     std::string centersfn = "";
+    std::string weightsfn = "";
+    std::string warmfn = ""; // Model to resume from
+    std::string modelfn = ""; // Model to write
+    std::string asgnfn = ""; // Non-empty means predict with the -C centers
+    std::string distfn = "";
+    std::string convertfn = ""; // Non-empty means write the data with a header
 	size_t max_iters=std::numeric_limits<size_t>::max();
 	std::string init = "kmeanspp";
 	unsigned nthread = kpmbase::get_num_omp_threads();
 	int num_opts = 0;
 	double tolerance = -1;
+    double sse_tol = -1;
+    double shift_tol = -1;
+    bool exact_sse = false;
+    double sample_frac = kpmeans::DEFAULT_SAMPLE_FRAC;
+    size_t batch_size = 0;
+    size_t chunk_rows = 0; // > 0 means stream the input
+    std::string format = "bin";
+    std::string checkpoint_fn = "";
+    size_t checkpoint_rows = 0;
+    std::vector<unsigned> ks; // Non-empty means sweep over k
+    unsigned k_max = 0; // > 0 means X-means from k up to k_max
+    unsigned n_init = 1;
+    int index_checks = -1; // >= 0 assigns rows with a center k-d tree
+    unsigned branching = 0; // > 0 means bisecting kmeans
     bool no_prune = false;
     bool omp = false;
     unsigned nnodes = numa_num_task_nodes();
     std::string outdir = "";
+    kpmbase::read_opts io_opts; // How the pthread engines read the data
+    kpmbase::bind_policy_t bind_policy = kpmbase::bind_policy_t::NODE;
+    bool bind_smt = false; // Pin threads to SMT siblings too
 
     // Increase by 3 -- getopt ignores argv[0]
 	argv += 3;
 	argc -= 3;
 
 	signal(SIGINT, kpmbase::int_handler);
-	while ((opt = getopt(argc, argv, "l:i:t:T:d:C:PON:o:")) != -1) {
+	while ((opt = getopt(argc, argv, "l:i:t:T:d:C:PON:o:s:B:S:f:c:e:k:n:w:I:H:W:M:A:D:r:x:XK:F:q:uG:b:Y")) != -1) {
 		num_opts++;
 		switch (opt) {
 			case 'l':
@@ -107,6 +137,106 @@ int main(int argc, char* argv[]) {
 				outdir = std::string(optarg);
 				num_opts++;
 				break;
+			case 's':
+				sample_frac = atof(optarg);
+				num_opts++;
+				break;
+			case 'B':
+				batch_size = atol(optarg);
+				num_opts++;
+				break;
+			case 'S':
+				chunk_rows = atol(optarg);
+				num_opts++;
+				break;
+			case 'f':
+				format = std::string(optarg);
+				num_opts++;
+				break;
+			case 'c':
+				checkpoint_fn = std::string(optarg);
+				num_opts++;
+				break;
+			case 'e':
+				checkpoint_rows = atol(optarg);
+				num_opts++;
+				break;
+			case 'k':
+				ks = parse_ks(std::string(optarg));
+				num_opts++;
+				break;
+			case 'n':
+				n_init = atoi(optarg);
+				num_opts++;
+				break;
+			case 'w':
+				weightsfn = std::string(optarg);
+				num_opts++;
+				break;
+			case 'I':
+				index_checks = atoi(optarg);
+				num_opts++;
+				break;
+			case 'H':
+				branching = atoi(optarg);
+				num_opts++;
+				break;
+			case 'W':
+				warmfn = std::string(optarg);
+				num_opts++;
+				break;
+			case 'M':
+				modelfn = std::string(optarg);
+				num_opts++;
+				break;
+			case 'A':
+				asgnfn = std::string(optarg);
+				num_opts++;
+				break;
+			case 'D':
+				distfn = std::string(optarg);
+				num_opts++;
+				break;
+			case 'q':
+				io_opts.depth = atoi(optarg);
+				num_opts++;
+				break;
+			case 'u':
+				io_opts.direct = true;
+				num_opts++;
+				break;
+			case 'G':
+				io_opts.page_bytes = kpmbase::get_page_bytes(optarg);
+				num_opts++;
+				break;
+			case 'b':
+				bind_policy = kpmbase::get_bind_policy(optarg);
+				num_opts++;
+				break;
+			case 'Y':
+				bind_smt = true;
+				num_opts++;
+				break;
+			case 'r':
+				sse_tol = atof(optarg);
+				num_opts++;
+				break;
+			case 'x':
+				shift_tol = atof(optarg);
+				num_opts++;
+				break;
+			case 'X':
+				exact_sse = true;
+				num_opts++;
+				break;
+			case 'K':
+				k_max = atoi(optarg);
+				num_opts++;
+				break;
+			case 'F':
+				convertfn = std::string(optarg);
+				num_opts++;
+				break;
 			default:
 				print_usage();
 		}
@@ -119,9 +249,43 @@ int main(int argc, char* argv[]) {
     BOOST_ASSERT_MSG(!(init=="none" && centersfn.empty()),
             "Centers file name doesn't exit!");
 
-    if (kpmbase::filesize(datafn.c_str()) != (sizeof(double)*nrow*ncol))
+    const bool sparse = format == "csr";
+    // A file with a header gives its own shape. 0 on the command line => use it
+    kpmbase::matrix_header hdr;
+    const bool has_header = !chunk_rows && !sparse &&
+        kpmbase::read_header(datafn, hdr);
+    if (has_header) {
+        if ((nrow && nrow != hdr.nrow) || (ncol && ncol != hdr.ncol))
+            throw kpmbase::io_exception("The file header says " +
+                    std::to_string(hdr.nrow) + " x " +
+                    std::to_string(hdr.ncol) + ".");
+        nrow = hdr.nrow;
+        ncol = hdr.ncol;
+    } else if (!chunk_rows && !sparse && kpmbase::filesize(datafn.c_str()) !=
+            (sizeof(double)*nrow*ncol))
         throw kpmbase::io_exception("File size does not match input size.");
 
+    // Checked once the header, if any, has given the # of rows
+    for (unsigned sweep_k : ks) {
+        if (sweep_k > nrow) {
+            fprintf(stderr, "[FATAL]: Every k in a sweep must be <= the %lu"
+                    " rows, got %u\n", nrow, sweep_k);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (!convertfn.empty()) {
+        if (chunk_rows || sparse || has_header)
+            throw kpmbase::not_implemented_exception();
+        std::vector<double> data(nrow*ncol);
+        kpmbase::bin_io<double> br(datafn, nrow, ncol);
+        br.read(&data);
+        kpmbase::write_matrix(convertfn, &data[0], nrow, ncol);
+        printf("Wrote %lu x %lu with a header to '%s'\n", nrow, ncol,
+                convertfn.c_str());
+        return EXIT_SUCCESS;
+    }
+
     double* p_centers = NULL;
     kpmbase::kmeans_t ret;
 
@@ -132,11 +296,154 @@ int main(int argc, char* argv[]) {
         printf("Read centers!\n");
     } else
         printf("No centers to read ..\n");
-    if (omp) {
-        kpmbase::bin_io<double> br(datafn, nrow, ncol);
-        double* p_data = new double [nrow*ncol];
-        br.read(p_data);
-        printf("Read data!\n");
+    if (batch_size && omp)
+        throw kpmbase::not_implemented_exception();
+
+    if (!asgnfn.empty()) {
+        if (NULL == p_centers || sparse || chunk_rows)
+            throw kpmbase::not_implemented_exception();
+        // The outputs are written in place, never truncated
+        remove(asgnfn.c_str());
+        if (!distfn.empty())
+            remove(distfn.c_str());
+
+        std::vector<size_t> clust_asgn_cnt(k);
+        kpmeans::omp::predict_file(datafn, 0, nrow, p_centers, ncol, k,
+                asgnfn, distfn, &clust_asgn_cnt[0], nthread,
+                kpmeans::omp::DEFAULT_PREDICT_CHUNK_ROWS, dist_type,
+                kpmbase::get_data_offset(datafn));
+        printf("Cluster counts: ");
+        kpmbase::print_vector<size_t>(clust_asgn_cnt);
+        delete [] p_centers;
+        return EXIT_SUCCESS;
+    }
+
+    // One double per row, in row order
+    std::vector<double> weights;
+    if (!weightsfn.empty()) {
+        if (chunk_rows)
+            throw kpmbase::not_implemented_exception();
+        if (kpmbase::filesize(weightsfn.c_str()) != (sizeof(double)*nrow))
+            throw kpmbase::io_exception("Weights file size does not match"
+                    " the number of rows.");
+        weights.resize(nrow);
+        kpmbase::bin_io<double> bw(weightsfn, nrow, 1);
+        bw.read(&weights);
+        printf("Read weights!\n");
+    }
+    const double* p_weights = weights.empty() ? NULL : &weights[0];
+
+    if (!ks.empty() && (omp || no_prune || batch_size || chunk_rows))
+        throw kpmbase::not_implemented_exception();
+    if (n_init > 1 && ((no_prune && !omp) || batch_size || chunk_rows ||
+                !ks.empty()))
+        throw kpmbase::not_implemented_exception();
+    // The center index replaces the full scan of the unpruned engines only
+    if (index_checks >= 0 && (!no_prune || batch_size || chunk_rows ||
+                !ks.empty() || sparse))
+        throw kpmbase::not_implemented_exception();
+    // Mini-batch steps are euclidean only
+    if (batch_size && dist_type != "eucl")
+        throw kpmbase::not_implemented_exception();
+    if (sparse && (batch_size || chunk_rows || !ks.empty() || n_init > 1 ||
+                !weightsfn.empty()))
+        throw kpmbase::not_implemented_exception();
+
+    if (branching && (batch_size || chunk_rows || !ks.empty() || n_init > 1
+                || index_checks >= 0 || sparse || init == "none"))
+        throw kpmbase::not_implemented_exception();
+
+    // The objective stopping rules live in the single model pthread runs
+    if ((sse_tol >= 0 || shift_tol >= 0 || exact_sse) && (omp || batch_size
+                || chunk_rows || !ks.empty() || n_init > 1 || sparse ||
+                branching))
+        throw kpmbase::not_implemented_exception();
+    // Resuming is only implemented for the pruned pthread engine
+    if (!warmfn.empty() && (omp || no_prune || batch_size || chunk_rows ||
+                !ks.empty() || n_init > 1 || sparse || branching))
+        throw kpmbase::not_implemented_exception();
+    if (!modelfn.empty() && (chunk_rows || !ks.empty()))
+        throw kpmbase::not_implemented_exception();
+
+    // X-means grows k with the pruned pthread engine
+    if (k_max && (k_max < k || omp || no_prune || batch_size || chunk_rows
+                || !ks.empty() || n_init > 1 || sparse || branching ||
+                init == "none" || !warmfn.empty() || sse_tol >= 0 ||
+                shift_tol >= 0 || exact_sse))
+        throw kpmbase::not_implemented_exception();
+
+    kpmbase::cluster_tree::ptr tree = NULL;
+    std::vector<double> bounds; // Stored with the model when known
+    if (!ks.empty()) {
+        kpmprune::kmeans_sweep_coordinator::ptr kc =
+            kpmprune::kmeans_sweep_coordinator::create(datafn, nrow, ncol,
+                    ks, max_iters, nnodes, nthread, init, tolerance, dist_type);
+        kc->set_sample_frac(sample_frac);
+        kc->set_weights(p_weights);
+        kc->set_read_opts(io_opts);
+        if (bind_policy != kpmbase::bind_policy_t::NODE)
+            kc->set_thread_binding(bind_policy, bind_smt);
+        std::vector<kpmbase::kmeans_t> rets = kc->run_sweep();
+
+        if (!outdir.empty()) {
+            for (unsigned idx = 0; idx < rets.size(); idx++) {
+                std::string dir = outdir + "/k" + std::to_string(ks[idx]);
+                printf("\nWriting output to '%s'\n", dir.c_str());
+                rets[idx].write(dir);
+            }
+        }
+        return EXIT_SUCCESS;
+    }
+
+    if (k_max) {
+        kpmprune::kmeans_xmeans_coordinator::ptr kc =
+            kpmprune::kmeans_xmeans_coordinator::create(datafn, nrow, ncol,
+                    k, k_max, max_iters, nnodes, nthread, init, tolerance,
+                    dist_type);
+        kc->set_sample_frac(sample_frac);
+        kc->set_weights(p_weights);
+        kc->set_read_opts(io_opts);
+        if (bind_policy != kpmbase::bind_policy_t::NODE)
+            kc->set_thread_binding(bind_policy, bind_smt);
+        ret = kc->run_kmeans();
+    } else if (sparse) {
+        kpmbase::csr_matrix::ptr mat = kpmbase::csr_matrix::load(datafn);
+        if (mat->get_nrow() != nrow || mat->get_ncol() != ncol)
+            throw kpmbase::io_exception("CSR header shape does not match"
+                    " input size.");
+        printf("Read %lu nonzeros!\n", mat->get_nnz());
+
+        std::vector<unsigned> clust_asgns(nrow);
+        std::vector<size_t> clust_asgn_cnt(k);
+        if (NULL == p_centers)
+            p_centers = new double [k*ncol];
+
+        ret = kpmeans::omp::compute_sparse_kmeans(mat, p_centers,
+                &clust_asgns[0], &clust_asgn_cnt[0], k, max_iters, nthread,
+                init, tolerance, dist_type);
+    } else if (chunk_rows) {
+        if (NULL == p_centers)
+            p_centers = new double [k*ncol];
+
+        ret = kpmeans::omp::compute_stream_kmeans(datafn, format, p_centers,
+                ncol, k, nthread, chunk_rows, 4,
+                centersfn.empty() ? "forgy" : "none",
+                checkpoint_fn, checkpoint_rows);
+    } else if (omp || branching) {
+        // Mapped in place when the file has a header
+        kpmbase::mapped_rows::ptr mapped;
+        double* p_data;
+        if (has_header) {
+            mapped = kpmbase::mapped_rows::create(datafn, hdr.alignment,
+                    sizeof(double)*nrow*ncol);
+            p_data = mapped->get_data();
+            printf("Mapped data!\n");
+        } else {
+            kpmbase::bin_io<double> br(datafn, nrow, ncol);
+            p_data = new double [nrow*ncol];
+            br.read(p_data);
+            printf("Read data!\n");
+        }
 
         unsigned* p_clust_asgns = new unsigned [nrow];
         size_t* p_clust_asgn_cnt = new size_t [k];
@@ -144,38 +451,94 @@ int main(int argc, char* argv[]) {
         if (NULL == p_centers) // We have no preallocated centers
             p_centers = new double [k*ncol];
 
-        if (no_prune) {
+        if (branching) {
+            ret = kpmeans::omp::compute_bisecting_kmeans(p_data, p_centers,
+                    p_clust_asgns, p_clust_asgn_cnt, nrow, ncol, k, max_iters,
+                    nthread, branching, init, tolerance, dist_type, p_weights,
+                    &tree);
+        } else if (no_prune) {
             ret = kpmeans::omp::compute_kmeans(p_data, p_centers, p_clust_asgns,
                     p_clust_asgn_cnt, nrow, ncol, k, max_iters,
-                    nthread, init, tolerance, dist_type);
+                    nthread, init, tolerance, dist_type, n_init, p_weights,
+                    index_checks);
         } else {
             ret = kpmeans::omp::compute_min_kmeans(p_data, p_centers, p_clust_asgns,
                     p_clust_asgn_cnt, nrow, ncol, k, max_iters,
-                    nthread, init, tolerance, dist_type);
+                    nthread, init, tolerance, dist_type, n_init, p_weights);
         }
 
         delete [] p_clust_asgns;
         delete [] p_clust_asgn_cnt;
-        delete [] p_data;
+        if (!mapped)
+            delete [] p_data;
     } else {
-        if (no_prune) {
+        if (batch_size) {
+            kpmprune::kmeans_minibatch_coordinator::ptr kc =
+                kpmprune::kmeans_minibatch_coordinator::create(
+                    datafn, nrow, ncol, k, max_iters, nnodes, nthread,
+                    batch_size, p_centers, init, tolerance, dist_type);
+            kc->set_sample_frac(sample_frac);
+            kc->set_weights(p_weights);
+            kc->set_read_opts(io_opts);
+            if (bind_policy != kpmbase::bind_policy_t::NODE)
+                kc->set_thread_binding(bind_policy, bind_smt);
+            ret = kc->run_kmeans();
+        } else if (no_prune) {
             kpmeans::kmeans_coordinator::ptr kc =
                 kpmeans::kmeans_coordinator::create(datafn,
                     nrow, ncol, k, max_iters, nnodes, nthread, p_centers,
                     init, tolerance, dist_type);
+            kc->set_sample_frac(sample_frac);
+            kc->set_weights(p_weights);
+            kc->set_read_opts(io_opts);
+            if (bind_policy != kpmbase::bind_policy_t::NODE)
+                kc->set_thread_binding(bind_policy, bind_smt);
+            kc->set_sse_tolerance(sse_tol);
+            kc->set_shift_tolerance(shift_tol);
+            if (index_checks >= 0)
+                std::static_pointer_cast<kpmeans::kmeans_coordinator>(kc)->
+                    set_index_checks(index_checks);
             ret = kc->run_kmeans();
         } else {
             kpmprune::kmeans_task_coordinator::ptr kc =
                 kpmprune::kmeans_task_coordinator::create(
                     datafn, nrow, ncol, k, max_iters, nnodes, nthread, p_centers,
                     init, tolerance, dist_type);
+            kc->set_sample_frac(sample_frac);
+            kc->set_weights(p_weights);
+            kc->set_read_opts(io_opts);
+            if (bind_policy != kpmbase::bind_policy_t::NODE)
+                kc->set_thread_binding(bind_policy, bind_smt);
+            kc->set_sse_tolerance(sse_tol);
+            kc->set_shift_tolerance(shift_tol);
+            kc->set_exact_sse(exact_sse);
+            std::shared_ptr<kpmprune::kmeans_task_coordinator> tc =
+                std::static_pointer_cast<kpmprune::kmeans_task_coordinator>(kc);
+            tc->set_n_init(n_init);
+            if (!warmfn.empty()) {
+                std::vector<double> prev_bounds;
+                kpmbase::kmeans_t prev =
+                    kpmbase::kmeans_t::read_model(warmfn, prev_bounds);
+                printf("Resuming from a model of %lu rows!\n", prev.nrow);
+                tc->set_warm_start(prev, prev_bounds);
+            }
             ret = kc->run_kmeans();
+            tc->get_bounds(bounds);
         }
     }
 
+    if (!modelfn.empty()) {
+        printf("\nWriting the model to '%s'\n", modelfn.c_str());
+        ret.write_model(modelfn, bounds);
+    }
+
     if (!outdir.empty()) {
         printf("\nWriting output to '%s'\n", outdir.c_str());
         ret.write(outdir);
+        // Alongside kmeans_t.yml, which falls back to the cwd
+        if (tree)
+            tree->write(kpmbase::is_file_exist(outdir.c_str()) ?
+                    outdir + "/tree.yml" : "tree.yml");
     }
 
     if (p_centers) delete [] p_centers;
@@ -187,7 +550,7 @@ void print_usage() {
 	fprintf(stderr,
         "knori data-file nsamples dim k [alg-options]\n");
     fprintf(stderr, "-t type: type of initialization for kmeans"
-           " ['random', 'forgy', 'kmeanspp', 'none']\n");
+           " ['random', 'forgy', 'kmeanspp', 'subsample', 'none']\n");
     fprintf(stderr, "-T num_thread: The number of threads to run\n");
     fprintf(stderr, "-i iters: maximum number of iterations\n");
     fprintf(stderr, "-C File with initial clusters in same format as data\n");
@@ -197,5 +560,91 @@ void print_usage() {
     fprintf(stderr, "-O Use OpenMP for ||ization rather than fast pthreads\n");
     fprintf(stderr, "-N No. of numa nodes you want to use\n");
     fprintf(stderr, "-o Write output to an output directory of this name\n");
+    fprintf(stderr, "-s Fraction of rows clustered by the 'subsample' init"
+            " (0.02)\n");
+    fprintf(stderr, "-B batch_size: Run mini-batch kmeans sampling this many"
+            " rows per step. With -l the run stops once no center moves"
+            " further than the tolerance\n");
+    fprintf(stderr, "-k Sweep over k with one pass over the data per"
+            " iteration: a list '8,16,32' or a range 'start:end[:step]'."
+            " Output goes to outdir/k<k>\n");
+    fprintf(stderr, "-n n_init: Run this many restarts & keep the one with"
+            " the lowest SSE. The pthread engine interleaves them in each"
+            " pass over the data\n");
+    fprintf(stderr, "-w File of `nsamples' binary doubles weighing each row"
+            " in the means, the kmeans++ sampling & the SSE\n");
+    fprintf(stderr, "-I max_checks: With -P, assign rows by querying a"
+            " k-d tree over the centers rebuilt each iteration. 0 => exact,"
+            " > 0 => stop after this many distance computations per row\n");
+    fprintf(stderr, "-H branching: Bisecting kmeans. Split the leaves with"
+            " the largest SSE this many ways (>= 2) with OpenMP until there"
+            " are k leaves. The tree is written to outdir/tree.yml\n");
+    fprintf(stderr, "-M File to write the model (centroids, assignments &"
+            " row bounds) to in binary\n");
+    fprintf(stderr, "-W Resume from a model written with -M on a prefix of"
+            " the rows (e.g. before appending new data). k must match\n");
+    fprintf(stderr, "-A File to write each row's nearest -C center to"
+            " (binary unsigned). Only labels the rows: no clustering\n");
+    fprintf(stderr, "-D With -A, file to write each row's distance to its"
+            " center to (binary double)\n");
+    fprintf(stderr, "-q depth: Reads each thread keeps in flight loading its"
+            " rows (4)\n");
+    fprintf(stderr, "-u Load the rows with direct I/O (O_DIRECT)\n");
+    fprintf(stderr, "-G page_size: Back the rows & per-row arrays of the"
+            " pthread engines with huge pages: 2M or 1G (4K)\n");
+    fprintf(stderr, "-b policy: Pin the pthread engines' threads to cores."
+            " pack: fill a node first, spread: over the nodes by core count,"
+            " node: bind to a node only (node)\n");
+    fprintf(stderr, "-Y With -b, also pin threads to SMT siblings"
+            " (hyperthreads)\n");
+    fprintf(stderr, "-r Also stop once the relative change in SSE is <= this."
+            " pthread engines only (not -B, -k or -n)\n");
+    fprintf(stderr, "-x Also stop once no center moves further than this."
+            " pthread engines only (not -B, -k or -n)\n");
+    fprintf(stderr, "-X Compute the SSE exactly each iteration. The pruned"
+            " engine otherwise sums its row bounds (an upper bound)\n");
+    fprintf(stderr, "-K k_max: X-means. Start from k & split centers while"
+            " a 2-means of their members improves the BIC, up to k_max\n");
+    fprintf(stderr, "-F Write the (raw) data file to this path with a"
+            " header giving its shape & exit. Such files are mapped rather"
+            " than read & `nsamples' & `dim' may then be 0\n");
+    fprintf(stderr, "-S chunk_rows: Stream the input in chunks of this many"
+            " rows with online kmeans. `nsamples' is ignored\n");
+    fprintf(stderr, "-f Input format ['bin', 'text', 'csr']. 'text' is only"
+            " streamed (-S). 'csr' is a sparse file (see sparse_matrix.hpp)"
+            " clustered with OpenMP\n");
+    fprintf(stderr, "-c File the streamed centers are checkpointed to\n");
+    fprintf(stderr, "-e Rows between checkpoints (0 => every chunk)\n");
     exit(EXIT_FAILURE);
 }
+
+std::vector<unsigned> parse_ks(const std::string arg) {
+    std::vector<unsigned> ks;
+
+    if (arg.find(':') != std::string::npos) {
+        unsigned start = 0, end = 0, step = 1;
+        int nparsed = sscanf(arg.c_str(), "%u:%u:%u", &start, &end, &step);
+        if (nparsed < 2 || step == 0 || start > end) {
+            fprintf(stderr, "[FATAL]: Malformed k range '%s', expected "
+                    "'start:end[:step]' with start <= end & step > 0\n",
+                    arg.c_str());
+            exit(EXIT_FAILURE);
+        }
+        for (unsigned k = start; k <= end && k >= start; k += step)
+            ks.push_back(k);
+    } else {
+        std::stringstream ss(arg);
+        std::string tok;
+        while (std::getline(ss, tok, ','))
+            ks.push_back(atol(tok.c_str()));
+    }
+
+    for (unsigned idx = 0; idx < ks.size(); idx++) {
+        if (ks[idx] < 2) {
+            fprintf(stderr, "[FATAL]: Every k in a sweep must be > 1, "
+                    "got '%s'\n", arg.c_str());
+            exit(EXIT_FAILURE);
+        }
+    }
+    return ks;
+}
@@ -0,0 +1,328 @@
+/*
+* Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <omp.h>
+#include <atomic>
+#include <exception>
+#include <queue>
+#include <thread>
+
+#include "kmeans.hpp"
+#include "cluster_tree.hpp"
+#include "io.hpp"
+#include "numa_mem.hpp"
+#include "util.hpp"
+
+namespace kpmbase = kpmeans::base;
+
+namespace {
+
+// A leaf that may still be split. Its rows are perm[begin, end)
+struct split_cand {
+    double sse;
+    unsigned node;
+    size_t begin, end;
+
+    // Largest SSE first
+    bool operator<(const split_cand& other) const {
+        return sse < other.sse;
+    }
+};
+
+// One split of a wave & everything it produces
+struct split_job {
+    split_cand cand;
+    unsigned b;
+    kpmbase::page_array<double>::ptr sub;
+    std::vector<double> sub_weights, centers;
+    std::vector<unsigned> asgns;
+    std::vector<size_t> counts, offsets;
+    size_t iters;
+    // Mean & SSE of each non-empty child
+    std::vector<std::vector<double> > means;
+    std::vector<double> sses;
+};
+
+/**
+ * \brief Weighted mean & SSE of the rows perm[begin, end).
+ */
+void node_stats(const double* matrix, const std::vector<size_t>& perm,
+        const size_t begin, const size_t end, const size_t ncol,
+        const double* weights, const int nthreads, std::vector<double>& mean,
+        double& sse) {
+    mean.assign(ncol, 0);
+    double tot_weight = 0;
+
+#pragma omp parallel num_threads(nthreads)
+    {
+        std::vector<double> lmean(ncol, 0);
+        double lweight = 0;
+#pragma omp for nowait
+        for (size_t i = begin; i < end; i++) {
+            const double w = weights ? weights[perm[i]] : 1;
+            const double* row = &matrix[perm[i]*ncol];
+            for (size_t col = 0; col < ncol; col++)
+                lmean[col] += w*row[col];
+            lweight += w;
+        }
+#pragma omp critical
+        {
+            for (size_t col = 0; col < ncol; col++)
+                mean[col] += lmean[col];
+            tot_weight += lweight;
+        }
+    }
+
+    for (size_t col = 0; col < ncol; col++)
+        mean[col] /= tot_weight;
+
+    sse = 0;
+#pragma omp parallel for reduction(+:sse) num_threads(nthreads)
+    for (size_t i = begin; i < end; i++) {
+        double dist = kpmbase::eucl_dist(&matrix[perm[i]*ncol], &mean[0],
+                ncol);
+        sse += weights ? weights[perm[i]]*dist*dist : dist*dist;
+    }
+}
+
+/**
+ * \brief Run `fn(job, team)` for jobs [0, njobs). The jobs share no rows so
+ *  they run at once, each on its own thread with its own OpenMP team of
+ *  `team` threads.
+ */
+template <typename Func>
+void for_each_job(const size_t njobs, const int nthreads, Func fn) {
+    const int nworkers = std::min<size_t>(njobs, nthreads);
+    const int team = std::max(1, nthreads/nworkers);
+    if (nworkers == 1) {
+        for (size_t job = 0; job < njobs; job++)
+            fn(job, team);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::vector<std::exception_ptr> errors(nworkers);
+    std::vector<std::thread> workers;
+    for (int w = 0; w < nworkers; w++)
+        workers.push_back(std::thread([&, w] {
+            try {
+                size_t job;
+                while ((job = next++) < njobs)
+                    fn(job, team);
+            } catch (...) {
+                errors[w] = std::current_exception();
+            }
+        }));
+    for (std::thread& worker : workers)
+        worker.join();
+    for (std::exception_ptr& error : errors)
+        if (error)
+            std::rethrow_exception(error);
+}
+} // End annon namespace
+
+namespace kpmeans { namespace omp {
+
+kpmbase::kmeans_t compute_bisecting_kmeans(const double* matrix,
+        double* clusters_ptr, unsigned* cluster_assignments,
+        size_t* cluster_assignment_counts, const size_t num_rows,
+        const size_t num_cols, const unsigned k, const size_t MAX_ITERS,
+        const int max_threads, const unsigned branching,
+        const std::string init, const double tolerance,
+        const std::string dist_type, const double* weights,
+        kpmbase::cluster_tree::ptr* tree_out) {
+    struct timeval start, end;
+
+    if (k > num_rows || k < 2) {
+        BOOST_LOG_TRIVIAL(fatal)
+            << "'k' must be between 2 and the number of rows in the matrix" <<
+            "k = " << k;
+        exit(-1);
+    }
+    BOOST_ASSERT_MSG(branching >= 2, "[FATAL]: The branching factor"
+            " must be >= 2");
+    // Each split seeds its own centers so there is nothing to start from
+    BOOST_ASSERT_MSG(init != "none", "[FATAL]: A bisecting run cannot start"
+            " from provided centers");
+
+    assert(max_threads > 0);
+    const int nthreads = std::min(max_threads,
+            kpmbase::get_num_omp_threads());
+    gettimeofday(&start , NULL);
+
+    kpmbase::cluster_tree::ptr tree = kpmbase::cluster_tree::create(num_cols,
+            kpmbase::get_dist_type(dist_type));
+    // The rows beneath every node are the contiguous range perm[begin, end)
+    std::vector<size_t> perm(num_rows);
+    for (size_t row = 0; row < num_rows; row++)
+        perm[row] = row;
+    std::vector<std::pair<size_t, size_t> > ranges;
+
+    std::priority_queue<split_cand> leaves;
+    std::vector<double> mean;
+    double sse;
+    node_stats(matrix, perm, 0, num_rows, num_cols, weights, nthreads, mean,
+            sse);
+    leaves.push(split_cand{sse, tree->add_node(kpmbase::INVALID_CLUSTER_ID,
+                &mean[0], num_rows, sse), 0, num_rows});
+    ranges.push_back(std::pair<size_t, size_t>(0, num_rows));
+
+    unsigned nleaves = 1;
+    size_t iters = 0;
+
+    while (nleaves < k && !leaves.empty()) {
+        // A wave takes the largest SSE leaves while there are clusters left
+        //  to split out. They hold disjoint rows so are split concurrently.
+        std::vector<split_job> wave;
+        unsigned budget = k - nleaves;
+        while (budget && !leaves.empty()) {
+            split_job job;
+            job.cand = leaves.top();
+            leaves.pop();
+            job.b = std::min<size_t>(std::min(branching, budget + 1),
+                    job.cand.end - job.cand.begin);
+            budget -= job.b - 1;
+            wave.push_back(std::move(job));
+        }
+
+        // Gather each subset contiguously. Its pages are left untouched so
+        //  the static split below places each where its rows are clustered.
+        for_each_job(wave.size(), nthreads, [&](const size_t j,
+                    const int team) {
+            split_job& job = wave[j];
+            const size_t nsub = job.cand.end - job.cand.begin;
+            job.sub = kpmbase::page_array<double>::create_untouched(
+                    nsub*num_cols);
+            double* sub = job.sub->data();
+#pragma omp parallel for schedule(static) num_threads(team)
+            for (size_t i = 0; i < nsub; i++)
+                std::copy(&matrix[perm[job.cand.begin+i]*num_cols],
+                        &matrix[(perm[job.cand.begin+i]+1)*num_cols],
+                        &sub[i*num_cols]);
+            if (weights) {
+                job.sub_weights.resize(nsub);
+                for (size_t i = 0; i < nsub; i++)
+                    job.sub_weights[i] = weights[perm[job.cand.begin+i]];
+            }
+            job.centers.resize(job.b*num_cols);
+            job.asgns.resize(nsub);
+            job.counts.resize(job.b);
+        });
+
+        for_each_job(wave.size(), nthreads, [&](const size_t j,
+                    const int team) {
+            split_job& job = wave[j];
+            const size_t nsub = job.cand.end - job.cand.begin;
+            BOOST_LOG_TRIVIAL(info) << "Splitting node " << job.cand.node
+                << " of " << nsub << " rows & SSE " << job.cand.sse << " "
+                << job.b << " ways";
+            kpmbase::kmeans_t ret = compute_min_kmeans(job.sub->data(),
+                    &job.centers[0], &job.asgns[0], &job.counts[0], nsub,
+                    num_cols, job.b, MAX_ITERS, team,
+                    init, tolerance, dist_type, 1,
+                    weights ? &job.sub_weights[0] : NULL);
+            job.iters = ret.iters;
+            job.sub = nullptr;
+
+            // Stable counting sort of the node's rows by child
+            job.offsets.assign(job.b+1, 0);
+            for (unsigned c = 0; c < job.b; c++)
+                job.offsets[c+1] = job.offsets[c] + job.counts[c];
+            std::vector<size_t> pos(job.offsets.begin(),
+                    job.offsets.end()-1);
+            std::vector<size_t> sorted(nsub);
+            for (size_t i = 0; i < nsub; i++)
+                sorted[pos[job.asgns[i]]++] = perm[job.cand.begin+i];
+            std::copy(sorted.begin(), sorted.end(),
+                    perm.begin()+job.cand.begin);
+
+            job.means.resize(job.b);
+            job.sses.assign(job.b, 0);
+            for (unsigned c = 0; c < job.b; c++)
+                if (job.counts[c])
+                    node_stats(matrix, perm, job.cand.begin+job.offsets[c],
+                            job.cand.begin+job.offsets[c+1], num_cols,
+                            weights, team, job.means[c], job.sses[c]);
+        });
+
+        // Grow the tree in wave order so node ids don't depend on timing
+        for (split_job& job : wave) {
+            iters += job.iters;
+
+            unsigned nchildren = 0;
+            for (unsigned c = 0; c < job.b; c++)
+                if (job.counts[c])
+                    nchildren++;
+            if (nchildren < 2) {
+                BOOST_LOG_TRIVIAL(warning) << "[WARNING]: Node "
+                    << job.cand.node << " cannot be split. Keeping it as a leaf";
+                continue;
+            }
+
+            for (unsigned c = 0; c < job.b; c++) {
+                if (!job.counts[c])
+                    continue;
+                const size_t begin = job.cand.begin + job.offsets[c];
+                const size_t end = job.cand.begin + job.offsets[c+1];
+                unsigned id = tree->add_node(job.cand.node, &job.means[c][0],
+                        end-begin, job.sses[c]);
+                ranges.push_back(std::pair<size_t, size_t>(begin, end));
+
+                // Identical rows (SSE 0) have nothing left to split
+                if (end - begin > 1 && job.sses[c] > 0)
+                    leaves.push(split_cand{job.sses[c], id, begin, end});
+            }
+            nleaves += nchildren - 1;
+        }
+    }
+
+    if (nleaves < k)
+        BOOST_LOG_TRIVIAL(warning) << "[WARNING]: Only " << nleaves
+            << " of the " << k << " clusters could be split out";
+
+    // Flatten: leaf `i' in depth first order is cluster `i'
+    BOOST_VERIFY(tree->number_leaves() == nleaves);
+    std::vector<double> centroids(nleaves*num_cols);
+    for (unsigned id = 0; id < tree->size(); id++) {
+        const unsigned clust_idx = tree->get_node(id).cluster_id;
+        if (clust_idx == kpmbase::INVALID_CLUSTER_ID)
+            continue;
+
+        std::copy(tree->get_mean(id), tree->get_mean(id)+num_cols,
+                &centroids[clust_idx*num_cols]);
+        cluster_assignment_counts[clust_idx] = tree->get_node(id).size;
+#pragma omp parallel for num_threads(nthreads)
+        for (size_t i = ranges[id].first; i < ranges[id].second; i++)
+            cluster_assignments[perm[i]] = clust_idx;
+    }
+    std::copy(centroids.begin(), centroids.end(), clusters_ptr);
+
+    gettimeofday(&end, NULL);
+    BOOST_LOG_TRIVIAL(info) << "\n\nAlgorithmic time taken = " <<
+        kpmbase::time_diff(start, end) << " sec\n";
+    BOOST_LOG_TRIVIAL(info) << "Bisecting kmeans built " << nleaves
+        << " clusters in a tree of " << tree->size() << " nodes & depth "
+        << tree->get_depth();
+
+    if (tree_out)
+        *tree_out = tree;
+    return kpmbase::kmeans_t(num_rows, num_cols, iters, nleaves,
+            cluster_assignments, cluster_assignment_counts, centroids);
+}
+} } // End namespace kpmeans, omp
@@ -25,8 +25,10 @@
 
 #include "kmeans.hpp"
 #include "clusters.hpp"
+#include "kd_tree.hpp"
 #include "io.hpp"
 #include "util.hpp"
+#include "padded.hpp"
 
 #define KM_TEST 0
 #define VERBOSE 0
@@ -35,14 +37,33 @@ namespace kpmbase = kpmeans::base;
 
 namespace {
 
-static size_t NUM_COLS;
-static size_t K;
-static size_t NUM_ROWS;
-short OMP_MAX_THREADS;
-static size_t g_num_changed = 0;
-static struct timeval start, end;
-static kpmbase::init_type_t g_init_type;
-static kpmbase::dist_type_t g_dist_type;
+/**
+ * \brief The state of one `compute_kmeans` run. Each call owns its own so
+ *  runs on different threads don't share anything.
+ */
+struct kmeans_ctx {
+    size_t ncol;
+    unsigned k;
+    size_t nrow;
+    int nthreads; // The team size of every parallel region of the run
+    size_t num_changed;
+    kpmbase::init_type_t init_type;
+    kpmbase::dist_type_t dist_type;
+    unsigned seed;
+    // Draws of every init. Reseeded from `seed' at the start of each run
+    std::default_random_engine generator;
+    const double* weights; // Per-row weights. NULL => all 1
+    kpmbase::kd_tree::ptr index; // Center index. NULL => scan
+    size_t max_checks; // Index distance computations. 0 => exact
+    // Per thread accumulators, kept across iterations. See `EM_step'
+    std::vector<kpmbase::clusters::ptr> pt_cl;
+
+    kmeans_ctx() : ncol(0), k(0), nrow(0), nthreads(1), num_changed(0),
+        init_type(kpmbase::init_type_t::NONE),
+        dist_type(kpmbase::dist_type_t::EUCL),
+        seed(std::default_random_engine::default_seed), weights(NULL),
+        max_checks(0) { }
+};
 
 /**
  * \brief This initializes clusters by randomly choosing sample
@@ -50,19 +71,23 @@ static kpmbase::dist_type_t g_dist_type;
  * See: http://en.wikipedia.org/wiki/K-means_clustering#Initialization_methods
  *	\param cluster_assignments Which cluster each sample falls into.
  */
-void random_partition_init(unsigned* cluster_assignments,
+void random_partition_init(kmeans_ctx& ctx,
+        unsigned* cluster_assignments,
         const double* matrix, std::shared_ptr<kpmbase::clusters> clusters,
         const size_t num_rows, const size_t num_cols, const unsigned k) {
     BOOST_LOG_TRIVIAL(info) << "Random init start";
 
-    std::default_random_engine generator;
     std::uniform_int_distribution<unsigned> distribution(0, k-1);
 
 //#pragma omp parallel for shared(cluster_assignments)
     for (size_t row = 0; row < num_rows; row++) {
-        unsigned asgnd_clust = distribution(generator);
+        unsigned asgnd_clust = distribution(ctx.generator);
 
-        clusters->add_member(&matrix[row*num_cols], asgnd_clust);
+        if (ctx.weights)
+            clusters->add_member(&matrix[row*num_cols], asgnd_clust,
+                    ctx.weights[row]);
+        else
+            clusters->add_member(&matrix[row*num_cols], asgnd_clust);
         cluster_assignments[row] = asgnd_clust;
     }
 
@@ -80,17 +105,16 @@ void random_partition_init(unsigned* cluster_assignments,
  * \param matrix the flattened matrix who's rows are being clustered.
  * \param clusters The cluster centers (means) flattened matrix.
  */
-void forgy_init(const double* matrix,
+void forgy_init(kmeans_ctx& ctx, const double* matrix,
         std::shared_ptr<kpmbase::clusters> clusters,
         const size_t num_rows, const size_t num_cols, const unsigned k) {
 
-    std::default_random_engine generator;
     std::uniform_int_distribution<size_t> distribution(0, num_rows-1);
 
     BOOST_LOG_TRIVIAL(info) << "Forgy init start";
 
     for (unsigned clust_idx = 0; clust_idx < k; clust_idx++) { // 0...K
-        size_t rand_idx = distribution(generator);
+        size_t rand_idx = distribution(ctx.generator);
         clusters->set_mean(&matrix[rand_idx*num_cols], clust_idx);
     }
 
@@ -101,13 +125,15 @@ void forgy_init(const double* matrix,
  * \brief A parallel version of the kmeans++ initialization alg.
  *  See: http://ilpubs.stanford.edu:8090/778/1/2006-13.pdf for algorithm
  */
-static void kmeanspp_init(const double* matrix, kpmbase::clusters::ptr clusters,
-        unsigned* cluster_assignments, std::vector<double>& dist_v) {
+static void kmeanspp_init(kmeans_ctx& ctx, const double* matrix,
+        kpmbase::clusters::ptr clusters, unsigned* cluster_assignments,
+        std::vector<double>& dist_v) {
 
     // Choose c1 uniformly at random
-    size_t selected_idx = random() % NUM_ROWS; // 0...(NUM_ROWS-1)
+    std::uniform_int_distribution<size_t> row_dist(0, ctx.nrow-1);
+    size_t selected_idx = row_dist(ctx.generator);
 
-    clusters->set_mean(&matrix[selected_idx*NUM_COLS], 0);
+    clusters->set_mean(&matrix[selected_idx*ctx.ncol], 0);
     dist_v[selected_idx] = 0.0;
     cluster_assignments[selected_idx] = 0;
 
@@ -121,32 +147,34 @@ static void kmeanspp_init(const double* matrix, kpmbase::clusters::ptr clusters,
     // Choose next center c_i with weighted prob
     while (true) {
         double cum_dist = 0;
-#pragma omp parallel for reduction(+:cum_dist) shared (dist_v)
-        for (size_t row = 0; row < NUM_ROWS; row++) {
-            double dist = kpmbase::dist_comp_raw(&matrix[row*NUM_COLS],
-                        &((clusters->get_means())[clust_idx*NUM_COLS]),
-                        NUM_COLS, g_dist_type);
+#pragma omp parallel for reduction(+:cum_dist) shared (dist_v) \
+        num_threads(ctx.nthreads)
+        for (size_t row = 0; row < ctx.nrow; row++) {
+            double dist = kpmbase::dist_comp_raw(&matrix[row*ctx.ncol],
+                        &((clusters->get_means())[clust_idx*ctx.ncol]),
+                        ctx.ncol, ctx.dist_type);
 
             if (dist < dist_v[row]) { // Found a closer cluster than before
                 dist_v[row] = dist;
                 cluster_assignments[row] = clust_idx;
             }
-            cum_dist += dist_v[row];
+            cum_dist += ctx.weights ? ctx.weights[row]*dist_v[row] :
+                dist_v[row];
         }
 
-        cum_dist = (cum_dist * ((double)random())) / (RAND_MAX - 1.0);
-        if (++clust_idx >= K)  // No more centers needed
+        cum_dist *= std::uniform_real_distribution<double>(0, 1)(ctx.generator);
+        if (++clust_idx >= ctx.k)  // No more centers needed
             break;
 
-        for (size_t i=0; i < NUM_ROWS; i++) {
-            cum_dist -= dist_v[i];
+        for (size_t i=0; i < ctx.nrow; i++) {
+            cum_dist -= ctx.weights ? ctx.weights[i]*dist_v[i] : dist_v[i];
             if (cum_dist <= 0) {
 #if KM_TEST
                 BOOST_LOG_TRIVIAL(info) << "Choosing "
                     << i << " as center K = " << clust_idx;
 #endif
                 cluster_assignments[i] = clust_idx;
-                clusters->set_mean(&(matrix[i*NUM_COLS]), clust_idx);
+                clusters->set_mean(&(matrix[i*ctx.ncol]), clust_idx);
                 break;
             }
         }
@@ -165,97 +193,134 @@ static void kmeanspp_init(const double* matrix, kpmbase::clusters::ptr clusters,
  * \param clusters The cluster centers (means) flattened matrix.
  *	\param cluster_assignments Which cluster each sample falls into.
  */
-static void EM_step(const double* matrix, kpmbase::clusters::ptr cls,
+static void EM_step(kmeans_ctx& ctx, const double* matrix,
+        kpmbase::clusters::ptr cls,
         unsigned* cluster_assignments, size_t* cluster_assignment_counts) {
 
-    std::vector<kpmbase::clusters::ptr> pt_cl(OMP_MAX_THREADS);
-    // Per thread changed cluster count. OMP_MAX_THREADS
-    std::vector<size_t> pt_num_change(OMP_MAX_THREADS);
-
-    for (int i = 0; i < OMP_MAX_THREADS; i++)
-        pt_cl[i] = kpmbase::clusters::create(K, NUM_COLS);
-
-#pragma omp parallel for firstprivate(matrix, pt_cl)\
-    shared(cluster_assignments) schedule(static)
-    for (size_t row = 0; row < NUM_ROWS; row++) {
-
-        size_t asgnd_clust = kpmbase::INVALID_CLUSTER_ID;
-        double best, dist;
-        dist = best = std::numeric_limits<double>::max();
-
-        for (unsigned clust_idx = 0; clust_idx < K; clust_idx++) {
-            dist = dist_comp_raw(&matrix[row*NUM_COLS],
-                    &(cls->get_means()[clust_idx*NUM_COLS]), NUM_COLS, g_dist_type);
-
-            if (dist < best) {
-                best = dist;
-                asgnd_clust = clust_idx;
+    // Per thread changed cluster count. ctx.nthreads. Padded so the
+    //  threads don't share cache lines as they count
+    std::vector<kpmbase::padded<size_t> > pt_num_change(ctx.nthreads);
+    if (ctx.pt_cl.size() != (size_t)ctx.nthreads)
+        ctx.pt_cl.assign(ctx.nthreads, kpmbase::clusters::ptr());
+
+#pragma omp parallel num_threads(ctx.nthreads)
+    {
+        const int thd = omp_get_thread_num();
+        // Each thread allocates & clears its own accumulators: first touch
+        //  keeps them on its node
+        if (!ctx.pt_cl[thd])
+            ctx.pt_cl[thd] = kpmbase::clusters::create(ctx.k, ctx.ncol);
+        else
+            ctx.pt_cl[thd]->clear();
+        kpmbase::clusters& pt_cl = *ctx.pt_cl[thd];
+
+#pragma omp for schedule(static)
+        for (size_t row = 0; row < ctx.nrow; row++) {
+
+            size_t asgnd_clust = kpmbase::INVALID_CLUSTER_ID;
+            double best, dist;
+            dist = best = std::numeric_limits<double>::max();
+
+            if (ctx.index) {
+                asgnd_clust = ctx.index->nearest(&matrix[row*ctx.ncol], best,
+                        ctx.max_checks);
+            } else {
+                for (unsigned clust_idx = 0; clust_idx < ctx.k; clust_idx++) {
+                    dist = dist_comp_raw(&matrix[row*ctx.ncol],
+                            &(cls->get_means()[clust_idx*ctx.ncol]), ctx.ncol,
+                            ctx.dist_type);
+
+                    if (dist < best) {
+                        best = dist;
+                        asgnd_clust = clust_idx;
+                    }
+                }
             }
-        }
 
-        BOOST_VERIFY(asgnd_clust != kpmbase::INVALID_CLUSTER_ID);
+            BOOST_VERIFY(asgnd_clust != kpmbase::INVALID_CLUSTER_ID);
 
-        if (asgnd_clust != cluster_assignments[row]) {
-            pt_num_change[omp_get_thread_num()]++;
+            if (asgnd_clust != cluster_assignments[row]) {
+                pt_num_change[thd].val++;
+            }
+            cluster_assignments[row] = asgnd_clust;
+            if (ctx.weights)
+                pt_cl.add_member(&matrix[row*ctx.ncol], asgnd_clust,
+                        ctx.weights[row]);
+            else
+                pt_cl.add_member(&matrix[row*ctx.ncol], asgnd_clust);
+            // Accumulate for local copies
         }
-        cluster_assignments[row] = asgnd_clust;
-        pt_cl[omp_get_thread_num()]->add_member(&matrix[row*NUM_COLS], asgnd_clust);
-        // Accumulate for local copies
-    }
 
+#pragma omp single
+        {
 #if VERBOSE
-    BOOST_LOG_TRIVIAL(info) << "Clearing cluster assignment counts";
-    BOOST_LOG_TRIVIAL(info) << "Clearing cluster centers ...";
+            BOOST_LOG_TRIVIAL(info) << "Clearing cluster assignment counts";
+            BOOST_LOG_TRIVIAL(info) << "Clearing cluster centers ...";
 #endif
-    cls->clear();
-
-    // Serial aggreate of OMP_MAX_THREADS vectors
-    // TODO: Pool these
-    for (int thd = 0; thd < OMP_MAX_THREADS; thd++) {
-        // Updated the changed cluster count
-        g_num_changed += pt_num_change[thd];
-        // Summation for cluster centers
-        cls->peq(pt_cl[thd]);
+            cls->clear();
+            if (ctx.weights)
+                cls->set_weighted();
+            // In case the team was smaller than asked for
+            for (int i = omp_get_num_threads(); i < ctx.nthreads; i++)
+                if (!ctx.pt_cl[i])
+                    ctx.pt_cl[i] = kpmbase::clusters::create(ctx.k, ctx.ncol);
+                else
+                    ctx.pt_cl[i]->clear();
+        }
+
+        // Parallel aggregate: each thread sums its own range of clusters
+        //  over all the accumulators
+        const unsigned per_thd = (ctx.k + omp_get_num_threads() - 1) /
+            omp_get_num_threads();
+        const unsigned begin = std::min(thd*per_thd, ctx.k);
+        cls->peq(ctx.pt_cl, begin, std::min(begin+per_thd, ctx.k));
     }
 
+    // Updated the changed cluster count
+    for (int thd = 0; thd < ctx.nthreads; thd++)
+        ctx.num_changed += pt_num_change[thd].val;
+
     size_t chk_nmemb = 0;
-    for (unsigned clust_idx = 0; clust_idx < K; clust_idx++) {
+    for (unsigned clust_idx = 0; clust_idx < ctx.k; clust_idx++) {
         cls->finalize(clust_idx);
         cluster_assignment_counts[clust_idx] = cls->get_num_members(clust_idx);
         chk_nmemb += cluster_assignment_counts[clust_idx];
     }
-    BOOST_VERIFY(chk_nmemb == NUM_ROWS);
+    BOOST_VERIFY(chk_nmemb == ctx.nrow);
 
 #if KM_TEST
-    BOOST_LOG_TRIVIAL(info) << "Global number of changes: " << g_num_changed;
+    BOOST_LOG_TRIVIAL(info) << "Global number of changes: " << ctx.num_changed;
 #endif
 }
 } // End annon namespace
 
 namespace kpmeans { namespace omp {
 
-kpmbase::kmeans_t compute_kmeans(const double* matrix, double* clusters_ptr,
-        unsigned* cluster_assignments, size_t* cluster_assignment_counts,
-        const size_t num_rows, const size_t num_cols, const unsigned k,
-        const size_t MAX_ITERS, const int max_threads, const std::string init,
-        const double tolerance, const std::string dist_type) {
+// One run of `compute_kmeans` with everything it changes in `ctx`
+static kpmbase::kmeans_t run_kmeans(kmeans_ctx& ctx, const double* matrix,
+        double* clusters_ptr, unsigned* cluster_assignments,
+        size_t* cluster_assignment_counts, const size_t num_rows,
+        const size_t num_cols, const unsigned k, const size_t MAX_ITERS,
+        const int max_threads, const std::string init, const double tolerance,
+        const std::string dist_type, const int index_checks) {
+    struct timeval start, end;
 #ifdef PROFILER
     ProfilerStart("matrix/kmeans.perf");
 #endif
-    NUM_COLS = num_cols;
-    K = k;
-    NUM_ROWS = num_rows;
+    ctx.ncol = num_cols;
+    ctx.k = k;
+    ctx.nrow = num_rows;
     assert(max_threads > 0);
 
-    OMP_MAX_THREADS = std::min(max_threads, kpmbase::get_num_omp_threads());
-    omp_set_num_threads(OMP_MAX_THREADS);
-    BOOST_LOG_TRIVIAL(info) << "Running on " << OMP_MAX_THREADS << " threads!";
+    ctx.nthreads = std::min(max_threads, kpmbase::get_num_omp_threads());
+    ctx.generator.seed(ctx.seed);
+    BOOST_LOG_TRIVIAL(info) << "Running on " << ctx.nthreads << " threads!";
 
     // Check k
-    if (K > NUM_ROWS || K < 2 || K == (unsigned)-1) {
+    if (ctx.k > ctx.nrow || ctx.k < 2 || ctx.k == (unsigned)-1) {
         BOOST_LOG_TRIVIAL(fatal)
             << "'k' must be between 2 and the number of rows in the matrix" <<
-            "k = " << K;
+            "k = " << ctx.k;
         exit(-1);
     }
 
@@ -264,24 +329,25 @@ kpmbase::kmeans_t compute_kmeans(const double* matrix, double* clusters_ptr,
 
     gettimeofday(&start , NULL);
     /*** Begin VarInit of data structures ***/
-    std::fill(cluster_assignments, cluster_assignments+NUM_ROWS,
+    std::fill(cluster_assignments, cluster_assignments+ctx.nrow,
             kpmbase::INVALID_CLUSTER_ID);
-    std::fill(cluster_assignment_counts, cluster_assignment_counts+K, 0);
+    std::fill(cluster_assignment_counts, cluster_assignment_counts+ctx.k, 0);
 
-    kpmbase::clusters::ptr clusters = kpmbase::clusters::create(K, NUM_COLS);
+    kpmbase::clusters::ptr clusters =
+        kpmbase::clusters::create(ctx.k, ctx.ncol);
 
     if (init == "none")
         clusters->set_mean(clusters_ptr);
 
     std::vector<double> dist_v;
-    dist_v.assign(NUM_ROWS, std::numeric_limits<double>::max());
+    dist_v.assign(ctx.nrow, std::numeric_limits<double>::max());
 
     /*** End VarInit ***/
     BOOST_LOG_TRIVIAL(info) << "Dist_type is " << dist_type;
     if (dist_type == "eucl") {
-        g_dist_type = kpmbase::dist_type_t::EUCL;
+        ctx.dist_type = kpmbase::dist_type_t::EUCL;
     } else if (dist_type == "cos") {
-        g_dist_type = kpmbase::dist_type_t::COS;
+        ctx.dist_type = kpmbase::dist_type_t::COS;
     } else {
         BOOST_LOG_TRIVIAL(fatal)
             << "[ERROR]: param dist_type must be one of: 'eucl', 'cos'.It is '"
@@ -289,19 +355,33 @@ kpmbase::kmeans_t compute_kmeans(const double* matrix, double* clusters_ptr,
         exit(-1);
     }
 
+    ctx.index = NULL;
+    ctx.max_checks = 0;
+    if (index_checks >= 0) {
+        if (ctx.dist_type == kpmbase::dist_type_t::EUCL) {
+            ctx.index = kpmbase::kd_tree::create(ctx.k, ctx.ncol);
+            ctx.max_checks = index_checks;
+            BOOST_LOG_TRIVIAL(info) << "Assigning rows with a k-d tree over"
+                " the centers" << (index_checks ? " (approximate)" : "");
+        } else {
+            BOOST_LOG_TRIVIAL(warning) << "[WARNING]: The center index is"
+                " euclidean only. Scanning every center";
+        }
+    }
+
     if (init == "random") {
-        random_partition_init(cluster_assignments, matrix,
-                clusters, NUM_ROWS, NUM_COLS, K);
-        g_init_type = kpmbase::init_type_t::RANDOM;
+        random_partition_init(ctx, cluster_assignments, matrix,
+                clusters, ctx.nrow, ctx.ncol, ctx.k);
+        ctx.init_type = kpmbase::init_type_t::RANDOM;
         clusters->finalize_all();
     } else if (init == "forgy") {
-        forgy_init(matrix, clusters, NUM_ROWS, NUM_COLS, K);
-        g_init_type = kpmbase::init_type_t::FORGY;
+        forgy_init(ctx, matrix, clusters, ctx.nrow, ctx.ncol, ctx.k);
+        ctx.init_type = kpmbase::init_type_t::FORGY;
     } else if (init == "kmeanspp") {
-        kmeanspp_init(matrix, clusters, cluster_assignments, dist_v);
-        g_init_type = kpmbase::init_type_t::PLUSPLUS;
+        kmeanspp_init(ctx, matrix, clusters, cluster_assignments, dist_v);
+        ctx.init_type = kpmbase::init_type_t::PLUSPLUS;
     } else if (init == "none") {
-        g_init_type = kpmbase::init_type_t::NONE;
+        ctx.init_type = kpmbase::init_type_t::NONE;
     } else {
         BOOST_LOG_TRIVIAL(fatal)
             << "[ERROR]: param init must be one of: "
@@ -310,7 +390,7 @@ kpmbase::kmeans_t compute_kmeans(const double* matrix, double* clusters_ptr,
         exit(-1);
     }
 
-    g_num_changed = 0;
+    ctx.num_changed = 0;
     gettimeofday(&end, NULL);
     BOOST_LOG_TRIVIAL(info) << "\n\nInitialization time taken = " <<
         kpmbase::time_diff(start, end) << " sec\n";
@@ -318,7 +398,7 @@ kpmbase::kmeans_t compute_kmeans(const double* matrix, double* clusters_ptr,
 
 #if KM_TEST
     printf("Cluster assignment counts: ");
-    kpmbase::print_arr(cluster_assignment_counts, K);
+    kpmbase::print_arr(cluster_assignment_counts, ctx.k);
 #endif
 
     BOOST_LOG_TRIVIAL(info) << "Init is '" << init << "'";
@@ -328,7 +408,7 @@ kpmbase::kmeans_t compute_kmeans(const double* matrix, double* clusters_ptr,
     BOOST_VERIFY(f =
             fopen("/mnt/nfs/disa/data/big/friendster-8-10centers", "wb"));
     fwrite(&((clusters->get_means())[0]),
-            sizeof(double)*NUM_COLS*K, 1, f);
+            sizeof(double)*ctx.ncol*ctx.k, 1, f);
     fclose(f);
     printf("\n\nCenters should be:\n");
     clusters->print_means();
@@ -347,28 +427,30 @@ kpmbase::kmeans_t compute_kmeans(const double* matrix, double* clusters_ptr,
     while (iter < MAX_ITERS) {
         if (iter == 1)
             std::fill(cluster_assignments,
-                    (cluster_assignments)+NUM_ROWS,
+                    (cluster_assignments)+ctx.nrow,
                         kpmbase::INVALID_CLUSTER_ID);
 
         // Hold cluster assignment counter
         BOOST_LOG_TRIVIAL(info) << "E-step Iteration " << iter <<
             ". Computing cluster assignments ...";
-        EM_step(matrix, clusters, cluster_assignments,
+        if (ctx.index)
+            ctx.index->build(&(clusters->get_means()[0]));
+        EM_step(ctx, matrix, clusters, cluster_assignments,
                 cluster_assignment_counts);
 #if KM_TEST
         printf("Cluster assignment counts: ");
-        kpmbase::print_arr(cluster_assignment_counts, K);
+        kpmbase::print_arr(cluster_assignment_counts, ctx.k);
 #endif
 #if VERBOSE
         BOOST_LOG_TRIVIAL(info) << "Printing clusters:";
         clusters->print_means();
 #endif
-        if (g_num_changed == 0 || ((g_num_changed/(double)NUM_ROWS))
+        if (ctx.num_changed == 0 || ((ctx.num_changed/(double)ctx.nrow))
                 <= tolerance) {
             converged = true;
             break;
         } else {
-            g_num_changed = 0;
+            ctx.num_changed = 0;
         }
         iter++;
     }
@@ -390,22 +472,71 @@ kpmbase::kmeans_t compute_kmeans(const double* matrix, double* clusters_ptr,
             << iter << " iterations";
     }
     printf("Final cluster counts: ");
-    kpmbase::print_arr(cluster_assignment_counts, K);
+    kpmbase::print_arr(cluster_assignment_counts, ctx.k);
     BOOST_LOG_TRIVIAL(info) << "\n******************************************\n";
 
 #if VERBOSE
-    printf("Computed bic: %f\n", get_bic(dist_v, NUM_ROWS, NUM_COLS, K));
+    printf("Computed bic: %f\n", get_bic(dist_v, ctx.nrow, ctx.ncol, ctx.k));
     size_t max_index = (std::max_element(cluster_assignment_counts,
-                cluster_assignment_counts+K) - cluster_assignment_counts);
+                cluster_assignment_counts+ctx.k) - cluster_assignment_counts);
 
     kpmbase::store_cluster(max_index, matrix,
             cluster_assignment_counts[max_index],
-            cluster_assignments, NUM_ROWS, NUM_COLS,
+            cluster_assignments, ctx.nrow, ctx.ncol,
             "/mnt/nfs/disa/data/big/");
 #endif
 
-    return kpmbase::kmeans_t (NUM_ROWS, NUM_COLS, iter, K,
+    return kpmbase::kmeans_t (ctx.nrow, ctx.ncol, iter, ctx.k,
             cluster_assignments, cluster_assignment_counts,
             clusters->get_means());
 }
+
+kpmbase::kmeans_t compute_kmeans(const double* matrix, double* clusters_ptr,
+        unsigned* cluster_assignments, size_t* cluster_assignment_counts,
+        const size_t num_rows, const size_t num_cols, const unsigned k,
+        const size_t MAX_ITERS, const int max_threads, const std::string init,
+        const double tolerance, const std::string dist_type,
+        const unsigned n_init, const double* weights, const int index_checks) {
+    kmeans_ctx ctx;
+    ctx.weights = weights;
+    if (n_init > 1 && init == "none") {
+        BOOST_LOG_TRIVIAL(warning) << "[WARNING]: Restarts from the same"
+            " provided centers are identical. Running once";
+    } else if (n_init > 1) {
+        kpmbase::kmeans_t best;
+        double best_sse = std::numeric_limits<double>::max();
+
+        // Restart r seeds every init with default_seed+r
+        for (unsigned r = 0; r < n_init; r++) {
+            ctx.seed = std::default_random_engine::default_seed + r;
+            kpmbase::kmeans_t ret = run_kmeans(ctx, matrix, clusters_ptr,
+                    cluster_assignments, cluster_assignment_counts, num_rows,
+                    num_cols, k, MAX_ITERS, max_threads, init, tolerance,
+                    dist_type, index_checks);
+            double sse = kpmbase::get_sse(matrix, &ret.centroids[0],
+                    &ret.assignments[0], num_rows, num_cols, max_threads,
+                    weights);
+            BOOST_LOG_TRIVIAL(info) << "Restart " << r << ": SSE = " << sse
+                << ", iterations = " << ret.iters;
+
+            if (sse < best_sse) {
+                best_sse = sse;
+                best = ret;
+            }
+        }
+
+        std::copy(best.centroids.begin(), best.centroids.end(), clusters_ptr);
+        std::copy(best.assignments.begin(), best.assignments.end(),
+                cluster_assignments);
+        std::copy(best.assignment_count.begin(), best.assignment_count.end(),
+                cluster_assignment_counts);
+        BOOST_LOG_TRIVIAL(info) << "Best of " << n_init <<
+            " restarts has SSE = " << best_sse;
+        return best;
+    }
+
+    return run_kmeans(ctx, matrix, clusters_ptr, cluster_assignments,
+            cluster_assignment_counts, num_rows, num_cols, k, MAX_ITERS,
+            max_threads, init, tolerance, dist_type, index_checks);
+}
 } } // End namespace kpmeans, omp
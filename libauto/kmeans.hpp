@@ -28,13 +28,16 @@
 #include <gperftools/profiler.h>
 #endif
 #include <vector>
+#include <random>
 #include <iostream>
 #include <algorithm>
 
 #include <boost/assert.hpp>
 #include <boost/log/trivial.hpp>
 
+#include "cluster_tree.hpp"
 #include "kmeans_types.hpp"
+#include "sparse_matrix.hpp"
 #include "util.hpp"
 
 namespace kpmbase = kpmeans::base;
@@ -51,13 +54,23 @@ namespace kpmeans { namespace omp {
  * \param k The number of clusters required.
  * \param max_iters The maximum number of iterations of K-means to perform.
  * \param init The type of initilization ["random", "forgy", "kmeanspp"]
+ * \param n_init The number of restarts. The one with the lowest SSE is
+ *  returned & left in the output buffers.
+ * \param weights Optional per-row weights of length `num_rows`. A row of
+ *  weight `w` counts as `w` copies of itself in the means, the kmeans++
+ *  sampling & the SSE. NULL weighs every row as 1.
+ * \param index_checks Only for `compute_kmeans`. < 0 scans every center per
+ *  row. Otherwise rows query a k-d tree over the centers rebuilt each
+ *  iteration: 0 gives the exact nearest center, > 0 stops after that many
+ *  distance computations (approximate). Euclidean only.
  **/
 kpmbase::kmeans_t compute_kmeans(const double* matrix, double* clusters,
 		unsigned* cluster_assignments, size_t* cluster_assignment_counts,
 		const size_t num_rows, const size_t num_cols, const unsigned k,
 		const size_t MAX_ITERS, const int max_threads,
         const std::string init="kmeanspp", const double tolerance=-1,
-        const std::string dist_type="eucl");
+        const std::string dist_type="eucl", const unsigned n_init=1,
+        const double* weights=NULL, const int index_checks=-1);
 
 /** See `compute_kmeans` for argument list */
 kpmbase::kmeans_t compute_min_kmeans
@@ -66,6 +79,111 @@ kpmbase::kmeans_t compute_min_kmeans
 		const size_t num_rows, const size_t num_cols, const unsigned k,
         const size_t MAX_ITERS, const int max_threads,
         const std::string init="kmeanspp", const double tolerance=-1,
+        const std::string dist_type="eucl", const unsigned n_init=1,
+        const double* weights=NULL);
+
+/**
+ * \brief Bisecting (hierarchical) kmeans. Starting from all rows, the leaves
+ *  with the largest SSE are repeatedly split `branching` ways by
+ *  `compute_min_kmeans` run on a contiguous copy of just their rows, until
+ *  there are `k` leaves. Each wave takes as many of the largest leaves as
+ *  there are clusters left to split out & splits them concurrently, each on
+ *  its own share of the `max_threads`. A pass over a subset costs
+ *  O(n_sub * d * branching) so the whole run is
+ *  ~O(n * d * branching * log_branching(k)) rather than O(n * d * k) per
+ *  iteration.
+ * \param clusters The `k` x `num_cols` leaf means, in depth first order.
+ * \param cluster_assignments The leaf each row ends up in.
+ * \param branching The (maximum) number of children per split.
+ * \param init The init of every split ["random", "forgy", "kmeanspp"].
+ * \param tree If set, points to the hierarchy on return. See
+ *  `cluster_tree::predict` to route new rows through it.
+ * \return The flat model. `iters` sums the iterations of every split & `k`
+ *  can be smaller than requested if some nodes hold only identical rows.
+ * See `compute_kmeans` for the remaining arguments.
+ **/
+kpmbase::kmeans_t compute_bisecting_kmeans(const double* matrix,
+        double* clusters, unsigned* cluster_assignments,
+        size_t* cluster_assignment_counts, const size_t num_rows,
+        const size_t num_cols, const unsigned k, const size_t MAX_ITERS,
+        const int max_threads, const unsigned branching=2,
+        const std::string init="kmeanspp", const double tolerance=-1,
+        const std::string dist_type="eucl", const double* weights=NULL,
+        kpmbase::cluster_tree::ptr* tree=NULL);
+
+// Rows each thread reads, labels & writes at a time in `predict_file`
+constexpr size_t DEFAULT_PREDICT_CHUNK_ROWS = 16384;
+
+/**
+ * \brief Label rows with their nearest of `k` fixed centers. There is no
+ *  init, M-step or reduction over the clusters, only one blocked pass.
+ * \param dists If not NULL, set to each row's distance to its center.
+ * \param cluster_assignment_counts Set to the # of rows per center.
+ * See `compute_kmeans` for the remaining arguments.
+ **/
+void predict(const double* matrix, const double* clusters,
+        unsigned* cluster_assignments, double* dists,
+        size_t* cluster_assignment_counts, const size_t num_rows,
+        const size_t num_cols, const unsigned k, const int max_threads,
         const std::string dist_type="eucl");
+
+/**
+ * \brief `predict` over rows [start_row, start_row+num_rows) of a row-major
+ *  binary file without loading it. Each thread preads a chunk into its own
+ *  buffer, labels it & pwrites the result so memory stays at
+ *  `max_threads * chunk_rows` rows. Row `r`'s assignment (unsigned) &
+ *  distance (double) are written at position `r` of `asgn_fn` & `dist_fn`,
+ *  so several processes can fill disjoint ranges of the same outputs.
+ * \param dist_fn Skipped if empty.
+ * \param data_offset Bytes before the first row of `fn`, i.e.
+ *  `get_data_offset(fn)` for a file with a header.
+ * \return The number of rows labeled.
+ **/
+size_t predict_file(const std::string fn, const size_t start_row,
+        const size_t num_rows, const double* clusters, const size_t num_cols,
+        const unsigned k, const std::string asgn_fn, const std::string dist_fn,
+        size_t* cluster_assignment_counts, const int max_threads,
+        const size_t chunk_rows=DEFAULT_PREDICT_CHUNK_ROWS,
+        const std::string dist_type="eucl", const size_t data_offset=0);
+
+/**
+ * \brief Online kmeans over a row-major stream of unknown length. A reader
+ *  thread fills a bounded pool of `nbuffers` chunks of `chunk_rows` rows
+ *  while `max_threads` threads assign the previous chunk. Centers then move
+ *  towards their chunk means with a per-center learning rate so memory
+ *  stays bounded by the centers and the buffer pool.
+ * \param fn The input (a file, fifo or e.g. /dev/stdin).
+ * \param format The input format ["bin", "text"].
+ * \param clusters The `k` x `num_cols` cluster centers (means). Used as is
+ *  if `init` is "none", otherwise seeded by the first `k` rows.
+ * \param checkpoint_fn If set, centers are written here in the input binary
+ *  format every `checkpoint_rows` rows and at the end of the stream.
+ * \return The model with no per-row assignments. `nrow` is the # rows seen.
+ **/
+kpmbase::kmeans_t compute_stream_kmeans(const std::string fn,
+        const std::string format, double* clusters, const size_t num_cols,
+        const unsigned k, const int max_threads, const size_t chunk_rows=4096,
+        const unsigned nbuffers=4, const std::string init="forgy",
+        const std::string checkpoint_fn="", const size_t checkpoint_rows=0);
+
+/**
+ * \brief Compute kmeans on a sparse (CSR) matrix without densifying it.
+ *  Distances are ||x||^2 + ||c||^2 - 2<x, c> from cached row & center norms
+ *  so an E-step costs O(nnz * k). Rows are grouped by cluster for the M-step
+ *  so each center is summed by one thread touching only nonzeros.
+ * \param mat The sparse matrix who's rows are being clustered.
+ * \param clusters The `k` x `ncol` dense cluster centers (means). Read if
+ *  `init` is "none".
+ * \param seed Seeds every init. The default picks what the
+ *  first run of `compute_kmeans` picks.
+ * See `compute_kmeans` for the remaining arguments.
+ **/
+kpmbase::kmeans_t compute_sparse_kmeans(const kpmbase::csr_matrix::ptr mat,
+        double* clusters, unsigned* cluster_assignments,
+        size_t* cluster_assignment_counts, const unsigned k,
+        const size_t MAX_ITERS, const int max_threads,
+        const std::string init="kmeanspp", const double tolerance=-1,
+        const std::string dist_type="eucl",
+        const unsigned seed=std::default_random_engine::default_seed);
 } }
 #endif
@@ -0,0 +1,254 @@
+/*
+* Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <omp.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "kmeans.hpp"
+#include "io.hpp"
+#include "util.hpp"
+#include "exception.hpp"
+
+namespace kpmbase = kpmeans::base;
+
+namespace {
+
+// Rows compared against each center while they stay in cache
+constexpr size_t ROW_BLOCK = 64;
+
+/**
+ * \brief Nearest center of `nrow' contiguous rows. Euclidean distances are
+ *  expanded as ||x||^2 + ||c||^2 - 2<x, c> over blocks of `ROW_BLOCK' rows
+ *  so each center is streamed once per block. The winner's distance is then
+ *  recomputed directly so `dists' carries no cancellation error.
+ */
+void nearest_rows(const double* rows, const size_t nrow,
+        const double* centers, const std::vector<double>& c_sqnorms,
+        const unsigned k, const size_t ncol, const kpmbase::dist_type_t dt,
+        unsigned* asgns, double* dists, std::vector<size_t>& counts) {
+    double r_sqnorms[ROW_BLOCK];
+    double best[ROW_BLOCK];
+
+    for (size_t block = 0; block < nrow; block += ROW_BLOCK) {
+        const size_t nblock = std::min(ROW_BLOCK, nrow - block);
+        const double* brows = &rows[block*ncol];
+
+        if (dt == kpmbase::dist_type_t::EUCL) {
+            for (size_t r = 0; r < nblock; r++) {
+                double sqnorm = 0;
+                for (size_t col = 0; col < ncol; col++)
+                    sqnorm += brows[r*ncol+col]*brows[r*ncol+col];
+                r_sqnorms[r] = sqnorm;
+                best[r] = std::numeric_limits<double>::max();
+            }
+
+            for (unsigned clust_idx = 0; clust_idx < k; clust_idx++) {
+                const double* center = &centers[clust_idx*ncol];
+                for (size_t r = 0; r < nblock; r++) {
+                    double dot = 0;
+                    for (size_t col = 0; col < ncol; col++)
+                        dot += brows[r*ncol+col]*center[col];
+                    double sqdist = r_sqnorms[r] + c_sqnorms[clust_idx] -
+                        2*dot;
+                    if (sqdist < best[r]) {
+                        best[r] = sqdist;
+                        asgns[block+r] = clust_idx;
+                    }
+                }
+            }
+        } else {
+            for (size_t r = 0; r < nblock; r++) {
+                best[r] = std::numeric_limits<double>::max();
+                for (unsigned clust_idx = 0; clust_idx < k; clust_idx++) {
+                    double dist = kpmbase::dist_comp_raw(&brows[r*ncol],
+                            &centers[clust_idx*ncol], ncol, dt);
+                    if (dist < best[r]) {
+                        best[r] = dist;
+                        asgns[block+r] = clust_idx;
+                    }
+                }
+            }
+        }
+
+        for (size_t r = 0; r < nblock; r++) {
+            counts[asgns[block+r]]++;
+            if (dists)
+                dists[block+r] = kpmbase::dist_comp_raw(&brows[r*ncol],
+                        &centers[asgns[block+r]*ncol], ncol, dt);
+        }
+    }
+}
+
+void get_sqnorms(const double* centers, const unsigned k, const size_t ncol,
+        std::vector<double>& c_sqnorms) {
+    c_sqnorms.assign(k, 0);
+    for (unsigned clust_idx = 0; clust_idx < k; clust_idx++)
+        for (size_t col = 0; col < ncol; col++)
+            c_sqnorms[clust_idx] +=
+                centers[clust_idx*ncol+col]*centers[clust_idx*ncol+col];
+}
+
+// Loop over short reads & writes. false on error or a premature EOF
+bool pread_all(const int fd, void* buf, const size_t nbytes, off_t off) {
+    char* p = static_cast<char*>(buf);
+    size_t done = 0;
+    while (done < nbytes) {
+        ssize_t ret = pread(fd, p+done, nbytes-done, off+done);
+        if (ret <= 0)
+            return false;
+        done += ret;
+    }
+    return true;
+}
+
+bool pwrite_all(const int fd, const void* buf, const size_t nbytes,
+        off_t off) {
+    const char* p = static_cast<const char*>(buf);
+    size_t done = 0;
+    while (done < nbytes) {
+        ssize_t ret = pwrite(fd, p+done, nbytes-done, off+done);
+        if (ret <= 0)
+            return false;
+        done += ret;
+    }
+    return true;
+}
+} // End annon namespace
+
+namespace kpmeans { namespace omp {
+
+void predict(const double* matrix, const double* clusters,
+        unsigned* cluster_assignments, double* dists,
+        size_t* cluster_assignment_counts, const size_t num_rows,
+        const size_t num_cols, const unsigned k, const int max_threads,
+        const std::string dist_type) {
+    const kpmbase::dist_type_t dt = kpmbase::get_dist_type(dist_type);
+    std::vector<double> c_sqnorms;
+    get_sqnorms(clusters, k, num_cols, c_sqnorms);
+    std::fill(cluster_assignment_counts, cluster_assignment_counts+k, 0);
+
+    assert(max_threads > 0);
+#pragma omp parallel num_threads(std::min(max_threads, \
+            kpmbase::get_num_omp_threads()))
+    {
+        std::vector<size_t> counts(k, 0);
+#pragma omp for schedule(static)
+        for (size_t block = 0; block < num_rows; block += ROW_BLOCK) {
+            nearest_rows(&matrix[block*num_cols],
+                    std::min(ROW_BLOCK, num_rows - block), clusters,
+                    c_sqnorms, k, num_cols, dt, &cluster_assignments[block],
+                    dists ? &dists[block] : NULL, counts);
+        }
+#pragma omp critical
+        for (unsigned clust_idx = 0; clust_idx < k; clust_idx++)
+            cluster_assignment_counts[clust_idx] += counts[clust_idx];
+    }
+}
+
+size_t predict_file(const std::string fn, const size_t start_row,
+        const size_t num_rows, const double* clusters, const size_t num_cols,
+        const unsigned k, const std::string asgn_fn, const std::string dist_fn,
+        size_t* cluster_assignment_counts, const int max_threads,
+        const size_t chunk_rows, const std::string dist_type,
+        const size_t data_offset) {
+    BOOST_ASSERT_MSG(chunk_rows > 0, "[FATAL]: chunk_rows must be > 0");
+    const kpmbase::dist_type_t dt = kpmbase::get_dist_type(dist_type);
+    struct timeval start, end;
+    gettimeofday(&start , NULL);
+
+    int fd = open(fn.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw kpmbase::io_exception("Cannot open '" + fn + "'");
+    // No O_TRUNC: other processes may be writing other rows of the file
+    int asgn_fd = open(asgn_fn.c_str(), O_WRONLY | O_CREAT, 0644);
+    int dist_fd = dist_fn.empty() ? -1 :
+        open(dist_fn.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (asgn_fd < 0 || (!dist_fn.empty() && dist_fd < 0)) {
+        close(fd);
+        throw kpmbase::io_exception("Cannot open the predict output");
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, data_offset + sizeof(double)*start_row*num_cols,
+            sizeof(double)*num_rows*num_cols, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    std::vector<double> c_sqnorms;
+    get_sqnorms(clusters, k, num_cols, c_sqnorms);
+    std::fill(cluster_assignment_counts, cluster_assignment_counts+k, 0);
+    const size_t nchunks = (num_rows + chunk_rows - 1) / chunk_rows;
+    bool io_error = false;
+
+    assert(max_threads > 0);
+    // Each thread reads, labels & writes whole chunks on its own. Buffers
+    //  are allocated & first touched by the thread using them.
+#pragma omp parallel num_threads(std::min(max_threads, \
+            kpmbase::get_num_omp_threads()))
+    {
+        std::vector<double> data(chunk_rows*num_cols);
+        std::vector<unsigned> asgns(chunk_rows);
+        std::vector<double> dists(dist_fd < 0 ? 0 : chunk_rows);
+        std::vector<size_t> counts(k, 0);
+
+#pragma omp for schedule(dynamic, 1)
+        for (size_t chunk = 0; chunk < nchunks; chunk++) {
+            bool failed;
+#pragma omp atomic read
+            failed = io_error;
+            if (failed)
+                continue;
+            const size_t row = start_row + chunk*chunk_rows;
+            const size_t nrow = std::min(chunk_rows,
+                    start_row + num_rows - row);
+
+            bool ok = pread_all(fd, &data[0], sizeof(double)*nrow*num_cols,
+                    data_offset + sizeof(double)*row*num_cols);
+            if (ok) {
+                nearest_rows(&data[0], nrow, clusters, c_sqnorms, k,
+                        num_cols, dt, &asgns[0],
+                        dist_fd < 0 ? NULL : &dists[0], counts);
+                ok = pwrite_all(asgn_fd, &asgns[0], sizeof(unsigned)*nrow,
+                        sizeof(unsigned)*row) && (dist_fd < 0 ||
+                        pwrite_all(dist_fd, &dists[0], sizeof(double)*nrow,
+                            sizeof(double)*row));
+            }
+            if (!ok) {
+#pragma omp atomic write
+                io_error = true;
+            }
+        }
+#pragma omp critical
+        for (unsigned clust_idx = 0; clust_idx < k; clust_idx++)
+            cluster_assignment_counts[clust_idx] += counts[clust_idx];
+    }
+
+    close(fd);
+    close(asgn_fd);
+    if (dist_fd >= 0)
+        close(dist_fd);
+    if (io_error)
+        throw kpmbase::io_exception("Predict failed reading '" + fn +
+                "' or writing its output");
+
+    gettimeofday(&end, NULL);
+    BOOST_LOG_TRIVIAL(info) << "Labeled " << num_rows << " rows in " <<
+        kpmbase::time_diff(start, end) << " sec";
+    return num_rows;
+}
+} } // End namespace kpmeans, omp
@@ -0,0 +1,286 @@
+/*
+* Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <omp.h>
+#include <random>
+
+#include "kmeans.hpp"
+#include "clusters.hpp"
+#include "io.hpp"
+#include "util.hpp"
+
+#define KM_TEST 0
+
+namespace kpmbase = kpmeans::base;
+
+namespace {
+
+/**
+ * \brief Distance from every row to its nearest center.
+ * \return The number of rows whose assignment changed.
+ */
+size_t sparse_estep(const kpmbase::csr_matrix& mat,
+        kpmbase::clusters::ptr cls, const std::vector<double>& c_sqnorms,
+        unsigned* cluster_assignments, const kpmbase::dist_type_t dt,
+        const int nthreads) {
+    const size_t ncol = mat.get_ncol();
+    const unsigned k = cls->get_nclust();
+    size_t num_changed = 0;
+
+#pragma omp parallel for reduction(+:num_changed) schedule(dynamic, 256) \
+    num_threads(nthreads)
+    for (size_t row = 0; row < mat.get_nrow(); row++) {
+        unsigned asgnd_clust = kpmbase::INVALID_CLUSTER_ID;
+        double best = std::numeric_limits<double>::max();
+
+        for (unsigned clust_idx = 0; clust_idx < k; clust_idx++) {
+            double dist = kpmbase::sparse_dist(mat.row_values(row),
+                    mat.row_indices(row), mat.row_nnz(row),
+                    mat.row_sqnorm(row), &(cls->get_means()[clust_idx*ncol]),
+                    c_sqnorms[clust_idx], dt);
+            if (dist < best) {
+                best = dist;
+                asgnd_clust = clust_idx;
+            }
+        }
+        BOOST_VERIFY(asgnd_clust != kpmbase::INVALID_CLUSTER_ID);
+
+        if (asgnd_clust != cluster_assignments[row])
+            num_changed++;
+        cluster_assignments[row] = asgnd_clust;
+    }
+    return num_changed;
+}
+
+void compute_center_sqnorms(kpmbase::clusters::ptr cls,
+        std::vector<double>& c_sqnorms, const int nthreads) {
+    const unsigned ncol = cls->get_ncol();
+#pragma omp parallel for num_threads(nthreads)
+    for (unsigned clust_idx = 0; clust_idx < cls->get_nclust(); clust_idx++) {
+        const double* mean = &(cls->get_means()[clust_idx*ncol]);
+        double sqnorm = 0;
+        for (unsigned col = 0; col < ncol; col++)
+            sqnorm += mean[col]*mean[col];
+        c_sqnorms[clust_idx] = sqnorm;
+    }
+}
+
+/**
+ * \brief Recompute the centers from the assignments. Rows are bucketed by
+ *  cluster (counting sort) so every center has a single writer & no per
+ *  thread `k x ncol' copies are needed.
+ */
+void sparse_mstep(const kpmbase::csr_matrix& mat, kpmbase::clusters::ptr cls,
+        std::vector<double>& c_sqnorms, const unsigned* cluster_assignments,
+        size_t* cluster_assignment_counts, const int nthreads) {
+    const unsigned k = cls->get_nclust();
+    const size_t nrow = mat.get_nrow();
+
+    std::vector<size_t> offsets(k+1, 0);
+    for (size_t row = 0; row < nrow; row++)
+        offsets[cluster_assignments[row]+1]++;
+    for (unsigned clust_idx = 0; clust_idx < k; clust_idx++)
+        offsets[clust_idx+1] += offsets[clust_idx];
+
+    std::vector<size_t> order(nrow);
+    std::vector<size_t> pos(offsets.begin(), offsets.end()-1);
+    for (size_t row = 0; row < nrow; row++)
+        order[pos[cluster_assignments[row]]++] = row;
+
+    cls->clear();
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for (unsigned clust_idx = 0; clust_idx < k; clust_idx++) {
+        for (size_t i = offsets[clust_idx]; i < offsets[clust_idx+1]; i++) {
+            size_t row = order[i];
+            cls->add_member(mat.row_values(row), mat.row_indices(row),
+                    mat.row_nnz(row), clust_idx);
+        }
+    }
+
+    cls->finalize_all(); // Serial: `complete_v' is a bit vector
+    for (unsigned clust_idx = 0; clust_idx < k; clust_idx++)
+        cluster_assignment_counts[clust_idx] = cls->get_num_members(clust_idx);
+    compute_center_sqnorms(cls, c_sqnorms, nthreads);
+}
+
+void sparse_kmeanspp_init(const kpmbase::csr_matrix& mat,
+        kpmbase::clusters::ptr cls, std::vector<double>& c_sqnorms,
+        unsigned* cluster_assignments, const kpmbase::dist_type_t dt,
+        const int nthreads, std::default_random_engine& generator) {
+    const size_t nrow = mat.get_nrow();
+    const size_t ncol = mat.get_ncol();
+    const unsigned k = cls->get_nclust();
+    std::vector<double> dist_v(nrow, std::numeric_limits<double>::max());
+    std::vector<double> center(ncol);
+
+    // Choose c1 uniformly at random
+    std::uniform_int_distribution<size_t> row_dist(0, nrow-1);
+    size_t selected_idx = row_dist(generator);
+    mat.densify_row(selected_idx, &center[0]);
+    cls->set_mean(&center[0], 0);
+    c_sqnorms[0] = mat.row_sqnorm(selected_idx);
+
+    for (unsigned clust_idx = 0; ; ) {
+        double cum_dist = 0;
+#pragma omp parallel for reduction(+:cum_dist) num_threads(nthreads)
+        for (size_t row = 0; row < nrow; row++) {
+            double dist = kpmbase::sparse_dist(mat.row_values(row),
+                    mat.row_indices(row), mat.row_nnz(row),
+                    mat.row_sqnorm(row), &(cls->get_means()[clust_idx*ncol]),
+                    c_sqnorms[clust_idx], dt);
+            if (dist < dist_v[row]) {
+                dist_v[row] = dist;
+                cluster_assignments[row] = clust_idx;
+            }
+            cum_dist += dist_v[row];
+        }
+
+        cum_dist *= std::uniform_real_distribution<double>(0, 1)(generator);
+        if (++clust_idx >= k)
+            break;
+
+        for (size_t row = 0; row < nrow; row++) {
+            cum_dist -= dist_v[row];
+            if (cum_dist <= 0) {
+                mat.densify_row(row, &center[0]);
+                cls->set_mean(&center[0], clust_idx);
+                c_sqnorms[clust_idx] = mat.row_sqnorm(row);
+                break;
+            }
+        }
+        BOOST_VERIFY(cum_dist <= 0);
+    }
+}
+} // End annon namespace
+
+namespace kpmeans { namespace omp {
+
+kpmbase::kmeans_t compute_sparse_kmeans(const kpmbase::csr_matrix::ptr mat,
+        double* clusters_ptr, unsigned* cluster_assignments,
+        size_t* cluster_assignment_counts, const unsigned k,
+        const size_t MAX_ITERS, const int max_threads, const std::string init,
+        const double tolerance, const std::string dist_type,
+        const unsigned seed) {
+    const size_t nrow = mat->get_nrow();
+    const size_t ncol = mat->get_ncol();
+    struct timeval start, end;
+
+    if (k > nrow || k < 2) {
+        BOOST_LOG_TRIVIAL(fatal)
+            << "'k' must be between 2 and the number of rows in the matrix" <<
+            "k = " << k;
+        exit(-1);
+    }
+    kpmbase::dist_type_t dt = kpmbase::get_dist_type(dist_type);
+
+    assert(max_threads > 0);
+    // The team size of every parallel region of the run
+    const int nthreads = std::min(max_threads, kpmbase::get_num_omp_threads());
+    BOOST_LOG_TRIVIAL(info) << "Sparse kmeans on " << nrow << " x " << ncol
+        << " with " << mat->get_nnz() << " nonzeros ("
+        << (100.0*mat->get_nnz()) / ((double)nrow*ncol) << "% dense)";
+
+    gettimeofday(&start , NULL);
+    std::fill(cluster_assignments, cluster_assignments+nrow,
+            kpmbase::INVALID_CLUSTER_ID);
+    std::fill(cluster_assignment_counts, cluster_assignment_counts+k, 0);
+
+    kpmbase::clusters::ptr cls = kpmbase::clusters::create(k, ncol);
+    std::vector<double> c_sqnorms(k);
+
+    if (init == "none") {
+        cls->set_mean(clusters_ptr);
+        compute_center_sqnorms(cls, c_sqnorms, nthreads);
+    } else if (init == "forgy") {
+        std::default_random_engine generator(seed);
+        std::uniform_int_distribution<size_t> distribution(0, nrow-1);
+        std::vector<double> center(ncol);
+        for (unsigned clust_idx = 0; clust_idx < k; clust_idx++) {
+            mat->densify_row(distribution(generator), &center[0]);
+            cls->set_mean(&center[0], clust_idx);
+        }
+        compute_center_sqnorms(cls, c_sqnorms, nthreads);
+    } else if (init == "random") {
+        std::default_random_engine generator(seed);
+        std::uniform_int_distribution<unsigned> distribution(0, k-1);
+        for (size_t row = 0; row < nrow; row++)
+            cluster_assignments[row] = distribution(generator);
+        sparse_mstep(*mat, cls, c_sqnorms, cluster_assignments,
+                cluster_assignment_counts, nthreads);
+    } else if (init == "kmeanspp") {
+        std::default_random_engine generator(seed);
+        sparse_kmeanspp_init(*mat, cls, c_sqnorms, cluster_assignments, dt,
+                nthreads, generator);
+    } else {
+        BOOST_LOG_TRIVIAL(fatal)
+            << "[ERROR]: param init must be one of: "
+            "'random', 'forgy', 'kmeanspp', 'none'. It is '" << init << "'";
+        exit(-1);
+    }
+
+    gettimeofday(&end, NULL);
+    BOOST_LOG_TRIVIAL(info) << "\n\nInitialization time taken = " <<
+        kpmbase::time_diff(start, end) << " sec\n";
+    gettimeofday(&start , NULL);
+
+    bool converged = false;
+    size_t iter = 0;
+    if (MAX_ITERS > 0)
+        iter++;
+
+    while (iter < MAX_ITERS) {
+        if (iter == 1)
+            std::fill(cluster_assignments, cluster_assignments+nrow,
+                    kpmbase::INVALID_CLUSTER_ID);
+
+        BOOST_LOG_TRIVIAL(info) << "E-step Iteration " << iter <<
+            ". Computing cluster assignments ...";
+        size_t num_changed = sparse_estep(*mat, cls, c_sqnorms,
+                cluster_assignments, dt, nthreads);
+        sparse_mstep(*mat, cls, c_sqnorms, cluster_assignments,
+                cluster_assignment_counts, nthreads);
+#if KM_TEST
+        BOOST_LOG_TRIVIAL(info) << "Global number of changes: " << num_changed;
+#endif
+
+        if (num_changed == 0 || (num_changed/(double)nrow) <= tolerance) {
+            converged = true;
+            break;
+        }
+        iter++;
+    }
+
+    gettimeofday(&end, NULL);
+    BOOST_LOG_TRIVIAL(info) << "\n\nAlgorithmic time taken = " <<
+        kpmbase::time_diff(start, end) << " sec\n";
+
+    if (converged) {
+        BOOST_LOG_TRIVIAL(info) <<
+            "K-means converged in " << iter << " iterations";
+    } else {
+        BOOST_LOG_TRIVIAL(warning) << "[Warning]: K-means failed to converge in "
+            << iter << " iterations";
+    }
+    printf("Final cluster counts: ");
+    kpmbase::print_arr(cluster_assignment_counts, k);
+
+    return kpmbase::kmeans_t(nrow, ncol, iter, k, cluster_assignments,
+            cluster_assignment_counts, cls->get_means());
+}
+} } // End namespace kpmeans, omp
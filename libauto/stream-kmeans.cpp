@@ -0,0 +1,339 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <omp.h>
+#include <pthread.h>
+#include <stdio.h>
+
+#include <exception>
+#include <memory>
+#include <queue>
+
+#include "kmeans.hpp"
+#include "io.hpp"
+#include "util.hpp"
+#include "padded.hpp"
+#include "exception.hpp"
+
+namespace kpmbase = kpmeans::base;
+
+namespace {
+
+struct chunk {
+    std::vector<double> data;
+    size_t nrow;
+};
+
+/**
+ * \brief Fixed set of chunks handed between one producer (the reader) and
+ *  one consumer. The producer blocks when every chunk is full.
+ */
+class chunk_pool {
+private:
+    std::vector<chunk> chunks;
+    std::queue<unsigned> free_q, full_q;
+    bool eof;
+    bool stopped; // The consumer is gone. See `stop'
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+
+public:
+    chunk_pool(const unsigned nbuffers, const size_t chunk_rows,
+            const size_t ncol) : chunks(nbuffers), eof(false), stopped(false) {
+        for (unsigned i = 0; i < nbuffers; i++) {
+            chunks[i].data.resize(chunk_rows*ncol);
+            chunks[i].nrow = 0;
+            free_q.push(i);
+        }
+        pthread_mutex_init(&mutex, NULL);
+        pthread_cond_init(&cond, NULL);
+    }
+
+    chunk& get(const unsigned idx) { return chunks[idx]; }
+
+    // Returns -1 once the consumer has stopped
+    int get_free() {
+        pthread_mutex_lock(&mutex);
+        while (free_q.empty() && !stopped)
+            pthread_cond_wait(&cond, &mutex);
+        int idx = -1;
+        if (!stopped) {
+            idx = free_q.front();
+            free_q.pop();
+        }
+        pthread_mutex_unlock(&mutex);
+        return idx;
+    }
+
+    // Have the producer quit at its next `get_free'
+    void stop() {
+        pthread_mutex_lock(&mutex);
+        stopped = true;
+        pthread_cond_broadcast(&cond);
+        pthread_mutex_unlock(&mutex);
+    }
+
+    void put_free(const unsigned idx) {
+        pthread_mutex_lock(&mutex);
+        free_q.push(idx);
+        pthread_cond_signal(&cond);
+        pthread_mutex_unlock(&mutex);
+    }
+
+    void put_full(const unsigned idx) {
+        pthread_mutex_lock(&mutex);
+        full_q.push(idx);
+        pthread_cond_signal(&cond);
+        pthread_mutex_unlock(&mutex);
+    }
+
+    void set_eof() {
+        pthread_mutex_lock(&mutex);
+        eof = true;
+        pthread_cond_signal(&cond);
+        pthread_mutex_unlock(&mutex);
+    }
+
+    // Returns -1 once the stream is exhausted
+    int get_full() {
+        pthread_mutex_lock(&mutex);
+        while (full_q.empty() && !eof)
+            pthread_cond_wait(&cond, &mutex);
+        int idx = -1;
+        if (!full_q.empty()) {
+            idx = full_q.front();
+            full_q.pop();
+        }
+        pthread_mutex_unlock(&mutex);
+        return idx;
+    }
+
+    ~chunk_pool() {
+        pthread_cond_destroy(&cond);
+        pthread_mutex_destroy(&mutex);
+    }
+};
+
+struct producer_args {
+    kpmbase::reader<double>* rdr;
+    chunk_pool* pool;
+    size_t chunk_rows;
+    std::exception_ptr error; // What ended the read early, if anything
+};
+
+void* produce(void* arg) {
+    producer_args* args = static_cast<producer_args*>(arg);
+    int idx;
+    try {
+        while ((idx = args->pool->get_free()) >= 0) {
+            chunk& ch = args->pool->get(idx);
+            ch.nrow = args->rdr->readchunk(ch.data, args->chunk_rows);
+            if (!ch.nrow) {
+                args->pool->put_free(idx);
+                break;
+            }
+            args->pool->put_full(idx);
+        }
+    } catch (...) {
+        // Rethrown by the consumer once it has joined us
+        args->error = std::current_exception();
+    }
+    args->pool->set_eof();
+    return NULL;
+}
+
+/**
+ * \brief Stops & joins the producer on every way out of the consume loop,
+ *  so it never outlives the pool & args it works on.
+ */
+class producer_guard {
+private:
+    pthread_t producer;
+    chunk_pool& pool;
+    bool joined;
+
+public:
+    producer_guard(pthread_t producer, chunk_pool& pool) :
+        producer(producer), pool(pool), joined(false) { }
+
+    void join() {
+        if (joined)
+            return;
+        pool.stop();
+        pthread_join(producer, NULL);
+        joined = true;
+    }
+
+    ~producer_guard() { join(); }
+};
+
+// Write to a temp file first so a reader never sees a partial model
+void checkpoint(const std::string fn, const double* clusters,
+        const size_t numel) {
+    std::string tmpfn = fn + ".tmp";
+    {
+        kpmbase::bin_io<double> bw(tmpfn, "wb");
+        bw.write(clusters, numel);
+    }
+    if (rename(tmpfn.c_str(), fn.c_str()))
+        throw kpmbase::io_exception("Failed to write checkpoint to '" +
+                fn + "'");
+    BOOST_LOG_TRIVIAL(info) << "Checkpointed centers to '" << fn << "'";
+}
+}
+
+namespace kpmeans { namespace omp {
+kpmbase::kmeans_t compute_stream_kmeans(const std::string fn,
+        const std::string format, double* clusters, const size_t num_cols,
+        const unsigned k, const int max_threads, const size_t chunk_rows,
+        const unsigned nbuffers, const std::string init,
+        const std::string checkpoint_fn, const size_t checkpoint_rows) {
+    BOOST_ASSERT_MSG(chunk_rows > 0 && nbuffers > 0,
+            "[FATAL]: Streaming needs at least one non-empty buffer");
+
+    std::unique_ptr<kpmbase::reader<double> > rdr;
+    if (format == "bin")
+        rdr.reset(new kpmbase::bin_rm_reader<double>(fn));
+    else if (format == "text")
+        rdr.reset(new kpmbase::text_reader<double>(fn));
+    else
+        throw kpmbase::io_exception("unknown stream format: " + format);
+    rdr->set_ncol(num_cols);
+
+    chunk_pool pool(nbuffers, chunk_rows, num_cols);
+    producer_args args = {rdr.get(), &pool, chunk_rows, nullptr};
+    pthread_t producer;
+    if (pthread_create(&producer, NULL, produce, &args))
+        throw kpmbase::thread_exception("Failed to start the stream reader");
+    producer_guard guard(producer, pool);
+
+    // Per-center # rows absorbed, doubles as the final cluster sizes
+    std::vector<size_t> nseen(k, 0);
+    unsigned nseeded = (init == "none") ? k : 0;
+    if (nseeded == k)
+        BOOST_LOG_TRIVIAL(info) << "Using the provided centers";
+
+    // Per-thread chunk accumulators. Each thread's block is on cache lines
+    //  of its own
+    const size_t sums_stride = kpmbase::padded_stride<double>(k*num_cols);
+    const size_t counts_stride = kpmbase::padded_stride<size_t>(k);
+    std::vector<double> sums(max_threads*sums_stride);
+    std::vector<size_t> counts(max_threads*counts_stride);
+
+    struct timeval start, end;
+    gettimeofday(&start , NULL);
+
+    size_t nrow = 0, nchunks = 0, last_ckpt = 0;
+    int idx;
+    while ((idx = pool.get_full()) >= 0) {
+        chunk& ch = pool.get(idx);
+        size_t first = 0;
+
+        // Seed centers with the first k rows of the stream
+        for (; nseeded < k && first < ch.nrow; first++, nseeded++) {
+            std::copy(&ch.data[first*num_cols], &ch.data[(first+1)*num_cols],
+                    &clusters[nseeded*num_cols]);
+            nseen[nseeded] = 1;
+        }
+
+        std::fill(sums.begin(), sums.end(), 0);
+        std::fill(counts.begin(), counts.end(), 0);
+
+#pragma omp parallel num_threads(max_threads)
+        {
+            const int tid = omp_get_thread_num();
+            double* tsums = &sums[tid*sums_stride];
+            size_t* tcounts = &counts[tid*counts_stride];
+
+#pragma omp for schedule(static)
+            for (size_t row = first; row < ch.nrow; row++) {
+                const double* rp = &ch.data[row*num_cols];
+                unsigned asgnd_clust = kpmbase::INVALID_CLUSTER_ID;
+                double best = std::numeric_limits<double>::max();
+
+                for (unsigned clust_idx = 0; clust_idx < k; clust_idx++) {
+                    double dist = kpmbase::eucl_dist(rp,
+                            &clusters[clust_idx*num_cols], num_cols);
+                    if (dist < best) {
+                        best = dist;
+                        asgnd_clust = clust_idx;
+                    }
+                }
+
+                tcounts[asgnd_clust]++;
+                for (size_t col = 0; col < num_cols; col++)
+                    tsums[asgnd_clust*num_cols+col] += rp[col];
+            }
+        }
+
+        nrow += ch.nrow;
+        nchunks++;
+        pool.put_free(idx); // Let the reader refill it
+
+        // Reduce & take one learning-rate step per center
+        for (unsigned clust_idx = 0; clust_idx < k; clust_idx++) {
+            size_t nmemb = 0;
+            for (int tid = 0; tid < max_threads; tid++)
+                nmemb += counts[tid*counts_stride+clust_idx];
+            if (!nmemb)
+                continue;
+
+            nseen[clust_idx] += nmemb;
+            double eta = nmemb / (double)nseen[clust_idx];
+            for (size_t col = 0; col < num_cols; col++) {
+                double sum = 0;
+                for (int tid = 0; tid < max_threads; tid++)
+                    sum += sums[tid*sums_stride+clust_idx*num_cols+col];
+                double& mean = clusters[clust_idx*num_cols+col];
+                mean += eta*((sum/nmemb) - mean);
+            }
+        }
+
+        if (!checkpoint_fn.empty() && nseeded == k &&
+                (nrow - last_ckpt) >= checkpoint_rows) {
+            checkpoint(checkpoint_fn, clusters, k*num_cols);
+            last_ckpt = nrow;
+        }
+    }
+    guard.join();
+
+    if (args.error)
+        std::rethrow_exception(args.error);
+    if (nseeded < k)
+        throw kpmbase::io_exception("stream has fewer than k = " +
+                std::to_string(k) + " rows");
+    if (!checkpoint_fn.empty() && last_ckpt != nrow)
+        checkpoint(checkpoint_fn, clusters, k*num_cols);
+
+    gettimeofday(&end, NULL);
+    BOOST_LOG_TRIVIAL(info) << "\n\nStreamed " << nrow << " rows in " <<
+        nchunks << " chunks. Algorithmic time taken = " <<
+        kpmbase::time_diff(start, end) << " sec\n";
+
+    printf("Final cluster counts: ");
+    kpmbase::print_arr(&nseen[0], k);
+
+    kpmbase::kmeans_t ret;
+    ret.set_params(nrow, num_cols, nchunks, k);
+    ret.assignment_count = nseen;
+    ret.centroids.assign(clusters, clusters + k*num_cols);
+    return ret;
+}
+} } // End namespace kpmeans, omp
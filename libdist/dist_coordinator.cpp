@@ -43,6 +43,7 @@ dist_coordinator::dist_coordinator(
             nthreads, centers, it, tolerance, dt) {
 
         this->g_nrow = nrow;
+        pp_delta = kpmbase::clusters::create(k, ncol);
 
         for (thread_iter it = threads.begin(); it < threads.end(); ++it)
             (*it)->set_start_rid((*it)->get_start_rid()
@@ -77,7 +78,10 @@ void dist_coordinator::random_partition_init() {
         unsigned asgnd_clust = gen.next();
         const double* dp = this->get_thd_data(row);
 
-        cltrs->add_member(dp, asgnd_clust);
+        if (weights)
+            cltrs->add_member(dp, asgnd_clust, weights[row]);
+        else
+            cltrs->add_member(dp, asgnd_clust);
         cluster_assignments[row] = asgnd_clust;
     }
 
@@ -122,6 +126,11 @@ const bool dist_coordinator::is_local(const size_t global_rid) const {
     return true;
 }
 
+void dist_coordinator::set_weights(const double* weights) {
+    base_kmeans_coordinator::set_weights(weights ?
+            &weights[(g_nrow / nprocs) * mpi_rank] : NULL);
+}
+
 // For testing
 void const dist_coordinator::print_thread_data() {
     std::cout << "\n\nProcess: " << this->mpi_rank;
@@ -134,6 +143,7 @@ void dist_coordinator::kmeanspp_init() {
     std::vector<double> buff(k*ncol);
     std::vector<double> dist_v;
     std::vector<double> g_dist_v(g_nrow);
+    std::vector<double> w_dist_v(weights ? get_nrow() : 0);
     dist_v.assign(get_nrow(), std::numeric_limits<double>::max()); // local nrow
     set_thd_dist_v_ptr(&dist_v[0]);
 
@@ -172,8 +182,16 @@ void dist_coordinator::kmeanspp_init() {
         if (++clust_idx >= k)  // No more centers needed
             break;
 
+        // Weighted rows are sampled in proportion to weight * dist
+        const double* pp_dist_v = &dist_v[0];
+        if (weights) {
+            for (size_t row = 0; row < get_nrow(); row++)
+                w_dist_v[row] = weights[row]*dist_v[row];
+            pp_dist_v = &w_dist_v[0];
+        }
+
         // Gather the g_dist_v
-        kpmmpi::mpi::allgather_double(&dist_v[0],
+        kpmmpi::mpi::allgather_double(pp_dist_v,
                 &g_dist_v[0], g_nrow/nprocs);
 
         // Gather the remaining entries from the last proc which *may* have more
@@ -182,7 +200,7 @@ void dist_coordinator::kmeanspp_init() {
             const size_t numel = (g_nrow % nprocs);
 
             if (mpi_rank == nprocs - 1)
-                std::copy(&dist_v[tail_idx], &dist_v[tail_idx+numel],
+                std::copy(&pp_dist_v[tail_idx], &pp_dist_v[tail_idx+numel],
                         &g_dist_v[g_nrow-numel]);
 
             kpmmpi::mpi::bcast_double(&g_dist_v[g_nrow-numel], nprocs-1, numel);
@@ -248,8 +266,7 @@ void dist_coordinator::run_kmeans(kpmbase::kmeans_t& ret,
     }
 
     // Give processes their data
-    wake4run(kpmeans::thread_state_t::ALLOC_DATA);
-    wait4complete();
+    load_data();
 
     shift_thread_start_rid();
 
@@ -269,6 +286,7 @@ void dist_coordinator::run_kmeans(kpmbase::kmeans_t& ret,
 
     double* clstr_buff = new double[k*ncol];
     size_t* nmemb_buff = new size_t[k];
+    std::vector<double> weight_buff(k);
 
     if (_init_t == kpmbase::init_type_t::RANDOM ||
             _init_t == kpmbase::init_type_t::FORGY) {
@@ -281,6 +299,11 @@ void dist_coordinator::run_kmeans(kpmbase::kmeans_t& ret,
             kpmmpi::mpi::reduce_size_t(&(cltrs_ptr->get_num_members_v()[0]),
                     nmemb_buff, cltrs_ptr->get_num_members_v().size());
             cltrs_ptr->set_num_members_v(nmemb_buff); // Set new counts
+            if (weights) {
+                kpmmpi::mpi::reduce_double(&(cltrs_ptr->get_weight_v()[0]),
+                        &weight_buff[0], k);
+                cltrs_ptr->set_weight_v(&weight_buff[0]);
+            }
             cltrs_ptr->finalize_all();
             // End Init
 
@@ -310,16 +333,30 @@ void dist_coordinator::run_kmeans(kpmbase::kmeans_t& ret,
 
         pp_aggregate();
 
-        // NOTE: cltrs_ptr has this procs diff (agg of threads from this proc)
+        // NOTE: pp_delta has this procs diff (agg of threads from this proc)
         // NOTE: clstr_buff has agg of all procs diff
-        kpmmpi::mpi::reduce_double(&(cltrs_ptr->get_means()[0]),
-                clstr_buff, cltrs_ptr->size());
+        kpmmpi::mpi::reduce_double(&(pp_delta->get_means()[0]),
+                clstr_buff, pp_delta->size());
 
         // nmemb_buff has agg of all procs diff on membership count
-        kpmmpi::mpi::reduce_size_t(&(cltrs_ptr->get_num_members_v()[0]),
-                nmemb_buff, cltrs_ptr->get_num_members_v().size());
-        cltrs_ptr->set_mean(clstr_buff);
-        cltrs_ptr->set_num_members_v(nmemb_buff);
+        kpmmpi::mpi::reduce_size_t(&(pp_delta->get_num_members_v()[0]),
+                nmemb_buff, pp_delta->get_num_members_v().size());
+        if (weights)
+            kpmmpi::mpi::reduce_double(&(pp_delta->get_weight_v()[0]),
+                    &weight_buff[0], k);
+
+        // The first step adds every row. Later ones only move rows, so
+        //  their diff goes on top of the previous universal sums
+        if (iters == 0)
+            cltrs_ptr->clear();
+        else
+            cltrs_ptr->unfinalize_all();
+        cltrs_ptr->means_peq(clstr_buff);
+        cltrs_ptr->num_members_v_peq(nmemb_buff);
+        if (weights) {
+            cltrs_ptr->set_weighted();
+            cltrs_ptr->weight_v_peq(&weight_buff[0]);
+        }
 
         // NOTE: Now finalized
         size_t pp_num_changed = get_num_changed();
@@ -404,15 +441,15 @@ dist_coordinator::~dist_coordinator() {
 }
 
 // Aggregate per process from threads &
-//      save to `cltrs' as the delta for 1 EM-step
+//      save to `pp_delta' as the delta for 1 EM-step
 void dist_coordinator::pp_aggregate() {
     num_changed = 0; // Reset every iteration
-    cltrs->clear(); // NOTE: So we don't clear prev_means
+    pp_delta->clear();
 
     for (thread_iter it = threads.begin(); it != threads.end(); ++it) {
         // Updated the changed cluster count
         num_changed += (*it)->get_num_changed();
-        cltrs->peq((*it)->get_local_clusters());
+        pp_delta->peq((*it)->get_local_clusters());
     }
 }
 
@@ -38,6 +38,12 @@ private:
     int mpi_rank;
     int nprocs;
     size_t g_nrow;
+    // This process's change to the cluster sums in a step. See `pp_aggregate'
+    std::shared_ptr<kpmbase::clusters> pp_delta;
+
+protected:
+    // Rows live on many processes. Use `run_kmeans(ret, outdir)'
+    size_t run() override { throw kpmbase::not_implemented_exception(); }
 
 public:
     static base_kmeans_coordinator::ptr create(int argc, char* argv[],
@@ -64,6 +70,8 @@ public:
     void forgy_init() override;
     const bool is_local(const size_t global_rid) const;
     void run_kmeans(kpmbase::kmeans_t& ret, const std::string outdir="");
+    // Takes all `g_nrow' weights & keeps this process's partition
+    void set_weights(const double* weights) override;
 
     const size_t global_rid(const size_t local_rid) const;
     const size_t local_rid(const size_t global_rid) const;
@@ -49,6 +49,7 @@ dist_task_coordinator::dist_task_coordinator(
                     + (nrow / nprocs) * mpi_rank);
 
         prev_num_members.resize(k);
+        prev_weights.resize(k);
 }
 
 /**
@@ -76,7 +77,10 @@ void dist_task_coordinator::random_partition_init() {
         unsigned asgnd_clust = gen.next();
         const double* dp = this->get_thd_data(row);
 
-        cltrs->add_member(dp, asgnd_clust);
+        if (weights)
+            cltrs->add_member(dp, asgnd_clust, weights[row]);
+        else
+            cltrs->add_member(dp, asgnd_clust);
         cluster_assignments[row] = asgnd_clust;
     }
 
@@ -105,6 +109,11 @@ const bool dist_task_coordinator::is_local(const size_t global_rid) const {
     return true;
 }
 
+void dist_task_coordinator::set_weights(const double* weights) {
+    base_kmeans_coordinator::set_weights(weights ?
+            &weights[(g_nrow / nprocs) * mpi_rank] : NULL);
+}
+
 // For testing
 void const dist_task_coordinator::print_thread_data() {
     printf("\n\nProcess: %u\n", this->mpi_rank);
@@ -116,6 +125,7 @@ void dist_task_coordinator::kmeanspp_init() {
 
     std::vector<double> buff(k*ncol);
     std::vector<double> g_dist_v(g_nrow); // Global to all processes
+    std::vector<double> w_dist_v(weights ? get_nrow() : 0);
     set_thd_dist_v_ptr(&dist_v[0]);
 
     // Choose c1 uniformly at random
@@ -154,8 +164,16 @@ void dist_task_coordinator::kmeanspp_init() {
         if (++clust_idx >= k)  // No more centers needed
             break;
 
+        // Weighted rows are sampled in proportion to weight * dist
+        const double* pp_dist_v = &dist_v[0];
+        if (weights) {
+            for (size_t row = 0; row < get_nrow(); row++)
+                w_dist_v[row] = weights[row]*dist_v[row];
+            pp_dist_v = &w_dist_v[0];
+        }
+
         // Gather the g_dist_v
-        kpmmpi::mpi::allgather_double(&dist_v[0],
+        kpmmpi::mpi::allgather_double(pp_dist_v,
                 &g_dist_v[0], g_nrow/nprocs);
 
         // Gather the remaining entries from the last proc which *may* have more
@@ -164,7 +182,7 @@ void dist_task_coordinator::kmeanspp_init() {
             const size_t numel = (g_nrow % nprocs);
 
             if (mpi_rank == nprocs - 1)
-                std::copy(&dist_v[tail_idx], &dist_v[tail_idx+numel],
+                std::copy(&pp_dist_v[tail_idx], &pp_dist_v[tail_idx+numel],
                         &g_dist_v[g_nrow-numel]);
 
             kpmmpi::mpi::bcast_double(&g_dist_v[g_nrow-numel], nprocs-1, numel);
@@ -233,8 +251,7 @@ void dist_task_coordinator::run_kmeans(kpmbase::kmeans_t& ret,
 
     // The business
     set_global_ptrs();
-    wake4run(kpmeans::thread_state_t::ALLOC_DATA);
-    wait4complete();
+    load_data();
 
     struct timeval start, end;
     gettimeofday(&start , NULL);
@@ -250,6 +267,7 @@ void dist_task_coordinator::run_kmeans(kpmbase::kmeans_t& ret,
 
     double* clstr_buff = new double[k*ncol];
     size_t* nmemb_buff = new size_t[k];
+    std::vector<double> weight_buff(k);
 
     // TODO: Check cost of all the shared_ptr passing
     kpmbase::prune_clusters::ptr cltrs_ptr = get_gcltrs();
@@ -265,6 +283,11 @@ void dist_task_coordinator::run_kmeans(kpmbase::kmeans_t& ret,
             kpmmpi::mpi::reduce_size_t(&(cltrs_ptr->get_num_members_v()[0]),
                     nmemb_buff, cltrs_ptr->get_num_members_v().size());
             cltrs_ptr->set_num_members_v(nmemb_buff); // Set new counts
+            if (weights) {
+                kpmmpi::mpi::reduce_double(&(cltrs_ptr->get_weight_v()[0]),
+                        &weight_buff[0], k);
+                cltrs_ptr->set_weight_v(&weight_buff[0]);
+            }
             cltrs_ptr->finalize_all();
             // End Init
 
@@ -308,14 +331,21 @@ void dist_task_coordinator::run_kmeans(kpmbase::kmeans_t& ret,
         // nmemb_buff has agg of all procs diff on membership count
         kpmmpi::mpi::reduce_size_t(&(cltrs_ptr->get_num_members_v()[0]),
                 nmemb_buff, cltrs_ptr->get_num_members_v().size());
+        if (weights)
+            kpmmpi::mpi::reduce_double(&(cltrs_ptr->get_weight_v()[0]),
+                    &weight_buff[0], k);
 
         if (iters == 0) {
             cltrs_ptr->set_mean(clstr_buff);
             cltrs_ptr->set_num_members_v(nmemb_buff);
+            if (weights)
+                cltrs_ptr->set_weight_v(&weight_buff[0]);
         } else {
             // Get the prev univ clusters
             cltrs_ptr->set_mean(cltrs_ptr->get_prev_means());
             cltrs_ptr->set_num_members_v(&(get_prev_num_members())[0]);
+            if (weights)
+                cltrs_ptr->set_weight_v(&prev_weights[0]);
 #if VERBOSE
             printf("Prev universal clusters for Proc: %d ==> \n", mpi_rank);
             cltrs_ptr->print_means();
@@ -325,6 +355,8 @@ void dist_task_coordinator::run_kmeans(kpmbase::kmeans_t& ret,
 
             cltrs_ptr->means_peq(clstr_buff);
             cltrs_ptr->num_members_v_peq(nmemb_buff);
+            if (weights)
+                cltrs_ptr->weight_v_peq(&weight_buff[0]);
         }
 
         // NOTE: Now finalized
@@ -424,6 +456,8 @@ void dist_task_coordinator::pp_aggregate() {
     cltrs->set_prev_means();
     std::copy(cltrs->get_num_members_v().begin(),
             cltrs->get_num_members_v().end(), prev_num_members.begin());
+    std::copy(cltrs->get_weight_v().begin(),
+            cltrs->get_weight_v().end(), prev_weights.begin());
 
     cltrs->clear(); // NOTE: So we don't clear prev_means
 
@@ -39,6 +39,11 @@ private:
     int nprocs;
     size_t g_nrow;
     std::vector<size_t> prev_num_members;
+    std::vector<double> prev_weights; // Only used for weighted data
+
+protected:
+    // Rows live on many processes. Use `run_kmeans(ret, outdir)'
+    size_t run() override { throw kpmbase::not_implemented_exception(); }
 
 public:
     static base_kmeans_coordinator::ptr create(int argc, char* argv[],
@@ -70,6 +75,8 @@ public:
     void random_partition_init() override;
     void forgy_init() override;
     void run_kmeans(kpmbase::kmeans_t& ret, const std::string outdir="");
+    // Takes all `g_nrow' weights & keeps this process's partition
+    void set_weights(const double* weights) override;
 
     const bool is_local(const size_t global_rid) const;
     const size_t global_rid(const size_t local_rid) const;
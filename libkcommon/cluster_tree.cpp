@@ -0,0 +1,155 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fstream>
+#include <limits>
+
+#include <boost/assert.hpp>
+
+#include "cluster_tree.hpp"
+#include "util.hpp"
+
+namespace kpmeans { namespace base {
+
+unsigned cluster_tree::add_node(const unsigned parent, const double* mean,
+        const size_t size, const double sse) {
+    BOOST_ASSERT_MSG(parent == INVALID_CLUSTER_ID || parent < nodes.size(),
+            "[FATAL]: Parent node does not exist");
+    BOOST_ASSERT_MSG(parent != INVALID_CLUSTER_ID || nodes.empty(),
+            "[FATAL]: A tree has only one root");
+
+    const unsigned id = nodes.size();
+    node n;
+    n.parent = parent;
+    n.cluster_id = INVALID_CLUSTER_ID;
+    n.size = size;
+    n.sse = sse;
+    nodes.push_back(n);
+    means.insert(means.end(), mean, mean+ncol);
+
+    if (parent != INVALID_CLUSTER_ID)
+        nodes[parent].children.push_back(id);
+    return id;
+}
+
+unsigned cluster_tree::number_leaves() {
+    unsigned nleaves = 0;
+    if (nodes.empty())
+        return nleaves;
+
+    std::vector<unsigned> stack;
+    stack.push_back(0);
+    while (!stack.empty()) {
+        node& n = nodes[stack.back()];
+        stack.pop_back();
+
+        if (n.children.empty()) {
+            n.cluster_id = nleaves++;
+        } else {
+            n.cluster_id = INVALID_CLUSTER_ID;
+            // Reversed so the first child is numbered first
+            stack.insert(stack.end(), n.children.rbegin(), n.children.rend());
+        }
+    }
+    return nleaves;
+}
+
+unsigned cluster_tree::predict(const double* row, double& dist) const {
+    BOOST_ASSERT_MSG(!nodes.empty(), "[FATAL]: Predict on an empty tree");
+
+    unsigned id = 0;
+    dist = dist_comp_raw(row, get_mean(id), ncol, dist_type);
+    while (!nodes[id].children.empty()) {
+        const std::vector<unsigned>& children = nodes[id].children;
+        unsigned best = children[0];
+        dist = std::numeric_limits<double>::max();
+
+        for (unsigned i = 0; i < children.size(); i++) {
+            double child_dist = dist_comp_raw(row, get_mean(children[i]),
+                    ncol, dist_type);
+            if (child_dist < dist) {
+                dist = child_dist;
+                best = children[i];
+            }
+        }
+        id = best;
+    }
+    return nodes[id].cluster_id;
+}
+
+const size_t cluster_tree::get_depth() const {
+    size_t depth = 0;
+    for (unsigned id = 0; id < nodes.size(); id++) {
+        size_t d = 0;
+        for (unsigned p = nodes[id].parent; p != INVALID_CLUSTER_ID;
+                p = nodes[p].parent)
+            d++;
+        depth = std::max(depth, d);
+    }
+    return depth;
+}
+
+void cluster_tree::write(const std::string fn) const {
+    std::ofstream f(fn, std::ios::out);
+    BOOST_ASSERT_MSG(f.is_open(), "Error opening file for writing!");
+
+    f << "nnodes: " << nodes.size() << std::endl;
+    f << "dim: " << ncol << std::endl;
+    f << "nodes:" << std::endl;
+    for (unsigned id = 0; id < nodes.size(); id++) {
+        const node& n = nodes[id];
+        f << "  - id: " << id << std::endl;
+        f << "    parent: ";
+        if (n.parent == INVALID_CLUSTER_ID)
+            f << "null";
+        else
+            f << n.parent;
+        f << "\n    cluster: ";
+        if (n.cluster_id == INVALID_CLUSTER_ID)
+            f << "null";
+        else
+            f << n.cluster_id;
+        f << "\n    size: " << n.size;
+        f << "\n    sse: " << n.sse;
+
+        f << "\n    children: [";
+        for (unsigned i = 0; i < n.children.size(); i++) {
+            if (i == 0)
+                f << n.children[i];
+            else
+                f << "," << n.children[i];
+        }
+        f << "]\n    mean: [";
+        const double* mean = get_mean(id);
+        for (size_t col = 0; col < ncol; col++) {
+            if (col == 0)
+                f << mean[col];
+            else
+                f << "," << mean[col];
+        }
+        f << "]\n";
+    }
+    f.close();
+}
+
+void cluster_tree::clear() {
+    nodes.clear();
+    means.clear();
+}
+} } // End namespace kpmeans, base
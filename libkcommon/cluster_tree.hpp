@@ -0,0 +1,90 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KPM_CLUSTER_TREE_HPP__
+#define __KPM_CLUSTER_TREE_HPP__
+
+#include <memory>
+#include <vector>
+#include <string>
+
+#include "kmeans_types.hpp"
+
+namespace kpmeans { namespace base {
+
+/**
+  * \brief The hierarchy built by a bisecting kmeans run. Every node holds
+  *     the mean of the rows beneath it & its children split those rows.
+  *     Leaves are the flat clusters. A row is routed to a leaf by descending
+  *     into the nearest child at each level, i.e. O(b * depth) distance
+  *     computations for a branching factor `b' rather than O(k).
+  */
+class cluster_tree {
+public:
+    struct node {
+        unsigned parent; // INVALID_CLUSTER_ID for the root
+        std::vector<unsigned> children; // Empty for a leaf
+        unsigned cluster_id; // Flat id of a leaf, else INVALID_CLUSTER_ID
+        size_t size; // # of rows beneath
+        double sse; // Of the rows beneath to this node's mean
+    };
+
+private:
+    size_t ncol;
+    dist_type_t dist_type;
+    std::vector<node> nodes;
+    std::vector<double> means; // nodes.size() x ncol
+
+    cluster_tree(const size_t ncol, const dist_type_t dist_type) :
+        ncol(ncol), dist_type(dist_type) { }
+
+public:
+    typedef std::shared_ptr<cluster_tree> ptr;
+
+    static ptr create(const size_t ncol,
+            const dist_type_t dist_type=dist_type_t::EUCL) {
+        return ptr(new cluster_tree(ncol, dist_type));
+    }
+
+    /** \brief Append a node as the last child of `parent' & return its id */
+    unsigned add_node(const unsigned parent, const double* mean,
+            const size_t size, const double sse);
+    /** \brief Number the leaves 0..nleaves-1 in depth first order */
+    unsigned number_leaves();
+
+    /**
+      * \brief The flat cluster id of the leaf `row' descends to.
+      * \param dist Set to the distance between `row' & that leaf's mean.
+      */
+    unsigned predict(const double* row, double& dist) const;
+
+    // Write the tree as yaml: one entry per node, the root first
+    void write(const std::string fn) const;
+    void clear();
+
+    const node& get_node(const unsigned id) const { return nodes[id]; }
+    const double* get_mean(const unsigned id) const {
+        return &means[id*ncol];
+    }
+    const size_t size() const { return nodes.size(); }
+    const size_t get_ncol() const { return ncol; }
+    const size_t get_depth() const;
+};
+} } // End namespace kpmeans, base
+#endif
@@ -27,6 +27,7 @@ namespace kpmeans { namespace base {
 void clusters::clear() {
     std::fill(means.begin(), means.end(), 0);
     std::fill(num_members_v.begin(), num_members_v.end(), 0);
+    std::fill(weight_v.begin(), weight_v.end(), 0);
     std::fill(complete_v.begin(), complete_v.end(), false);
 }
 
@@ -56,7 +57,13 @@ void clusters::finalize(const unsigned idx) {
         return;
     }
 
-    if (num_members_v[idx] > 1) { // Less than 2 is the same result
+    if (weighted) {
+        if (weight_v[idx] > 0) {
+            for (unsigned i = 0; i < ncol; i++) {
+                means[(idx*ncol)+i] /= weight_v[idx];
+            }
+        }
+    } else if (num_members_v[idx] > 1) { // Less than 2 is the same result
         for (unsigned i = 0; i < ncol; i++) {
             means[(idx*ncol)+i] /= double(num_members_v[idx]);
         }
@@ -70,8 +77,10 @@ void clusters::unfinalize(const unsigned idx) {
     }
     complete_v[idx] = false;
 
+    const double mass = weighted ? weight_v[idx] :
+        (double)num_members_v[idx];
     for (unsigned col = 0; col < ncol; col++) {
-        this->means[(ncol*idx) + col] *= (double)num_members_v[idx];
+        this->means[(ncol*idx) + col] *= mass;
     }
 }
 
@@ -89,9 +98,15 @@ void clusters::set_num_members_v(const size_t* arg) {
     std::copy(&(arg[0]), &(arg[nclust]), num_members_v.begin());
 }
 
+void clusters::set_weight_v(const double* arg) {
+    std::copy(&(arg[0]), &(arg[nclust]), weight_v.begin());
+}
+
 clusters& clusters::operator=(const clusters& other) {
     this->means = other.get_means();
     this->num_members_v = other.get_num_members_v();
+    this->weight_v = other.get_weight_v();
+    this->weighted = other.is_weighted();
     this->ncol = other.get_ncol();
     this->nclust = other.get_nclust();
     return *this;
@@ -111,6 +126,12 @@ clusters& clusters::operator+=(clusters& rhs) {
 
     for (unsigned idx = 0; idx < nclust; idx++)
         num_members_peq(rhs.get_num_members(idx), idx);
+
+    if (rhs.is_weighted()) {
+        weighted = true;
+        for (unsigned idx = 0; idx < nclust; idx++)
+            weight_v[idx] += rhs.get_weight_v()[idx];
+    }
     return *this;
 }
 
@@ -121,6 +142,28 @@ void clusters::peq(ptr rhs) {
 
     for (unsigned idx = 0; idx < nclust; idx++)
         num_members_peq(rhs->get_num_members(idx), idx);
+
+    if (rhs->is_weighted()) {
+        weighted = true;
+        for (unsigned idx = 0; idx < nclust; idx++)
+            weight_v[idx] += rhs->get_weight_v()[idx];
+    }
+}
+
+void clusters::peq(const std::vector<ptr>& parts, const unsigned begin,
+        const unsigned end) {
+    BOOST_VERIFY(begin <= end && end <= nclust);
+    for (size_t part = 0; part < parts.size(); part++) {
+        BOOST_VERIFY(parts[part]->size() == size());
+        const kmsvector& part_means = parts[part]->get_means();
+        for (size_t i = begin*ncol; i < end*ncol; i++)
+            this->means[i] += part_means[i];
+
+        for (unsigned idx = begin; idx < end; idx++) {
+            num_members_v[idx] += parts[part]->get_num_members(idx);
+            weight_v[idx] += parts[part]->get_weight_v()[idx];
+        }
+    }
 }
 
 void clusters::means_peq(const double* other) {
@@ -133,6 +176,11 @@ void clusters::num_members_v_peq(const size_t* other) {
         this->num_members_v[i] += other[i];
 }
 
+void clusters::weight_v_peq(const double* other) {
+    for (unsigned i = 0; i < weight_v.size(); i++)
+        this->weight_v[i] += other[i];
+}
+
 // Begin Helpers //
 const void clusters::print_means() const {
     for (unsigned cl_idx = 0; cl_idx < get_nclust(); cl_idx++) {
@@ -148,6 +196,8 @@ clusters::clusters(const unsigned nclust, const unsigned ncol) {
 
     means.resize(ncol*nclust);
     num_members_v.resize(nclust);
+    weight_v.assign(nclust, 0);
+    weighted = false;
     complete_v.assign(nclust, false);
 }
 
@@ -158,6 +208,8 @@ clusters::clusters(const unsigned nclust, const unsigned ncol,
 
     set_mean(means);
     num_members_v.resize(nclust);
+    weight_v.assign(nclust, 0);
+    weighted = false;
     complete_v.assign(nclust, true);
 }
 
@@ -38,6 +38,8 @@ private:
     unsigned nclust;
     std::vector<size_t> num_members_v; // Cluster assignment counts
     std::vector<bool> complete_v; // Have we already divided by num_members
+    kmsvector weight_v; // Sum of member weights when `weighted'
+    bool weighted; // Means are weighted sums normalized by `weight_v'
 
     kmsvector means; // Cluster means
 
@@ -72,6 +74,22 @@ public:
         return num_members_v;
     }
 
+    const double get_weight(const unsigned idx) const {
+        return weighted ? weight_v[idx] : (double)num_members_v[idx];
+    }
+
+    const kmsvector& get_weight_v() const {
+        return weight_v;
+    }
+
+    const bool is_weighted() const {
+        return weighted;
+    }
+
+    void set_weighted(const bool weighted=true) {
+        this->weighted = weighted;
+    }
+
     const bool is_complete(const unsigned idx) const {
         return complete_v[idx];
     }
@@ -120,6 +138,16 @@ public:
         num_members_v[idx]++;
     }
 
+    // A sparse row only touches the columns of its `nnz' nonzeros
+    void add_member(const double* vals, const unsigned* idxs,
+            const size_t nnz, const unsigned idx) {
+        unsigned offset = idx * ncol;
+        for (size_t i = 0; i < nnz; i++) {
+            means[offset+idxs[i]] += vals[i];
+        }
+        num_members_v[idx]++;
+    }
+
     template <typename T>
     void add_member(T& count_it, const unsigned idx) {
         unsigned nid = 0;
@@ -156,6 +184,36 @@ public:
         add_member(arr, to_idx);
     }
 
+    // Weighted members contribute `weight * arr' & `weight' to the mass
+    template <typename T>
+    void add_member(const T* arr, const unsigned idx, const double weight) {
+        weighted = true;
+        unsigned offset = idx * ncol;
+        for (unsigned i=0; i < ncol; i++) {
+            means[offset+i] += weight*arr[i];
+        }
+        num_members_v[idx]++;
+        weight_v[idx] += weight;
+    }
+
+    template <typename T>
+    void remove_member(const T* arr, const unsigned idx, const double weight) {
+        weighted = true;
+        unsigned offset = idx * ncol;
+        for (unsigned i=0; i < ncol; i++) {
+            means[offset+i] -= weight*arr[i];
+        }
+        num_members_v[idx]--;
+        weight_v[idx] -= weight;
+    }
+
+    template <typename T>
+    void swap_membership(const T* arr, const unsigned from_idx,
+            const unsigned to_idx, const double weight) {
+        remove_member(arr, from_idx, weight);
+        add_member(arr, to_idx, weight);
+    }
+
     template <typename T>
     void swap_membership(T& count_it,
             const unsigned from_id, const unsigned to_id) {
@@ -185,6 +243,14 @@ public:
     clusters& operator=(const clusters& other);
     bool operator==(const clusters& other);
     void peq(ptr rhs);
+    /**
+      * \brief Add clusters [`begin', `end') of each of `parts' to ours, in
+      *     order. Threads given disjoint ranges write disjoint data, so a
+      *     team can share the reduction of its per-thread accumulators.
+      *     Weights are summed but `is_weighted' is left to the caller.
+      */
+    void peq(const std::vector<ptr>& parts, const unsigned begin,
+            const unsigned end);
     const void print_means() const;
     void clear();
     /** \param idx the cluster index.
@@ -196,10 +262,12 @@ public:
     void finalize_all();
     void unfinalize_all();
     void set_num_members_v(const size_t* arg);
+    void set_weight_v(const double* arg);
 
     const void print_membership_count() const;
     void means_peq(const double* other);
     void num_members_v_peq(const size_t* other);
+    void weight_v_peq(const double* other);
 };
 
 class prune_clusters : public clusters {
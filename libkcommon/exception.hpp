@@ -47,6 +47,13 @@ public:
         }
 };
 
+class parameter_exception : public std::runtime_error {
+public:
+    parameter_exception(const std::string msg) :
+        runtime_error(std::string("[ERROR]: Parameter ") + msg) {
+        }
+};
+
 class mpi_exception : public std::runtime_error {
 public:
     mpi_exception(const std::string msg, const int error_code) :
@@ -30,6 +30,9 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <string>
+
+#include "exception.hpp"
 
 namespace kpmeans { namespace base {
 
@@ -92,6 +95,9 @@ public:
 
     virtual void read(std::vector<T>& data) = 0;
     virtual bool readline(std::vector<T>& data) = 0;
+    /* Read up to `maxrows' rows of `ncol' into `data'.
+       Returns the number of whole rows read, 0 at the end of the stream. */
+    virtual size_t readchunk(std::vector<T>& data, const size_t maxrows) = 0;
     virtual void open() = 0;
 
     const std::string get_fn() const {
@@ -167,6 +173,37 @@ public:
         }
         return false;
     }
+
+    size_t readchunk(std::vector<T>& data, const size_t maxrows) override {
+        assert(this->ncol && data.size() >= maxrows*this->ncol);
+        std::string line;
+        size_t nread = 0;
+        while (nread < maxrows && std::getline(this->f, line)) {
+            T number;
+            T* row = &data[nread*this->ncol];
+            size_t nval = 0;
+            std::stringstream ss(line);
+
+            while (ss >> number) {
+                if (nval == this->ncol)
+                    throw io_exception("Row " +
+                            std::to_string(this->nrow + nread + 1) + " of '"
+                            + this->get_fn() + "' has more than " +
+                            std::to_string(this->ncol) + " values");
+                row[nval++] = number;
+            }
+            if (!nval)
+                continue; // Blank line
+            if (nval < this->ncol)
+                throw io_exception("Row " +
+                        std::to_string(this->nrow + nread + 1) + " of '" +
+                        this->get_fn() + "' has " + std::to_string(nval) +
+                        " of its " + std::to_string(this->ncol) + " values");
+            nread++;
+        }
+        this->nrow += nread;
+        return nread;
+    }
 };
 
 template <typename T>
@@ -201,6 +238,19 @@ public:
         return false;
     }
 
+    size_t readchunk(std::vector<T>& data, const size_t maxrows) override {
+        assert(this->ncol && data.size() >= maxrows*this->ncol);
+        const size_t rowsize = this->ncol*sizeof(T);
+        this->f.read(reinterpret_cast<char*>(data.data()), maxrows*rowsize);
+
+        size_t nread = this->f.gcount() / rowsize;
+        if (this->f.gcount() % rowsize)
+            fprintf(stderr, "[WARNING]: Dropping a partial row at the end"
+                    " of the stream\n");
+        this->nrow += nread;
+        return nread;
+    }
+
     void open() override {
         this->f.open(this->get_fn(), std::ios::in | std::ios::binary);
         assert(this->f.good());
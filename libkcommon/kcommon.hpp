@@ -22,10 +22,18 @@
 
 #include "io.hpp"
 #include "clusters.hpp"
+#include "cluster_tree.hpp"
 #include "dist_matrix.hpp"
+#include "kd_tree.hpp"
 #include "kmeans_types.hpp"
+#include "matrix_file.hpp"
+#include "numa_mem.hpp"
+#include "numa_reader.hpp"
+#include "padded.hpp"
 #include "prune_stats.hpp"
+#include "sparse_matrix.hpp"
 #include "thd_safe_bool_vector.hpp"
+#include "topology.hpp"
 #include "util.hpp"
 #include "thread_state.hpp"
 #endif
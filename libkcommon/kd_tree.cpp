@@ -0,0 +1,145 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <math.h>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "kd_tree.hpp"
+#include "kmeans_types.hpp"
+
+namespace kpmeans { namespace base {
+
+kd_tree::kd_tree(const size_t npoints, const size_t ncol,
+        const unsigned leaf_size) {
+    this->npoints = npoints;
+    this->ncol = ncol;
+    this->leaf_size = std::max(1U, leaf_size);
+    perm.resize(npoints);
+    data.resize(npoints*ncol);
+}
+
+void kd_tree::build(const double* points) {
+    for (unsigned i = 0; i < npoints; i++)
+        perm[i] = i;
+    nodes.clear();
+    if (npoints)
+        build(points, 0, npoints);
+
+    for (unsigned i = 0; i < npoints; i++)
+        std::copy(&points[perm[i]*ncol], &points[(perm[i]+1)*ncol],
+                &data[i*ncol]);
+}
+
+// Split at the median of the dimension with the widest spread
+unsigned kd_tree::build(const double* points, const unsigned begin,
+        const unsigned end) {
+    unsigned id = nodes.size();
+    nodes.push_back(node());
+    nodes[id].left = nodes[id].right = 0;
+    nodes[id].begin = begin;
+    nodes[id].end = end;
+
+    if (end - begin <= leaf_size)
+        return id;
+
+    unsigned split_dim = 0;
+    double max_spread = 0;
+    for (unsigned col = 0; col < ncol; col++) {
+        double lo = std::numeric_limits<double>::max();
+        double hi = -std::numeric_limits<double>::max();
+        for (unsigned i = begin; i < end; i++) {
+            lo = std::min(lo, points[perm[i]*ncol+col]);
+            hi = std::max(hi, points[perm[i]*ncol+col]);
+        }
+        if (hi - lo > max_spread) {
+            max_spread = hi - lo;
+            split_dim = col;
+        }
+    }
+    if (max_spread == 0) // All duplicates
+        return id;
+
+    unsigned mid = begin + (end - begin) / 2;
+    std::nth_element(perm.begin()+begin, perm.begin()+mid, perm.begin()+end,
+            [&](const unsigned a, const unsigned b) {
+                return points[a*ncol+split_dim] < points[b*ncol+split_dim];
+            });
+
+    nodes[id].split_dim = split_dim;
+    nodes[id].split_val = points[perm[mid]*ncol+split_dim];
+    unsigned left = build(points, begin, mid);
+    unsigned right = build(points, mid, end);
+    nodes[id].left = left; // `nodes' may have been reallocated
+    nodes[id].right = right;
+    return id;
+}
+
+unsigned kd_tree::nearest(const double* query, double& dist,
+        const size_t max_checks) const {
+    unsigned best = INVALID_CLUSTER_ID;
+    double best_sqdist = std::numeric_limits<double>::max();
+    size_t nchecks = 0;
+
+    // (node, lower bound on the squared distance to any point under it)
+    std::vector<std::pair<unsigned, double> > stack;
+    stack.push_back(std::make_pair(0U, 0.0));
+
+    while (!stack.empty()) {
+        std::pair<unsigned, double> top = stack.back();
+        stack.pop_back();
+        if (top.second > best_sqdist)
+            continue;
+
+        const node& n = nodes[top.first];
+        if (!n.left) { // Leaf
+            for (unsigned i = n.begin; i < n.end; i++) {
+                const double* point = &data[i*ncol];
+                double sqdist = 0;
+                for (size_t col = 0; col < ncol; col++) {
+                    double diff = query[col] - point[col];
+                    sqdist += diff*diff;
+                }
+                // Ties go to the lowest id, as in a linear scan
+                if (sqdist < best_sqdist ||
+                        (sqdist == best_sqdist && perm[i] < best)) {
+                    best_sqdist = sqdist;
+                    best = perm[i];
+                }
+            }
+            nchecks += n.end - n.begin;
+            if (max_checks && nchecks >= max_checks)
+                break;
+            continue;
+        }
+
+        double diff = query[n.split_dim] - n.split_val;
+        unsigned near = diff < 0 ? n.left : n.right;
+        unsigned far = diff < 0 ? n.right : n.left;
+        // Push the far side first so the near side is searched first
+        stack.push_back(std::make_pair(far, std::max(top.second, diff*diff)));
+        stack.push_back(std::make_pair(near, top.second));
+    }
+
+    dist = sqrt(best_sqdist);
+    return best;
+}
+} } // End namespace kpmeans, base
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KPM_KD_TREE_HPP__
+#define __KPM_KD_TREE_HPP__
+
+#include <memory>
+#include <vector>
+
+namespace kpmeans { namespace base {
+
+/**
+  * \brief A k-d tree over a small set of points (e.g. the cluster centers)
+  *     rebuilt in O(k log k * ncol) whenever they move. A query descends to
+  *     the leaf holding it & backtracks only into cells closer than the best
+  *     center so far, so assigning a row costs ~O(log k * ncol) rather than
+  *     O(k * ncol). Euclidean distance only.
+  */
+class kd_tree {
+private:
+    struct node {
+        unsigned split_dim;
+        double split_val;
+        unsigned left, right; // Child nodes. Both 0 for a leaf
+        unsigned begin, end; // Range of points in `perm' under this node
+    };
+
+    size_t npoints, ncol;
+    unsigned leaf_size;
+    std::vector<unsigned> perm; // Point ids in leaf order
+    std::vector<double> data; // Points copied in leaf order
+    std::vector<node> nodes;
+
+    kd_tree(const size_t npoints, const size_t ncol, const unsigned leaf_size);
+    unsigned build(const double* points, const unsigned begin,
+            const unsigned end);
+
+public:
+    typedef std::shared_ptr<kd_tree> ptr;
+    static constexpr unsigned DEFAULT_LEAF_SIZE = 8;
+
+    static ptr create(const size_t npoints, const size_t ncol,
+            const unsigned leaf_size=DEFAULT_LEAF_SIZE) {
+        return ptr(new kd_tree(npoints, ncol, leaf_size));
+    }
+
+    /** \brief (Re)build over the row-major `npoints x ncol' points, which
+      *     are copied.
+      */
+    void build(const double* points);
+
+    /**
+      * \brief The point nearest to `query'.
+      * \param dist Set to the euclidean distance to the returned point.
+      * \param max_checks Stop after this many distance computations & return
+      *     the best so far (approximate). 0 => exact.
+      */
+    unsigned nearest(const double* query, double& dist,
+            const size_t max_checks=0) const;
+
+    const size_t get_npoints() const { return npoints; }
+};
+} } // End namespace kpmeans, base
+#endif
@@ -22,6 +22,7 @@
 #include "kmeans_types.hpp"
 #include "io.hpp"
 #include "util.hpp"
+#include "exception.hpp"
 
 namespace kpmeans { namespace base {
 
@@ -89,9 +90,9 @@ const void kmeans_t::write(const std::string dirname) const {
     }
     f << "]";
 
-    // Centroid assignemnt
+    // Centroid assignemnt. NOTE: Empty for a streaming run
     f << "\ncluster: [";
-    for (size_t row = 0; row < nrow; row++) {
+    for (size_t row = 0; row < assignments.size(); row++) {
         if (row == 0)
             f << assignments[row];
         else
@@ -119,6 +120,69 @@ const void kmeans_t::write(const std::string dirname) const {
     f.close();
 }
 
+const void kmeans_t::write_model(const std::string fn,
+        const std::vector<double>& bounds) const {
+    BOOST_ASSERT_MSG(bounds.empty() || bounds.size() == nrow,
+            "[FATAL]: Expected one bound per row");
+    BOOST_ASSERT_MSG(assignments.size() == nrow,
+            "[FATAL]: A model without per-row assignments cannot be resumed");
+
+    FILE* f = fopen(fn.c_str(), "wb");
+    if (!f)
+        throw io_exception("Cannot open model '" + fn + "' to write");
+
+    const size_t header[] = {nrow, ncol, k, iters, bounds.size()};
+    BOOST_VERIFY(fwrite(header, sizeof(header), 1, f) == 1);
+    BOOST_VERIFY(fwrite(&assignment_count[0], sizeof(size_t)*k, 1, f) == 1);
+    BOOST_VERIFY(fwrite(&centroids[0], sizeof(double)*k*ncol, 1, f) == 1);
+    BOOST_VERIFY(fwrite(&assignments[0], sizeof(unsigned)*nrow, 1, f) == 1);
+    if (!bounds.empty())
+        BOOST_VERIFY(fwrite(&bounds[0], sizeof(double)*nrow, 1, f) == 1);
+    fclose(f);
+}
+
+kmeans_t kmeans_t::read_model(const std::string fn,
+        std::vector<double>& bounds) {
+    FILE* f = fopen(fn.c_str(), "rb");
+    if (!f)
+        throw io_exception("Cannot open model '" + fn + "'");
+
+    size_t header[5];
+    if (fread(header, sizeof(header), 1, f) != 1) {
+        fclose(f);
+        throw io_exception("Model '" + fn + "' is too short for a header");
+    }
+    kmeans_t ret;
+    ret.set_params(header[0], header[1], header[3], header[2]);
+    if (!ret.k || !ret.ncol || (header[4] && header[4] != ret.nrow)) {
+        fclose(f);
+        throw io_exception("Corrupt header in model '" + fn + "'");
+    }
+    const size_t expected = sizeof(header) + ret.k*sizeof(size_t) +
+        ret.k*ret.ncol*sizeof(double) + ret.nrow*sizeof(unsigned) +
+        header[4]*sizeof(double);
+    if (filesize(fn.c_str()) != expected) {
+        fclose(f);
+        throw io_exception("Model file size does not match its header.");
+    }
+
+    ret.assignment_count.resize(ret.k);
+    ret.centroids.resize(ret.k*ret.ncol);
+    ret.assignments.resize(ret.nrow);
+    bounds.resize(header[4]);
+    bool ok = fread(&ret.assignment_count[0], sizeof(size_t)*ret.k, 1,
+            f) == 1 && fread(&ret.centroids[0],
+                sizeof(double)*ret.centroids.size(), 1, f) == 1 &&
+        (!ret.nrow || fread(&ret.assignments[0], sizeof(unsigned)*ret.nrow,
+                            1, f) == 1) &&
+        (bounds.empty() || fread(&bounds[0], sizeof(double)*ret.nrow, 1,
+                                 f) == 1);
+    fclose(f);
+    if (!ok)
+        throw io_exception("Failed to read model '" + fn + "'");
+    return ret;
+}
+
 bool kmeans_t::operator==(const kmeans_t& other) {
     return (v_eq(this->assignments, other.assignments) &&
             v_eq(this->assignment_count, other.assignment_count) &&
@@ -30,7 +30,7 @@ namespace kpmeans { namespace base {
 static const unsigned INVALID_CLUSTER_ID = std::numeric_limits<unsigned>::max();
 enum kms_stage_t { INIT, ESTEP }; // What phase of the algo we're in
 enum dist_type_t { EUCL, COS }; // Euclidean, Cosine distance
-enum init_type_t { RANDOM, FORGY, PLUSPLUS, NONE }; // May have to use
+enum init_type_t { RANDOM, FORGY, PLUSPLUS, NONE, SUBSAMPLE }; // May have to use
 
 class kmeans_t {
 public:
@@ -46,6 +46,22 @@ public:
              const std::vector<double>& centroids);
     const void print() const;
     const void write(const std::string dirname) const;
+    /**
+      * \brief Write the model in binary so a later run can resume from it.
+      *     The file holds a header of size_t nrow, ncol, k, iters & the # of
+      *     bounds (0 or nrow), then the assignment counts (size_t), the
+      *     centroids (double), the assignments (unsigned) & any bounds
+      *     (double).
+      * \param bounds Optional per-row upper bounds on the distance of each
+      *     row to its (final) centroid.
+      */
+    const void write_model(const std::string fn,
+            const std::vector<double>& bounds=std::vector<double>()) const;
+    /** \brief Read a model written by `write_model'. `bounds' is left empty
+      *     if none were stored.
+      */
+    static kmeans_t read_model(const std::string fn,
+            std::vector<double>& bounds);
     bool operator==(const kmeans_t& other);
 
     void set_params(const size_t nrow, const size_t ncol, const size_t iters,
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <numaif.h>
+
+#include <vector>
+
+#include "matrix_file.hpp"
+#include "exception.hpp"
+#include "numa_mem.hpp"
+#include "util.hpp"
+
+namespace kpmeans { namespace base {
+
+bool read_header(const std::string fn, matrix_header& hdr) {
+    FILE* f = fopen(fn.c_str(), "rb");
+    if (!f)
+        throw io_exception("Cannot open '" + fn + "'");
+    size_t nread = fread(&hdr, sizeof(hdr), 1, f);
+    fclose(f);
+
+    if (nread != 1 || memcmp(hdr.magic, MATRIX_MAGIC, sizeof(MATRIX_MAGIC)))
+        return false; // Raw
+
+    if (hdr.version != MATRIX_FILE_VERSION)
+        throw io_exception("Unsupported matrix file version " +
+                std::to_string(hdr.version) + " in '" + fn + "'");
+    if (hdr.dtype != matrix_dtype_t::DOUBLE)
+        throw io_exception("Only double matrices are supported. '" +
+                fn + "' has dtype " + std::to_string(hdr.dtype));
+    if (hdr.layout != matrix_layout_t::ROW_MAJOR)
+        throw io_exception("Only row-major matrices are supported. '" +
+                fn + "' has layout " + std::to_string(hdr.layout));
+    if (hdr.alignment < sizeof(hdr) || (hdr.alignment & (hdr.alignment-1)))
+        throw io_exception("Bad alignment " + std::to_string(hdr.alignment)
+                + " in '" + fn + "'");
+    if (filesize(fn.c_str()) != hdr.alignment +
+            sizeof(double)*hdr.nrow*hdr.ncol)
+        throw io_exception("The size of '" + fn + "' does not match its "
+                "header");
+    return true;
+}
+
+size_t get_data_offset(const std::string fn) {
+    matrix_header hdr;
+    return read_header(fn, hdr) ? hdr.alignment : 0;
+}
+
+void write_matrix(const std::string fn, const double* data,
+        const size_t nrow, const size_t ncol, const uint32_t alignment) {
+    BOOST_ASSERT_MSG(alignment >= sizeof(matrix_header) &&
+            !(alignment & (alignment-1)),
+            "[FATAL]: The alignment must be a power of 2 >= 64");
+
+    // Header then zeros up to the first row
+    std::vector<char> prefix(alignment, 0);
+    matrix_header* hdr = reinterpret_cast<matrix_header*>(&prefix[0]);
+    memcpy(hdr->magic, MATRIX_MAGIC, sizeof(MATRIX_MAGIC));
+    hdr->version = MATRIX_FILE_VERSION;
+    hdr->dtype = matrix_dtype_t::DOUBLE;
+    hdr->nrow = nrow;
+    hdr->ncol = ncol;
+    hdr->layout = matrix_layout_t::ROW_MAJOR;
+    hdr->alignment = alignment;
+
+    FILE* f = fopen(fn.c_str(), "wb");
+    if (!f)
+        throw io_exception("Cannot open '" + fn + "' to write");
+    bool ok = fwrite(&prefix[0], alignment, 1, f) == 1;
+    if (nrow && ncol)
+        ok = ok && fwrite(data, sizeof(double)*nrow*ncol, 1, f) == 1;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok)
+        throw io_exception("Failed to write '" + fn + "'");
+}
+
+mapped_rows::mapped_rows(const std::string fn, const size_t offset,
+        const size_t nbytes) {
+    int fd = open(fn.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw io_exception("Cannot open '" + fn + "'");
+
+    // mmap offsets must be page aligned
+    const size_t pagesize = sysconf(_SC_PAGESIZE);
+    const size_t page_offset = offset - (offset % pagesize);
+    len = nbytes + (offset - page_offset);
+    base = mmap(NULL, len ? len : 1, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+            fd, page_offset);
+    close(fd); // The mapping keeps the file open
+    if (base == MAP_FAILED)
+        throw io_exception("Cannot map '" + fn + "': " + strerror(errno));
+
+    data = reinterpret_cast<double*>(static_cast<char*>(base) +
+            (offset - page_offset));
+}
+
+void mapped_rows::place(const int node_id) {
+    if (!len)
+        return;
+
+    bind_node(base, len, node_id, MPOL_PREFERRED, MPOL_MF_MOVE);
+
+    madvise(base, len, MADV_SEQUENTIAL);
+    const size_t pagesize = sysconf(_SC_PAGESIZE);
+    volatile char sink = 0;
+    for (size_t off = 0; off < len; off += pagesize)
+        sink += static_cast<volatile char*>(base)[off];
+    madvise(base, len, MADV_NORMAL);
+}
+
+mapped_rows::~mapped_rows() {
+    munmap(base, len ? len : 1);
+}
+} } // End namespace kpmeans, base
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KPM_MATRIX_FILE_HPP__
+#define __KPM_MATRIX_FILE_HPP__
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+namespace kpmeans { namespace base {
+
+enum matrix_dtype_t { DOUBLE = 1 }; // Element type on disk
+enum matrix_layout_t { ROW_MAJOR }; // Order of the elements on disk
+
+// Rows start a page into the file so each thread's rows map page aligned
+constexpr uint32_t DEFAULT_MATRIX_ALIGNMENT = 4096;
+constexpr uint32_t MATRIX_FILE_VERSION = 1;
+const char MATRIX_MAGIC[8] = {'K', 'N', 'O', 'R', 'M', 'A', 'T', '\0'};
+
+/**
+  * \brief The header of a self-describing dense matrix file (native
+  *     endianness). The rows follow at byte `alignment', the gap is zeroed.
+  */
+struct matrix_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype; // A matrix_dtype_t
+    uint64_t nrow;
+    uint64_t ncol;
+    uint32_t layout; // A matrix_layout_t
+    uint32_t alignment; // Offset of the first row. A power of 2 >= 64
+    uint8_t reserved[24];
+};
+static_assert(sizeof(matrix_header) == 64, "The header is 64 bytes on disk");
+
+/**
+  * \brief Read the header of `fn'.
+  * \return false if `fn' is a raw row-major matrix without one.
+  * Throws io_exception if the header is unsupported or disagrees with the
+  *     size of the file.
+  */
+bool read_header(const std::string fn, matrix_header& hdr);
+
+// Byte offset of the first row of `fn'. 0 for a raw matrix
+size_t get_data_offset(const std::string fn);
+
+// Write a row-major `nrow x ncol' matrix with a header to `fn'
+void write_matrix(const std::string fn, const double* data,
+        const size_t nrow, const size_t ncol,
+        const uint32_t alignment=DEFAULT_MATRIX_ALIGNMENT);
+
+/**
+  * \brief A private, writable mapping of `nbytes' of a file from byte
+  *     `offset'. Nothing is read until a page is first touched & writes
+  *     are never carried back to the file.
+  */
+class mapped_rows {
+private:
+    void* base; // Page aligned start of the mapping
+    size_t len;
+    double* data;
+
+    mapped_rows(const std::string fn, const size_t offset,
+            const size_t nbytes);
+
+public:
+    typedef std::shared_ptr<mapped_rows> ptr;
+
+    static ptr create(const std::string fn, const size_t offset,
+            const size_t nbytes) {
+        return ptr(new mapped_rows(fn, offset, nbytes));
+    }
+
+    double* get_data() { return data; }
+
+    /**
+      * \brief Fault every page in from the calling thread so that pages
+      *     not yet cached are allocated on its (bound) node. Cached pages
+      *     this process alone maps are moved to `node_id' first. Best effort.
+      */
+    void place(const int node_id);
+
+    ~mapped_rows();
+};
+} } // End namespace kpmeans, base
+#endif
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <numa.h>
+#include <numaif.h>
+
+#include <algorithm>
+#include <new>
+#include <vector>
+#include <boost/assert.hpp>
+#include <boost/log/trivial.hpp>
+
+#include "numa_mem.hpp"
+#include "exception.hpp"
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+namespace kpmeans { namespace base {
+
+// Transparent huge pages are always PMD (2MB) sized
+constexpr size_t THP_BYTES = HUGE_PAGE_2MB;
+
+static size_t round_up(const size_t nbytes, const size_t page_bytes) {
+    return ((std::max<size_t>(nbytes, 1) + page_bytes - 1) /
+            page_bytes) * page_bytes;
+}
+
+void bind_node(void* addr, const size_t len, const int node_id,
+        const int mode, const unsigned flags) {
+    if (node_id < 0)
+        return;
+
+    unsigned long nodemask[64/sizeof(unsigned long) + 1] = {};
+    nodemask[node_id / (8*sizeof(unsigned long))] |=
+        1UL << (node_id % (8*sizeof(unsigned long)));
+    if (mbind(addr, len, mode, nodemask, 8*sizeof(nodemask), flags))
+        BOOST_LOG_TRIVIAL(info) << "mbind to node " << node_id <<
+            " failed: " << strerror(errno) << ". Relying on first touch";
+}
+
+static void* alloc_hugetlb(const size_t len, const size_t page_bytes) {
+    const int shift = __builtin_ctzl(page_bytes);
+    void* addr = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE |
+            MAP_ANONYMOUS | MAP_HUGETLB | (shift << MAP_HUGE_SHIFT), -1, 0);
+    return addr == MAP_FAILED ? NULL : addr;
+}
+
+static void* alloc_thp(const size_t len) {
+    // Over-map by a page & trim so the region starts on a THP boundary
+    char* raw = static_cast<char*>(mmap(NULL, len + THP_BYTES,
+                PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (raw == MAP_FAILED)
+        return NULL;
+
+    char* addr = reinterpret_cast<char*>(round_up(
+                reinterpret_cast<size_t>(raw), THP_BYTES));
+    if (addr > raw)
+        munmap(raw, addr - raw);
+    if (raw + THP_BYTES > addr)
+        munmap(addr + len, (raw + THP_BYTES) - addr);
+
+    if (madvise(addr, len, MADV_HUGEPAGE))
+        BOOST_LOG_TRIVIAL(info) << "Transparent huge pages unavailable: " <<
+            strerror(errno) << ". Using base pages";
+    return addr;
+}
+
+void* alloc_pages(const size_t nbytes, const int node_id,
+        const size_t page_bytes, size_t& alloc_bytes) {
+    if (page_bytes) {
+        BOOST_ASSERT_MSG(!(page_bytes & (page_bytes - 1)),
+                "[FATAL]: The page size must be a power of 2");
+
+        alloc_bytes = round_up(nbytes, page_bytes);
+        void* addr = alloc_hugetlb(alloc_bytes, page_bytes);
+        if (addr) {
+            // The pool is global: don't SIGBUS when this node runs dry
+            bind_node(addr, alloc_bytes, node_id, MPOL_PREFERRED);
+            return addr;
+        }
+
+        alloc_bytes = round_up(nbytes, THP_BYTES);
+        if ((addr = alloc_thp(alloc_bytes))) {
+            bind_node(addr, alloc_bytes, node_id, MPOL_BIND);
+            return addr;
+        }
+    }
+
+    alloc_bytes = std::max<size_t>(nbytes, 1);
+    void* addr = node_id >= 0 ? numa_alloc_onnode(alloc_bytes, node_id) :
+        numa_alloc(alloc_bytes);
+    if (!addr)
+        throw std::bad_alloc();
+    return addr;
+}
+
+void free_pages(void* addr, const size_t alloc_bytes) {
+    if (addr)
+        munmap(addr, alloc_bytes);
+}
+
+void place_pages(void* addr, const size_t alloc_bytes, const size_t begin,
+        const size_t end, const size_t align, const int node_id) {
+    const size_t page = align ? align : sysconf(_SC_PAGESIZE);
+    const size_t first = std::min(alloc_bytes, (begin + page - 1)/page*page);
+    const size_t last = std::min(alloc_bytes, (end + page - 1)/page*page);
+    if (last > first)
+        bind_node(static_cast<char*>(addr) + first, last - first, node_id,
+                MPOL_BIND, MPOL_MF_MOVE);
+}
+
+size_t move_range(const void* buf, const size_t begin, const size_t end,
+        const int node_id) {
+    const uintptr_t page = sysconf(_SC_PAGESIZE);
+    const uintptr_t addr = reinterpret_cast<uintptr_t>(buf);
+    const uintptr_t first = begin ? (addr + begin + page - 1)/page*page :
+        addr/page*page;
+    const uintptr_t last = (addr + end + page - 1)/page*page;
+    if (node_id < 0 || last <= first)
+        return 0;
+
+    const size_t npages = (last - first)/page;
+    std::vector<void*> pages(npages);
+    std::vector<int> nodes(npages, node_id);
+    std::vector<int> status(npages);
+    for (size_t i = 0; i < npages; i++)
+        pages[i] = reinterpret_cast<void*>(first + i*page);
+
+    if (move_pages(0, npages, &pages[0], &nodes[0], &status[0],
+                MPOL_MF_MOVE)) {
+        BOOST_LOG_TRIVIAL(info) << "move_pages to node " << node_id <<
+            " failed: " << strerror(errno) << ". Rows stay where they are";
+        return 0;
+    }
+    return std::count(status.begin(), status.end(), node_id);
+}
+
+size_t get_page_bytes(const std::string& page_size) {
+    if (page_size == "0" || page_size == "4K" || page_size == "4k")
+        return 0;
+    if (page_size == "2M" || page_size == "2m")
+        return HUGE_PAGE_2MB;
+    if (page_size == "1G" || page_size == "1g")
+        return HUGE_PAGE_1GB;
+    throw thread_exception(std::string("param page size must be one of:"
+                " [4K | 2M | 1G]. It is '") + page_size + std::string("'"));
+}
+} } // End namespace kpmeans, base
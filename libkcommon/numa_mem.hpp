@@ -0,0 +1,154 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KPM_NUMA_MEM_HPP__
+#define __KPM_NUMA_MEM_HPP__
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+namespace kpmeans { namespace base {
+
+constexpr size_t HUGE_PAGE_2MB = 2UL << 20;
+constexpr size_t HUGE_PAGE_1GB = 1UL << 30;
+
+/**
+  * \brief Map `nbytes' of anonymous memory bound to `node_id' (< 0 => the
+  *     default policy, i.e. first touch). With `page_bytes' > 0 the region
+  *     is backed by huge pages of that size from hugetlbfs if the pool has
+  *     them, else it is aligned to & advised for transparent huge pages.
+  *     Either falls back to base pages when the kernel says no.
+  * \param alloc_bytes Set to the mapped length to pass to `free_pages'.
+  */
+void* alloc_pages(const size_t nbytes, const int node_id,
+        const size_t page_bytes, size_t& alloc_bytes);
+void free_pages(void* addr, const size_t alloc_bytes);
+
+/**
+  * \brief mbind(2) [addr, addr+len) to `node_id' with policy `mode'. A
+  *     failure is only logged, leaving the pages to first touch. Nothing is
+  *     done for `node_id' < 0.
+  */
+void bind_node(void* addr, const size_t len, const int node_id,
+        const int mode, const unsigned flags=0);
+
+/**
+  * \brief Bind the pages of a region from `alloc_pages' whose first byte is
+  *     in [begin, end) to `node_id', moving those already touched. Ranges
+  *     that tile the region so tile its pages.
+  * \param align The region's page size. Huge pages are never split.
+  */
+void place_pages(void* addr, const size_t alloc_bytes, const size_t begin,
+        const size_t end, const size_t align, const int node_id);
+
+/**
+  * \brief Migrate the pages of memory we don't own, e.g. a caller's buffer,
+  *     with move_pages(2). As with `place_pages' a page goes with the range
+  *     that holds its first byte, except that the range starting the buffer
+  *     also takes the page it starts in.
+  * \param buf The start of the buffer. `begin' & `end' are offsets into it.
+  * \return The number of pages now on `node_id'.
+  */
+size_t move_range(const void* buf, const size_t begin, const size_t end,
+        const int node_id);
+
+/**
+  * \brief How a coordinator uses a caller's in-memory rows: read them
+  *     where they are, first migrate each thread's rows to its node, or
+  *     copy each thread's rows into memory on its node.
+  */
+enum class buffer_use_t { IN_PLACE, MOVE, COPY };
+
+/**
+  * \brief Parse a page size given as "0", "4K", "2M" or "1G".
+  * \return The size in bytes. 0 and 4K (the base page) both mean 0.
+  */
+size_t get_page_bytes(const std::string& page_size);
+
+/**
+  * \brief A fixed length array in memory from `alloc_pages'. Stands in for
+  *     std::vector where a large per-row array should sit on huge pages.
+  */
+template <typename T>
+class page_array {
+private:
+    T* data_;
+    size_t len;
+    size_t alloc_bytes;
+    size_t page_bytes;
+
+    page_array(const size_t len, const int node_id,
+            const size_t page_bytes) : len(len), page_bytes(page_bytes) {
+        data_ = static_cast<T*>(alloc_pages(len*sizeof(T), node_id,
+                    page_bytes, alloc_bytes));
+    }
+
+    page_array(const size_t len, const T& init, const int node_id,
+            const size_t page_bytes) : page_array(len, node_id, page_bytes) {
+        std::fill(data_, data_+len, init);
+    }
+
+    page_array(const page_array&) = delete;
+    page_array& operator=(const page_array&) = delete;
+
+public:
+    typedef std::shared_ptr<page_array<T> > ptr;
+
+    static ptr create(const size_t len, const T& init,
+            const int node_id=-1, const size_t page_bytes=0) {
+        return ptr(new page_array<T>(len, init, node_id, page_bytes));
+    }
+
+    /**
+      * \brief Leave the elements untouched, so with the default policy each
+      *     page goes to the node of the first thread to write it rather than
+      *     to the caller's.
+      */
+    static ptr create_untouched(const size_t len, const int node_id=-1,
+            const size_t page_bytes=0) {
+        static_assert(std::is_trivial<T>::value,
+                "Untouched elements must need no construction");
+        return ptr(new page_array<T>(len, node_id, page_bytes));
+    }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    T& operator[](const size_t idx) { return data_[idx]; }
+    const T& operator[](const size_t idx) const { return data_[idx]; }
+    T* begin() { return data_; }
+    T* end() { return data_ + len; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + len; }
+    const size_t size() const { return len; }
+
+    // Move elements [begin, end) to `node_id'. See `place_pages'
+    void place(const size_t begin, const size_t end, const int node_id) {
+        place_pages(data_, alloc_bytes, begin*sizeof(T),
+                end == len ? alloc_bytes : end*sizeof(T), page_bytes,
+                node_id);
+    }
+
+    ~page_array() {
+        free_pages(data_, alloc_bytes);
+    }
+};
+} } // End namespace kpmeans, base
+#endif
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <boost/log/trivial.hpp>
+
+#include "numa_reader.hpp"
+#include "numa_mem.hpp"
+#include "exception.hpp"
+
+namespace kpmeans { namespace base {
+
+int read_chunks(const pread_fn& read, char* buf, const size_t begin,
+        const size_t len, const size_t need, const size_t chunk,
+        const unsigned depth) {
+    const size_t nchunks = (len + chunk - 1) / chunk;
+    std::atomic<size_t> next(0);
+    std::atomic<int> err(0);
+
+    // Blocking reads, so each reader keeps one request in flight
+    auto reader = [&]() {
+        size_t idx;
+        while (!err && (idx = next++) < nchunks) {
+            const size_t off = idx*chunk;
+            const size_t nbytes = std::min(chunk, len - off);
+            size_t got = 0;
+            while (got < nbytes) {
+                ssize_t nread = read(buf + off + got, nbytes - got,
+                        begin + off + got);
+                if (nread < 0 && errno == EINTR)
+                    continue;
+                int rc = nread < 0 ? errno :
+                    // Before `need' means the file shrank
+                    (!nread && off + got < need) ? EIO : 0;
+                if (rc) {
+                    int none = 0;
+                    err.compare_exchange_strong(none, rc);
+                    return;
+                }
+                if (!nread)
+                    break;
+                got += nread;
+            }
+        }
+    };
+
+    // The caller is one of the readers
+    std::vector<std::thread> helpers;
+    for (unsigned i = 1; i < std::min<size_t>(depth, nchunks); i++) {
+        try {
+            helpers.push_back(std::thread(reader));
+        } catch (std::system_error& e) {
+            BOOST_LOG_TRIVIAL(info) << "Only " << i << " of " << depth <<
+                " reads in flight: " << e.what();
+            break;
+        }
+    }
+    reader();
+    for (std::thread& helper : helpers)
+        helper.join();
+    return err;
+}
+
+// `pread' of `fd'. Unlike AIO, concurrent preads of one fd do overlap
+static pread_fn fd_reader(const int fd) {
+    return [fd](char* buf, const size_t nbytes, const size_t offset) {
+        return pread(fd, buf, nbytes, offset);
+    };
+}
+
+char* read_onnode(const std::string fn, const size_t offset,
+        const size_t nbytes, const int node_id, const read_opts& opts,
+        std::pair<void*, size_t>& alloc) {
+    bool direct = opts.direct;
+    int fd = -1;
+    if (direct) {
+        fd = open(fn.c_str(), O_RDONLY | O_DIRECT);
+        if (fd < 0) {
+            BOOST_LOG_TRIVIAL(info) << "O_DIRECT open of '" << fn <<
+                "' failed: " << strerror(errno) << ". Reading buffered";
+            direct = false;
+        }
+    }
+    if (fd < 0)
+        fd = open(fn.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw io_exception("Cannot open '" + fn + "'");
+
+    // Direct reads cover whole blocks around the range
+    const size_t align = DIRECT_IO_ALIGN;
+    const size_t begin = direct ? offset - (offset % align) : offset;
+    const size_t end = direct ?
+        ((offset + nbytes + align - 1) / align)*align : offset + nbytes;
+    try {
+        alloc.first = alloc_pages(end - begin, node_id, opts.page_bytes,
+                alloc.second);
+    } catch (std::bad_alloc& e) {
+        close(fd);
+        throw;
+    }
+
+    char* buf = static_cast<char*>(alloc.first);
+    const size_t chunk = std::max(align,
+            opts.chunk_bytes - (opts.chunk_bytes % align));
+    const unsigned depth = std::max(1U, opts.depth);
+    int err = read_chunks(fd_reader(fd), buf, begin, end - begin,
+            offset + nbytes - begin, chunk, depth);
+
+    if (err == EINVAL && direct) {
+        BOOST_LOG_TRIVIAL(info) << "O_DIRECT reads of '" << fn <<
+            "' failed. Reading buffered";
+        close(fd);
+        fd = open(fn.c_str(), O_RDONLY);
+        if (fd < 0)
+            err = errno;
+        else
+            err = read_chunks(fd_reader(fd), buf, begin, end - begin,
+                    offset + nbytes - begin, chunk, depth);
+    }
+    if (fd >= 0)
+        close(fd);
+
+    if (err) {
+        free_pages(alloc.first, alloc.second);
+        alloc.first = NULL;
+        throw io_exception("Reading '" + fn + "' failed: " + strerror(err));
+    }
+    return buf + (offset - begin);
+}
+} } // End namespace kpmeans, base
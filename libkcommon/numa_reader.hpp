@@ -0,0 +1,75 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KPM_NUMA_READER_HPP__
+#define __KPM_NUMA_READER_HPP__
+
+#include <sys/types.h>
+
+#include <functional>
+#include <string>
+#include <utility>
+
+namespace kpmeans { namespace base {
+
+constexpr size_t DEFAULT_READ_CHUNK_BYTES = 8 << 20;
+constexpr unsigned DEFAULT_READ_DEPTH = 4;
+constexpr size_t DIRECT_IO_ALIGN = 4096; // Covers 512B & 4KB sector disks
+
+// How a thread reads its rows from disk & the memory that holds them
+struct read_opts {
+    size_t chunk_bytes; // Per request. Rounded down to DIRECT_IO_ALIGN
+    unsigned depth; // # of requests in flight
+    bool direct; // Bypass the page cache with O_DIRECT
+    size_t page_bytes; // Huge page size backing the rows. 0 => base pages
+
+    read_opts() : chunk_bytes(DEFAULT_READ_CHUNK_BYTES),
+        depth(DEFAULT_READ_DEPTH), direct(false), page_bytes(0) { }
+};
+
+// Reads up to `nbytes' at `offset' into `buf' & returns what pread(2) would
+typedef std::function<ssize_t(char* buf, size_t nbytes, size_t offset)>
+    pread_fn;
+
+/**
+  * \brief Read [begin, begin+len) into `buf' in `chunk' byte requests. The
+  *     caller & `depth'-1 helper threads each take the next chunk & `read'
+  *     it, so up to `depth' requests are in flight. Only reads past
+  *     `begin+need', i.e. the end of the file, may come up short.
+  * \return 0 or the errno of the first failed request.
+  */
+int read_chunks(const pread_fn& read, char* buf, const size_t begin,
+        const size_t len, const size_t need, const size_t chunk,
+        const unsigned depth);
+
+/**
+  * \brief Read `nbytes' of `fn' from byte `offset' into memory allocated on
+  *     `node_id', keeping `opts.depth' chunked preads in flight with
+  *     `read_chunks'. Direct reads fall back to buffered ones if the file
+  *     system refuses O_DIRECT.
+  * \param alloc Set to the allocation to `free_pages'. With `opts.direct' it
+  *     starts up to a block before the returned pointer so the reads stay
+  *     block aligned.
+  * \return The first byte of the range.
+  */
+char* read_onnode(const std::string fn, const size_t offset,
+        const size_t nbytes, const int node_id, const read_opts& opts,
+        std::pair<void*, size_t>& alloc);
+} } // End namespace kpmeans, base
+#endif
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KPM_PADDED_HPP__
+#define __KPM_PADDED_HPP__
+
+#include <stddef.h>
+
+namespace kpmeans { namespace base {
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+/**
+  * \brief A value alone on its cache line(s). Per-thread accumulators kept
+  *     side by side in an array otherwise share lines, & every update by one
+  *     thread invalidates the line in the caches of its neighbours.
+  *     Needs -faligned-new for heap arrays before C++17.
+  */
+template <typename T>
+struct alignas(CACHE_LINE_SIZE) padded {
+    T val;
+
+    padded() : val() { }
+    padded(const T& val) : val(val) { }
+};
+
+/**
+  * \brief Stride (in T) between per-thread blocks of `n' T in one array so
+  *     that no two blocks share a cache line, however the array is aligned.
+  */
+template <typename T>
+constexpr size_t padded_stride(const size_t n) {
+    return ((n*sizeof(T) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE + 1) *
+        CACHE_LINE_SIZE / sizeof(T);
+}
+} } // End namespace kpmeans, base
+#endif
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <boost/assert.hpp>
+
+#include "sparse_matrix.hpp"
+#include "exception.hpp"
+
+namespace kpmeans { namespace base {
+
+void csr_matrix::compute_sqnorms() {
+    sqnorms.resize(nrow);
+#pragma omp parallel for
+    for (size_t row = 0; row < nrow; row++) {
+        const double* vals = row_values(row);
+        double sqnorm = 0;
+        for (size_t i = 0; i < row_nnz(row); i++)
+            sqnorm += vals[i]*vals[i];
+        sqnorms[row] = sqnorm;
+    }
+}
+
+csr_matrix::ptr csr_matrix::create(const double* dense, const size_t nrow,
+        const size_t ncol) {
+    ptr mat = ptr(new csr_matrix(nrow, ncol));
+    for (size_t row = 0; row < nrow; row++) {
+        for (size_t col = 0; col < ncol; col++) {
+            if (dense[row*ncol+col] != 0) {
+                mat->indices.push_back(col);
+                mat->values.push_back(dense[row*ncol+col]);
+            }
+        }
+        mat->indptr[row+1] = mat->values.size();
+    }
+    mat->compute_sqnorms();
+    return mat;
+}
+
+csr_matrix::ptr csr_matrix::create(const size_t nrow, const size_t ncol,
+        const std::vector<size_t>& indptr,
+        const std::vector<unsigned>& indices,
+        const std::vector<double>& values) {
+    BOOST_ASSERT_MSG(indptr.size() == nrow+1 && indptr[0] == 0 &&
+            indptr[nrow] == values.size() && indices.size() == values.size(),
+            "[FATAL]: Malformed CSR matrix");
+    ptr mat = ptr(new csr_matrix(nrow, ncol));
+    mat->indptr = indptr;
+    mat->indices = indices;
+    mat->values = values;
+    mat->compute_sqnorms();
+    return mat;
+}
+
+csr_matrix::ptr csr_matrix::load(const std::string fn) {
+    FILE* f = fopen(fn.c_str(), "rb");
+    if (NULL == f)
+        throw io_exception("Cannot open CSR file '" + fn + "'");
+
+    size_t hdr[3]; // nrow, ncol, nnz
+    if (fread(hdr, sizeof(hdr), 1, f) != 1) {
+        fclose(f);
+        throw io_exception("Truncated CSR header in '" + fn + "'");
+    }
+
+    ptr mat = ptr(new csr_matrix(hdr[0], hdr[1]));
+    mat->indices.resize(hdr[2]);
+    mat->values.resize(hdr[2]);
+
+    bool ok = fread(&mat->indptr[0], sizeof(size_t)*(hdr[0]+1), 1, f) == 1;
+    if (hdr[2]) {
+        ok = ok && fread(&mat->indices[0], sizeof(unsigned)*hdr[2], 1, f) == 1;
+        ok = ok && fread(&mat->values[0], sizeof(double)*hdr[2], 1, f) == 1;
+    }
+    fclose(f);
+
+    if (!ok || mat->indptr[0] != 0 || mat->indptr[hdr[0]] != hdr[2])
+        throw io_exception("Malformed CSR file '" + fn + "'");
+    for (size_t i = 0; i < hdr[2]; i++)
+        if (mat->indices[i] >= hdr[1])
+            throw io_exception("CSR column index out of bounds in '" +
+                    fn + "'");
+
+    mat->compute_sqnorms();
+    return mat;
+}
+
+void csr_matrix::write(const std::string fn) const {
+    FILE* f = fopen(fn.c_str(), "wb");
+    if (NULL == f)
+        throw io_exception("Cannot open CSR file '" + fn + "'");
+
+    size_t hdr[3] = {nrow, ncol, get_nnz()};
+    BOOST_VERIFY(fwrite(hdr, sizeof(hdr), 1, f) == 1);
+    BOOST_VERIFY(fwrite(&indptr[0], sizeof(size_t)*(nrow+1), 1, f) == 1);
+    if (get_nnz()) {
+        BOOST_VERIFY(fwrite(&indices[0],
+                    sizeof(unsigned)*get_nnz(), 1, f) == 1);
+        BOOST_VERIFY(fwrite(&values[0], sizeof(double)*get_nnz(), 1, f) == 1);
+    }
+    fclose(f);
+}
+
+void csr_matrix::densify_row(const size_t row, double* out) const {
+    std::fill(out, out+ncol, 0);
+    const unsigned* idxs = row_indices(row);
+    const double* vals = row_values(row);
+    for (size_t i = 0; i < row_nnz(row); i++)
+        out[idxs[i]] = vals[i];
+}
+} } // End namespace kpmeans, base
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KPM_SPARSE_MATRIX_HPP__
+#define __KPM_SPARSE_MATRIX_HPP__
+
+#include <math.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "kmeans_types.hpp"
+
+namespace kpmeans { namespace base {
+
+/**
+  * \brief A row-major compressed sparse row (CSR) matrix. Row `r' holds the
+  *     nonzeros [indptr[r], indptr[r+1]) of `indices' & `values'.
+  *
+  * On disk (native endianness): nrow, ncol & nnz as size_t, then
+  *     `indptr' (nrow+1 size_t), `indices' (nnz unsigned) & `values'
+  *     (nnz double). This is the layout of a scipy csr_matrix's int64
+  *     `indptr', int32 `indices' & float64 `data' written back to back.
+  */
+class csr_matrix {
+private:
+    size_t nrow, ncol;
+    std::vector<size_t> indptr;
+    std::vector<unsigned> indices;
+    std::vector<double> values;
+    std::vector<double> sqnorms; // ||row||^2, cached once
+
+    csr_matrix(const size_t nrow, const size_t ncol) {
+        this->nrow = nrow;
+        this->ncol = ncol;
+        indptr.assign(nrow+1, 0);
+    }
+
+    void compute_sqnorms();
+
+public:
+    typedef std::shared_ptr<csr_matrix> ptr;
+
+    // Keep only the nonzeros of a row-major dense `nrow x ncol' matrix
+    static ptr create(const double* dense, const size_t nrow,
+            const size_t ncol);
+    static ptr create(const size_t nrow, const size_t ncol,
+            const std::vector<size_t>& indptr,
+            const std::vector<unsigned>& indices,
+            const std::vector<double>& values);
+    static ptr load(const std::string fn);
+    void write(const std::string fn) const;
+
+    const size_t get_nrow() const { return nrow; }
+    const size_t get_ncol() const { return ncol; }
+    const size_t get_nnz() const { return values.size(); }
+
+    const size_t row_nnz(const size_t row) const {
+        return indptr[row+1] - indptr[row];
+    }
+
+    const unsigned* row_indices(const size_t row) const {
+        return &indices[indptr[row]];
+    }
+
+    const double* row_values(const size_t row) const {
+        return &values[indptr[row]];
+    }
+
+    const double row_sqnorm(const size_t row) const {
+        return sqnorms[row];
+    }
+
+    // Write row `row' into the dense `ncol' length `out'
+    void densify_row(const size_t row, double* out) const;
+};
+
+/** \brief <x, c> touching only the nonzeros of x */
+static inline double sparse_dot(const double* vals, const unsigned* idxs,
+        const size_t nnz, const double* dense) {
+    double dot = 0;
+    for (size_t i = 0; i < nnz; i++)
+        dot += vals[i]*dense[idxs[i]];
+    return dot;
+}
+
+/**
+  * \brief Distance between a sparse row & a dense center from their cached
+  *     squared norms. Euclidean is sqrt(||x||^2 + ||c||^2 - 2<x, c>) so that
+  *     it matches `dist_comp_raw'.
+  */
+static inline double sparse_dist(const double* vals, const unsigned* idxs,
+        const size_t nnz, const double x_sqnorm, const double* center,
+        const double c_sqnorm, const dist_type_t dt) {
+    double dot = sparse_dot(vals, idxs, nnz, center);
+    if (dt == dist_type_t::COS)
+        return 1 - (dot / (sqrt(x_sqnorm)*sqrt(c_sqnorm)));
+
+    double sqdist = x_sqnorm + c_sqnorm - 2*dot;
+    return sqdist > 0 ? sqrt(sqdist) : 0; // Cancellation may go negative
+}
+} } // End namespace kpmeans, base
+#endif
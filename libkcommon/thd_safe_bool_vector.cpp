@@ -36,22 +36,22 @@ return true;
 }
 
 const bool thd_safe_bool_vector::get(const unsigned idx) const {
-    return data[idx];
+    return (*data)[idx];
 }
 
 void thd_safe_bool_vector::set(const unsigned idx, const bool val) {
     if (val) {
-        data[idx] = _bool('1');
+        (*data)[idx] = _bool('1');
     } else {
-        data[idx] = _bool('0');
+        (*data)[idx] = _bool('0');
     }
 }
 
 unsigned thd_safe_bool_vector::size() const {
-    return data.size();
+    return data->size();
 }
 
 void thd_safe_bool_vector::print() const {
-    print_vector<_bool>(data);
+    print_vector<_bool>(std::vector<_bool>(data->begin(), data->end()));
 }
 } } // End namespace kpmeans::base
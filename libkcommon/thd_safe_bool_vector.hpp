@@ -23,6 +23,8 @@
 #include <vector>
 #include <memory>
 
+#include "numa_mem.hpp"
+
 namespace kpmeans { namespace base {
 
 constexpr unsigned LEN = 2;
@@ -43,30 +45,26 @@ public:
 */
 class thd_safe_bool_vector {
 private:
-    std::vector<_bool> data;
+    page_array<_bool>::ptr data;
 
-    thd_safe_bool_vector(const size_t len) {
-        data.resize(len);
+    thd_safe_bool_vector(const size_t len, const bool init,
+            const size_t page_bytes) {
+        data = page_array<_bool>::create(len, _bool(init ? '1' : '0'),
+                -1, page_bytes);
     }
-
-    thd_safe_bool_vector(const size_t len, const bool init) :
-        thd_safe_bool_vector(len) {
-            if (init) {
-                for (unsigned i = 0; i < data.size(); i++)
-                    data[i] = _bool('1');
-            } else {
-                for (unsigned i = 0; i < data.size(); i++)
-                    data[i] = _bool('0');
-            }
-        }
 public:
     typedef std::shared_ptr<thd_safe_bool_vector> ptr;
     static ptr create(const size_t len) {
-        return ptr(new thd_safe_bool_vector(len));
+        return ptr(new thd_safe_bool_vector(len, false, 0));
     }
 
-    static ptr create(const size_t len, const bool init) {
-        return ptr(new thd_safe_bool_vector(len, init));
+    /**
+      * \param page_bytes Back the vector with huge pages of this size.
+      *     See `alloc_pages'.
+      */
+    static ptr create(const size_t len, const bool init,
+            const size_t page_bytes=0) {
+        return ptr(new thd_safe_bool_vector(len, init, page_bytes));
     }
 
     const bool get(const unsigned idx) const;
@@ -74,6 +72,10 @@ public:
     void set(const unsigned idx, const bool val);
 
     unsigned size() const;
+    // Move entries [begin, end) to `node_id'
+    void place(const size_t begin, const size_t end, const int node_id) {
+        data->place(begin, end, node_id);
+    }
     void print() const;
 };
 } } // End namespace kpmeans, base
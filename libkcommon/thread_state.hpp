@@ -26,6 +26,9 @@ namespace kpmeans {
         ALLOC_DATA, /*moving data for reduces rma*/
         KMSPP_INIT,
         EM, /*EM steps of kmeans*/
+        MB_EM, /*A mini-batch step of kmeans*/
+        SWEEP_EM, /*One E-step pass shared by several models*/
+        SPLIT_EM, /*Assign rows to the 2 children of their center (X-means)*/
         WAIT, /*When the thread is waiting for a new task*/
         EXIT /* Say goodnight */
     };
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <hwloc.h>
+
+#include <algorithm>
+#include <boost/log/trivial.hpp>
+
+#include "topology.hpp"
+#include "exception.hpp"
+
+namespace kpmeans { namespace base {
+
+bind_policy_t get_bind_policy(const std::string policy) {
+    if (policy == "node")
+        return bind_policy_t::NODE;
+    else if (policy == "pack")
+        return bind_policy_t::PACK;
+    else if (policy == "spread")
+        return bind_policy_t::SPREAD;
+    else
+        throw thread_exception(std::string("param bind policy must be one of:"
+                    " [node | pack | spread]. It is '")
+                + policy + std::string("'"));
+}
+
+/**
+  * \brief The PUs of each of the first `nnodes' NUMA nodes in the order
+  *     threads take them: the first PU of every core, then the second ...
+  */
+static void get_node_pus(const hwloc_topology_t topo, const unsigned nnodes,
+        const bool smt, std::vector<unsigned>& node_ids,
+        std::vector<std::vector<int> >& pus) {
+    const int nnuma = hwloc_get_nbobjs_by_type(topo, HWLOC_OBJ_NUMANODE);
+    for (int idx = 0; idx < nnuma && node_ids.size() < nnodes; idx++) {
+        hwloc_obj_t node = hwloc_get_obj_by_type(topo,
+                HWLOC_OBJ_NUMANODE, idx);
+
+        std::vector<std::vector<int> > core_pus;
+        hwloc_obj_t core = NULL;
+        while ((core = hwloc_get_next_obj_inside_cpuset_by_type(topo,
+                        node->cpuset, HWLOC_OBJ_CORE, core))) {
+            std::vector<int> siblings;
+            hwloc_obj_t pu = NULL;
+            while ((pu = hwloc_get_next_obj_inside_cpuset_by_type(topo,
+                            core->cpuset, HWLOC_OBJ_PU, pu)))
+                siblings.push_back(pu->os_index);
+            if (!siblings.empty())
+                core_pus.push_back(siblings);
+        }
+        if (core_pus.empty())
+            continue; // Memory-only node
+
+        std::vector<int> order;
+        for (unsigned level = 0; ; level++) {
+            size_t before = order.size();
+            for (auto& siblings : core_pus)
+                if (level < siblings.size())
+                    order.push_back(siblings[level]);
+            if (order.size() == before || !smt)
+                break;
+        }
+        node_ids.push_back(node->os_index);
+        pus.push_back(order);
+    }
+}
+
+std::vector<thread_place> get_thread_places(const unsigned nthreads,
+        const unsigned nnodes, const bind_policy_t policy, const bool smt) {
+    std::vector<thread_place> places(nthreads);
+    if (policy == bind_policy_t::NODE) {
+        for (unsigned thd_id = 0; thd_id < nthreads; thd_id++)
+            places[thd_id] = {thd_id % nnodes, -1};
+        return places;
+    }
+
+    hwloc_topology_t topo;
+    std::vector<unsigned> node_ids;
+    std::vector<std::vector<int> > pus;
+    if (!hwloc_topology_init(&topo) && !hwloc_topology_load(topo))
+        get_node_pus(topo, nnodes, smt, node_ids, pus);
+    hwloc_topology_destroy(topo);
+
+    if (node_ids.empty()) {
+        BOOST_LOG_TRIVIAL(warning) << "[WARNING]: No hwloc topology. Binding"
+            " threads to nodes only";
+        return get_thread_places(nthreads, nnodes, bind_policy_t::NODE);
+    }
+
+    std::vector<size_t> used(node_ids.size(), 0);
+    size_t npus = 0;
+    for (auto& node_pus : pus)
+        npus += node_pus.size();
+
+    for (unsigned thd_id = 0; thd_id < nthreads; thd_id++) {
+        unsigned node = 0;
+        if (policy == bind_policy_t::PACK) {
+            // Fill each node in turn. Past the last PU start over
+            size_t slot = thd_id % npus;
+            while (slot >= pus[node].size())
+                slot -= pus[node++].size();
+        } else {
+            // The node least full for its size
+            for (unsigned idx = 1; idx < node_ids.size(); idx++)
+                if ((used[idx] + 1) * pus[node].size() <
+                        (used[node] + 1) * pus[idx].size())
+                    node = idx;
+        }
+        places[thd_id] = {node_ids[node],
+            pus[node][used[node] % pus[node].size()]};
+        used[node]++;
+    }
+    return places;
+}
+} } // End namespace kpmeans, base
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KPM_TOPOLOGY_HPP__
+#define __KPM_TOPOLOGY_HPP__
+
+#include <string>
+#include <vector>
+
+namespace kpmeans { namespace base {
+
+/**
+  * NODE: Bind each thread to node (thread id % # nodes) only, so the OS may
+  *     move it between the node's cores & hyperthreads.
+  * PACK: Pin each thread to a core, filling a node before the next.
+  * SPREAD: Pin each thread to a core, spreading the threads over the nodes
+  *     in proportion to their core counts.
+  */
+enum class bind_policy_t {
+    NODE,
+    PACK,
+    SPREAD
+};
+
+bind_policy_t get_bind_policy(const std::string policy);
+
+// Where one thread runs
+struct thread_place {
+    unsigned node_id; // NUMA node (OS index)
+    int cpu_id; // Processing unit (OS index) pinned to. < 0 => any on the node
+};
+
+/**
+  * \brief Place `nthreads' threads on the first `nnodes' NUMA nodes of the
+  *     hwloc topology. Threads use one PU per physical core unless `smt',
+  *     in which case a core's SMT siblings are used once every core on
+  *     the node has a thread. More threads than PUs share them in turn.
+  */
+std::vector<thread_place> get_thread_places(const unsigned nthreads,
+        const unsigned nnodes, const bind_policy_t policy,
+        const bool smt=false);
+} } // End namespace kpmeans, base
+#endif
@@ -0,0 +1,75 @@
+/**
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+  * Each OpenMP thread bumps its own counter, as the E-step does for its
+  *     `num_changed'. Packed counters share cache lines across threads;
+  *     padded ones don't. Run on a 64+ thread box to see the gap widen.
+  *     Usage: bench_padded [nthreads] [iters]
+  */
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include "padded.hpp"
+
+namespace kpmbase = kpmeans::base;
+
+// Stop the compiler from keeping the counter in a register
+#define CLOBBER() __asm__ volatile("" ::: "memory")
+
+template <typename T, typename Get>
+double run(const int nthreads, const size_t iters, std::vector<T>& counts,
+        Get get) {
+    double start = omp_get_wtime();
+#pragma omp parallel num_threads(nthreads)
+    {
+        size_t& count = get(counts[omp_get_thread_num()]);
+        for (size_t i = 0; i < iters; i++) {
+            count++;
+            CLOBBER();
+        }
+    }
+    double secs = omp_get_wtime() - start;
+
+    for (int thd = 0; thd < nthreads; thd++)
+        BOOST_VERIFY(get(counts[thd]) == iters);
+    return secs;
+}
+
+int main(int argc, char* argv[]) {
+    int nthreads = argc > 1 ? atoi(argv[1]) : omp_get_max_threads();
+    size_t iters = argc > 2 ? atol(argv[2]) : 100000000;
+
+    std::vector<size_t> packed(nthreads, 0);
+    double packed_secs = run(nthreads, iters, packed,
+            [](size_t& c) -> size_t& { return c; });
+
+    std::vector<kpmbase::padded<size_t> > padded(nthreads);
+    double padded_secs = run(nthreads, iters, padded,
+            [](kpmbase::padded<size_t>& c) -> size_t& { return c.val; });
+
+    printf("%d threads, %lu increments each\n", nthreads, iters);
+    printf("packed: %.3fs, padded: %.3fs, speedup: %.2fx\n",
+            packed_secs, padded_secs, packed_secs / padded_secs);
+    return EXIT_SUCCESS;
+}
@@ -137,8 +137,34 @@ void test_prune_clusters() {
     printf("Success ...\n");
 }
 
+void test_range_peq() {
+    printf("Testing peq of a range of clusters ...\n");
+    std::vector<kpmbase::clusters::ptr> parts;
+    for (unsigned part = 0; part < 3; part++) {
+        parts.push_back(kpmbase::clusters::create(NCLUST, NCOL));
+        for (unsigned i = part; i < data.size(); i++)
+            parts.back()->add_member(&(data[i][0]), (i+part) % NCLUST,
+                    double(part+1));
+    }
+
+    kpmbase::clusters::ptr whole = kpmbase::clusters::create(NCLUST, NCOL);
+    for (unsigned part = 0; part < parts.size(); part++)
+        whole->peq(parts[part]);
+
+    // Disjoint ranges add up to the whole
+    kpmbase::clusters::ptr split = kpmbase::clusters::create(NCLUST, NCOL);
+    split->peq(parts, 0, 2);
+    split->peq(parts, 2, 2);
+    split->peq(parts, 2, NCLUST);
+    split->set_weighted();
+    BOOST_VERIFY(*split == *whole);
+    BOOST_VERIFY(split->get_weight_v() == whole->get_weight_v());
+    printf("Success ...\n");
+}
+
 int main() {
     test_clusters();
     test_prune_clusters();
+    test_range_peq();
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,93 @@
+/**
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <random>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include "kd_tree.hpp"
+#include "util.hpp"
+
+namespace kpmbase = kpmeans::base;
+
+constexpr unsigned NPOINTS = 500;
+constexpr unsigned NCOL = 8;
+constexpr unsigned NQUERIES = 2000;
+
+static unsigned scan_nearest(const std::vector<double>& points,
+        const double* query, double& best) {
+    unsigned best_idx = kpmbase::INVALID_CLUSTER_ID;
+    best = std::numeric_limits<double>::max();
+    for (unsigned i = 0; i < NPOINTS; i++) {
+        double dist = kpmbase::eucl_dist(&points[i*NCOL], query, NCOL);
+        if (dist < best) {
+            best = dist;
+            best_idx = i;
+        }
+    }
+    return best_idx;
+}
+
+void test_kd_tree() {
+    printf("Testing kd_tree ...\n");
+    std::default_random_engine generator;
+    std::normal_distribution<double> distribution(0, 1);
+
+    std::vector<double> points(NPOINTS*NCOL);
+    for (size_t i = 0; i < points.size(); i++)
+        points[i] = distribution(generator);
+
+    kpmbase::kd_tree::ptr tree = kpmbase::kd_tree::create(NPOINTS, NCOL);
+    tree->build(&points[0]);
+
+    std::vector<double> query(NCOL);
+    size_t napprox_exact = 0;
+    for (unsigned q = 0; q < NQUERIES; q++) {
+        for (unsigned col = 0; col < NCOL; col++)
+            query[col] = distribution(generator);
+
+        double scan_dist, dist;
+        unsigned scan_idx = scan_nearest(points, &query[0], scan_dist);
+        BOOST_VERIFY(tree->nearest(&query[0], dist) == scan_idx);
+        BOOST_VERIFY(dist == scan_dist);
+
+        unsigned approx_idx = tree->nearest(&query[0], dist, 32);
+        BOOST_VERIFY(approx_idx < NPOINTS && dist >= scan_dist);
+        if (approx_idx == scan_idx)
+            napprox_exact++;
+    }
+    printf("Approximate (32 checks) found the nearest for %lu/%u queries\n",
+            napprox_exact, NQUERIES);
+
+    // Rebuilding over moved points must give the new answer
+    for (size_t i = 0; i < points.size(); i++)
+        points[i] += .5;
+    tree->build(&points[0]);
+    double scan_dist, dist;
+    BOOST_VERIFY(tree->nearest(&query[0], dist) ==
+            scan_nearest(points, &query[0], scan_dist));
+    printf("Success ...\n");
+}
+
+int main(int argc, char* argv[]) {
+    test_kd_tree();
+    return EXIT_SUCCESS;
+}
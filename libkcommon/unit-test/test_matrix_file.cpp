@@ -0,0 +1,95 @@
+/**
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include "matrix_file.hpp"
+#include "exception.hpp"
+#include "io.hpp"
+
+namespace kpmbase = kpmeans::base;
+
+constexpr size_t NROW = 1000;
+constexpr size_t NCOL = 7; // Rows straddle pages
+const std::string FN = "test_matrix_file.bin";
+
+void test_matrix_file() {
+    printf("Testing matrix_file ...\n");
+    std::vector<double> data(NROW*NCOL);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = i*.5;
+
+    // Raw files have no header
+    {
+        kpmbase::bin_io<double> bw(FN, "wb");
+        bw.write(data, data.size());
+    }
+    kpmbase::matrix_header hdr;
+    BOOST_VERIFY(!kpmbase::read_header(FN, hdr));
+    BOOST_VERIFY(kpmbase::get_data_offset(FN) == 0);
+
+    kpmbase::write_matrix(FN, &data[0], NROW, NCOL);
+    BOOST_VERIFY(kpmbase::read_header(FN, hdr));
+    BOOST_VERIFY(hdr.nrow == NROW && hdr.ncol == NCOL);
+    BOOST_VERIFY(hdr.alignment == kpmbase::DEFAULT_MATRIX_ALIGNMENT);
+    BOOST_VERIFY(kpmbase::get_data_offset(FN) == hdr.alignment);
+
+    // Any slice maps to the same rows, whatever its offset in the page
+    size_t starts[] = {0, 1, 73, NROW-1};
+    for (size_t start : starts) {
+        const size_t nrows = std::min<size_t>(100, NROW - start);
+        kpmbase::mapped_rows::ptr rows = kpmbase::mapped_rows::create(FN,
+                hdr.alignment + start*NCOL*sizeof(double),
+                nrows*NCOL*sizeof(double));
+        rows->place(0);
+        BOOST_VERIFY(!memcmp(rows->get_data(), &data[start*NCOL],
+                    nrows*NCOL*sizeof(double)));
+
+        // Private: writes never reach the file
+        rows->get_data()[0] = -1;
+    }
+    kpmbase::mapped_rows::ptr all = kpmbase::mapped_rows::create(FN,
+            hdr.alignment, data.size()*sizeof(double));
+    BOOST_VERIFY(!memcmp(all->get_data(), &data[0],
+                data.size()*sizeof(double)));
+
+    // A header that disagrees with the file size is rejected
+    {
+        kpmbase::bin_io<double> bw(FN, "ab");
+        bw.write(data, 1);
+    }
+    bool thrown = false;
+    try {
+        kpmbase::read_header(FN, hdr);
+    } catch (kpmbase::io_exception& e) {
+        thrown = true;
+    }
+    BOOST_VERIFY(thrown);
+    remove(FN.c_str());
+    printf("Success ...\n");
+}
+
+int main(int argc, char* argv[]) {
+    test_matrix_file();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+/**
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <numa.h>
+#include <limits>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include "numa_mem.hpp"
+#include "thd_safe_bool_vector.hpp"
+
+namespace kpmbase = kpmeans::base;
+
+void test_alloc_pages() {
+    printf("Testing alloc_pages ...\n");
+    const size_t sizes[] = {1, 4096, (3UL << 20) + 5};
+    const size_t pages[] = {0, kpmbase::HUGE_PAGE_2MB,
+        kpmbase::HUGE_PAGE_1GB};
+
+    for (size_t page_bytes : pages) {
+        for (int node_id = -1; node_id <= 0; node_id++) {
+            for (size_t nbytes : sizes) {
+                size_t alloc_bytes;
+                char* addr = static_cast<char*>(kpmbase::alloc_pages(
+                            nbytes, node_id, page_bytes, alloc_bytes));
+                BOOST_VERIFY(alloc_bytes >= nbytes);
+                // Huge pages or not, the region starts on a THP boundary
+                if (page_bytes)
+                    BOOST_VERIFY(!(reinterpret_cast<size_t>(addr) %
+                                kpmbase::HUGE_PAGE_2MB));
+                memset(addr, 0xAB, nbytes);
+                BOOST_VERIFY(addr[nbytes-1] == (char)0xAB);
+                kpmbase::free_pages(addr, alloc_bytes);
+            }
+        }
+    }
+    printf("Success ...\n");
+}
+
+void test_page_array() {
+    printf("Testing page_array ...\n");
+    kpmbase::page_array<double>::ptr arr =
+        kpmbase::page_array<double>::create(100000,
+                std::numeric_limits<double>::max(), 0,
+                kpmbase::HUGE_PAGE_2MB);
+    BOOST_VERIFY(arr->size() == 100000);
+    for (double v : *arr)
+        BOOST_VERIFY(v == std::numeric_limits<double>::max());
+    (*arr)[99999] = 1;
+    BOOST_VERIFY(arr->data()[99999] == 1);
+
+    // Halves tile the array. Pages stay put & hold their values
+    arr->place(0, 50000, 0);
+    arr->place(50000, 100000, 0);
+    void* page = arr->data() + 99999;
+    int status = -1;
+    BOOST_VERIFY(!numa_move_pages(0, 1, &page, NULL, &status, 0));
+    BOOST_VERIFY(status == 0);
+    BOOST_VERIFY((*arr)[99999] == 1 && (*arr)[0] ==
+            std::numeric_limits<double>::max());
+
+    kpmbase::thd_safe_bool_vector::ptr bv =
+        kpmbase::thd_safe_bool_vector::create(1000, true,
+                kpmbase::HUGE_PAGE_2MB);
+    bv->set(3, false);
+    BOOST_VERIFY(bv->size() == 1000 && bv->get(2) && !bv->get(3));
+
+    BOOST_VERIFY(kpmbase::get_page_bytes("4K") == 0);
+    BOOST_VERIFY(kpmbase::get_page_bytes("2M") == kpmbase::HUGE_PAGE_2MB);
+    BOOST_VERIFY(kpmbase::get_page_bytes("1G") == kpmbase::HUGE_PAGE_1GB);
+    printf("Success ...\n");
+}
+
+void test_move_range() {
+    printf("Testing move_range ...\n");
+    // Not page aligned, as a caller's buffer needn't be
+    std::vector<double> buf(3*4096 + 7, 2.5);
+    const size_t nbytes = buf.size()*sizeof(double);
+    const size_t npages = kpmbase::move_range(&buf[0], 0, nbytes/2, 0) +
+        kpmbase::move_range(&buf[0], nbytes/2, nbytes, 0);
+
+    // The halves take every page the buffer touches, once
+    const size_t page = sysconf(_SC_PAGESIZE);
+    const uintptr_t addr = reinterpret_cast<uintptr_t>(&buf[0]);
+    BOOST_VERIFY(npages == (addr + nbytes + page - 1)/page - addr/page);
+    BOOST_VERIFY(kpmbase::move_range(&buf[0], 0, nbytes, -1) == 0);
+    for (double v : buf)
+        BOOST_VERIFY(v == 2.5);
+    printf("Success ...\n");
+}
+
+int main(int argc, char* argv[]) {
+    test_alloc_pages();
+    test_page_array();
+    test_move_range();
+    return EXIT_SUCCESS;
+}
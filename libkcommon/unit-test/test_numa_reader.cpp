@@ -0,0 +1,129 @@
+/**
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <numa.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include "numa_reader.hpp"
+#include "io.hpp"
+
+namespace kpmbase = kpmeans::base;
+
+constexpr size_t NVAL = 100000; // ~800KB
+const std::string FN = "test_numa_reader.bin";
+
+void test_numa_reader() {
+    printf("Testing numa_reader ...\n");
+    std::vector<double> data(NVAL);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = i*.25;
+    {
+        kpmbase::bin_io<double> bw(FN, "wb");
+        bw.write(data, data.size());
+    }
+
+    // Unaligned ranges, up to the end of the file, over small chunks
+    size_t ranges[][2] = {{0, NVAL}, {3, 1000}, {12345, NVAL-12345},
+        {NVAL-1, 1}, {777, 0}};
+    for (unsigned direct = 0; direct < 2; direct++) {
+        for (unsigned depth = 1; depth <= 3; depth += 2) {
+            kpmbase::read_opts opts;
+            opts.chunk_bytes = 3*4096 + 5;
+            opts.depth = depth;
+            opts.direct = direct;
+
+            for (auto range : ranges) {
+                std::pair<void*, size_t> alloc;
+                char* buf = kpmbase::read_onnode(FN,
+                        range[0]*sizeof(double), range[1]*sizeof(double), 0,
+                        opts, alloc);
+                BOOST_VERIFY(buf >= alloc.first);
+                BOOST_VERIFY(!memcmp(buf, &data[range[0]],
+                            range[1]*sizeof(double)));
+                numa_free(alloc.first, alloc.second);
+            }
+        }
+    }
+    remove(FN.c_str());
+    printf("Success ...\n");
+}
+
+void test_read_overlap() {
+    printf("Testing read_chunks overlaps its reads ...\n");
+    constexpr unsigned DEPTH = 4;
+    constexpr size_t CHUNK = 1000;
+    std::vector<char> src(10*CHUNK + 123);
+    for (size_t i = 0; i < src.size(); i++)
+        src[i] = i % 127;
+
+    // Each read waits for `DEPTH' to be in flight at once. Serialized reads
+    //  only ever see 1 & time out.
+    std::mutex mtx;
+    std::condition_variable cv;
+    unsigned inflight = 0, max_inflight = 0;
+    kpmbase::pread_fn read = [&](char* buf, const size_t nbytes,
+            const size_t offset) -> ssize_t {
+        std::unique_lock<std::mutex> lock(mtx);
+        max_inflight = std::max(max_inflight, ++inflight);
+        cv.notify_all();
+        cv.wait_for(lock, std::chrono::seconds(10),
+                [&] { return max_inflight == DEPTH; });
+        inflight--;
+        const size_t n = std::min(nbytes, src.size() - offset);
+        memcpy(buf, &src[offset], n);
+        return n;
+    };
+
+    std::vector<char> dst(src.size());
+    BOOST_VERIFY(!kpmbase::read_chunks(read, &dst[0], 0, dst.size(),
+                dst.size(), CHUNK, DEPTH));
+    BOOST_VERIFY(max_inflight == DEPTH);
+    BOOST_VERIFY(dst == src);
+
+    // A failed read is reported, as is a file that ends before `need'
+    kpmbase::pread_fn fail = [](char*, size_t, size_t) -> ssize_t {
+        errno = EBADF;
+        return -1;
+    };
+    BOOST_VERIFY(kpmbase::read_chunks(fail, &dst[0], 0, dst.size(),
+                dst.size(), CHUNK, DEPTH) == EBADF);
+    kpmbase::pread_fn eof = [](char*, size_t, size_t) -> ssize_t {
+        return 0;
+    };
+    BOOST_VERIFY(kpmbase::read_chunks(eof, &dst[0], 0, dst.size(),
+                dst.size(), CHUNK, DEPTH) == EIO);
+    BOOST_VERIFY(!kpmbase::read_chunks(eof, &dst[0], 0, dst.size(), 0,
+                CHUNK, DEPTH));
+    printf("Success ...\n");
+}
+
+int main(int argc, char* argv[]) {
+    test_numa_reader();
+    test_read_overlap();
+    return EXIT_SUCCESS;
+}
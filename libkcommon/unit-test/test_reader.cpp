@@ -18,6 +18,7 @@
  */
 
 #include "io.hpp"
+#include "sparse_matrix.hpp"
 #include "util.hpp"
 
 namespace kpmbase = kpmeans::base;
@@ -65,11 +66,73 @@ void test_bin_rm_reader(std::string fn, const size_t NROW, const size_t NCOL) {
     }
 }
 
+template <typename R>
+void test_readchunk(std::string fn, const size_t NROW, const size_t NCOL) {
+    std::cout << "\nChunk reader test ...\n";
+    constexpr size_t CHUNK_ROWS = 2;
+
+    R rdr(fn);
+    rdr.set_ncol(NCOL);
+    std::vector<double> chunk(CHUNK_ROWS*NCOL);
+    std::vector<double> m;
+
+    size_t nread;
+    while ((nread = rdr.readchunk(chunk, CHUNK_ROWS))) {
+        BOOST_VERIFY(nread <= CHUNK_ROWS);
+        m.insert(m.end(), chunk.begin(), chunk.begin()+(nread*NCOL));
+    }
+
+    R rdr2(fn);
+    rdr2.set_ncol(NCOL);
+    std::vector<double> v(NCOL);
+    std::vector<double> m2;
+    while (rdr2.readline(v))
+        m2.insert(m2.end(), v.begin(), v.end());
+
+    BOOST_VERIFY(rdr.get_nrow() == NROW);
+    BOOST_VERIFY(m.size() == m2.size());
+    BOOST_VERIFY(kpmbase::eq_all<double>(&m[0], &m2[0], m.size()));
+}
+
+void test_csr(std::string fn, const size_t NROW, const size_t NCOL) {
+    std::cout << "\nCSR round trip test ...\n";
+
+    std::vector<double> m(NROW*NCOL);
+    kpmbase::bin_io<double> br(fn, NROW, NCOL);
+    br.read(&m);
+    for (size_t i = 0; i < m.size(); i += 2)
+        m[i] = 0; // Make it sparse
+
+    kpmbase::csr_matrix::ptr mat = kpmbase::csr_matrix::create(&m[0],
+            NROW, NCOL);
+    mat->write("test.csr");
+    kpmbase::csr_matrix::ptr mat2 = kpmbase::csr_matrix::load("test.csr");
+
+    BOOST_VERIFY(mat2->get_nrow() == NROW && mat2->get_ncol() == NCOL);
+    BOOST_VERIFY(mat2->get_nnz() == mat->get_nnz());
+
+    std::vector<double> row(NCOL);
+    for (size_t r = 0; r < NROW; r++) {
+        mat2->densify_row(r, &row[0]);
+        BOOST_VERIFY(kpmbase::eq_all<double>(&row[0], &m[r*NCOL], NCOL));
+        // The sparse kernel must agree with the dense one
+        BOOST_VERIFY(std::abs(kpmbase::sparse_dist(mat2->row_values(r),
+                    mat2->row_indices(r), mat2->row_nnz(r),
+                    mat2->row_sqnorm(r), &m[0], mat2->row_sqnorm(0),
+                    kpmbase::dist_type_t::EUCL) -
+                kpmbase::eucl_dist(&row[0], &m[0], NCOL)) < 1E-9);
+    }
+    remove("test.csr");
+}
+
 int main(int argc, char* argv[]) {
     size_t nrow = 5;
     size_t ncol = 3;
     test_text_reader("test.txt", nrow, ncol);
     test_bin_rm_reader("test.dat", nrow, ncol);
+    test_readchunk<kpmbase::text_reader<double> >("test.txt", nrow, ncol);
+    test_readchunk<kpmbase::bin_rm_reader<double> >("test.dat", nrow, ncol);
+    test_csr("test.dat", nrow, ncol);
 
     return EXIT_SUCCESS;
 }
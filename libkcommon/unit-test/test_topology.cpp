@@ -0,0 +1,65 @@
+/**
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <numa.h>
+#include <vector>
+
+#include <boost/assert.hpp>
+
+#include "topology.hpp"
+
+namespace kpmbase = kpmeans::base;
+
+void test_thread_places() {
+    printf("Testing get_thread_places ...\n");
+    const unsigned nnodes = numa_num_task_nodes();
+
+    std::vector<kpmbase::thread_place> places = kpmbase::get_thread_places(
+            2*nnodes + 1, nnodes, kpmbase::bind_policy_t::NODE);
+    for (unsigned thd_id = 0; thd_id < places.size(); thd_id++)
+        BOOST_VERIFY(places[thd_id].node_id == thd_id % nnodes &&
+                places[thd_id].cpu_id == -1);
+
+    kpmbase::bind_policy_t policies[] = {kpmbase::bind_policy_t::PACK,
+        kpmbase::bind_policy_t::SPREAD};
+    const unsigned ncpus = numa_num_configured_cpus();
+    for (kpmbase::bind_policy_t policy : policies) {
+        for (unsigned smt = 0; smt < 2; smt++) {
+            places = kpmbase::get_thread_places(2*ncpus + 3, nnodes,
+                    policy, smt);
+            BOOST_VERIFY(places.size() == 2*ncpus + 3);
+            for (auto& place : places) {
+                BOOST_VERIFY(place.cpu_id >= 0 &&
+                        (unsigned)place.cpu_id < ncpus);
+                BOOST_VERIFY(numa_node_of_cpu(place.cpu_id) ==
+                        (int)place.node_id);
+            }
+            // The first threads each get a core of their own
+            if (ncpus > 1)
+                BOOST_VERIFY(places[0].cpu_id != places[1].cpu_id);
+        }
+    }
+    printf("Success ...\n");
+}
+
+int main(int argc, char* argv[]) {
+    test_thread_places();
+    return EXIT_SUCCESS;
+}
@@ -18,6 +18,7 @@
  */
 
 #include <atomic>
+#include <limits>
 #include <fstream>
 #include "util.hpp"
 #include "exception.hpp"
@@ -32,7 +33,50 @@ double get_bic(const std::vector<double>& dist_v, const size_t nrow,
     }
     printf("Distance sum: %f\n", bic);
 
-    return 2*bic + log(nrow)*ncol*k;
+    return get_bic(bic, nrow, ncol, k);
+}
+
+double get_bic(const double sse, const size_t nrow,
+        const size_t ncol, const unsigned k) {
+    return 2*sse + log(nrow)*ncol*k;
+}
+
+double get_xmeans_bic(const std::vector<double>& sizes, const double sse,
+        const size_t ncol) {
+    double R = 0;
+    for (unsigned i = 0; i < sizes.size(); i++)
+        R += sizes[i];
+    const double K = sizes.size();
+    const double M = ncol;
+
+    if (R <= K) // Too few rows to estimate a variance
+        return -std::numeric_limits<double>::max();
+    if (sse <= 0) // Every component is a single point
+        return std::numeric_limits<double>::max();
+
+    // Pooled variance per dimension
+    double var = sse / ((R - K)*M);
+    double loglik = -R*log(R) - (R*M/2)*log(2*M_PI*var) - (R - K)*M/2;
+    for (unsigned i = 0; i < sizes.size(); i++)
+        if (sizes[i])
+            loglik += sizes[i]*log(sizes[i]);
+
+    // Mixing weights, the means & the shared variance
+    double nparams = (K - 1) + K*M + 1;
+    return loglik - (nparams/2)*log(R);
+}
+
+double get_sse(const double* matrix, const double* centers,
+        const unsigned* cluster_assignments, const size_t nrow,
+        const size_t ncol, const int nthreads, const double* weights) {
+    double sse = 0;
+#pragma omp parallel for num_threads(nthreads) reduction(+:sse)
+    for (size_t row = 0; row < nrow; row++) {
+        double dist = eucl_dist(&matrix[row*ncol],
+                &centers[cluster_assignments[row]*ncol], ncol);
+        sse += weights ? weights[row]*dist*dist : dist*dist;
+    }
+    return sse;
 }
 
 void spherical_projection(double* data, const size_t nrow,
@@ -73,9 +117,11 @@ init_type_t get_init_type(const std::string init) {
         return init_type_t::PLUSPLUS;
     else if (init == "none")
         return init_type_t::NONE;
+    else if (init == "subsample")
+        return init_type_t::SUBSAMPLE;
     else
         throw thread_exception(std::string("param init must be one of:"
-                    " [random | forgy | kmeanspp]. It is '")
+                    " [random | forgy | kmeanspp | subsample]. It is '")
                 + init + std::string("'"));
 }
 
@@ -37,6 +37,18 @@ namespace kpmeans { namespace base {
 
 double get_bic(const std::vector<double>& dist_v, const size_t nrow,
         const size_t ncol, const unsigned k);
+double get_bic(const double sse, const size_t nrow,
+        const size_t ncol, const unsigned k);
+// BIC of a spherical Gaussian mixture with a component per entry of `sizes'
+//  (Pelleg & Moore's X-means). A size is the total weight of the component's
+//  rows when they are weighted. Unlike `get_bic', higher is better
+double get_xmeans_bic(const std::vector<double>& sizes, const double sse,
+        const size_t ncol);
+// Sum of squared euclidean distances from each row to its assigned center,
+//  scaled by the row's weight when `weights' is given
+double get_sse(const double* matrix, const double* centers,
+        const unsigned* cluster_assignments, const size_t nrow,
+        const size_t ncol, const int nthreads, const double* weights=NULL);
 void spherical_projection(double* data, const size_t nrow,
         const size_t ncol);
 
@@ -20,8 +20,12 @@
 #include <boost/assert.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <random>
+
 #include "kcommon.hpp"
+#include "kmeans.hpp"
 #include "base_kmeans_coordinator.hpp"
+#include "base_kmeans_thread.hpp"
 
 namespace kpmeans {
 base_kmeans_coordinator::base_kmeans_coordinator(const std::string fn,
@@ -46,13 +50,21 @@ base_kmeans_coordinator::base_kmeans_coordinator(const std::string fn,
     this->_init_t = it;
     this->tolerance = tolerance;
     this->_dist_t = dt;
+    this->sample_frac = DEFAULT_SAMPLE_FRAC;
+    seed = std::default_random_engine::default_seed;
+    weights = NULL;
+    sse_tol = -1;
+    shift_tol = -1;
+    exact_sse = false;
+    data_loaded = false;
     num_changed = 0;
     pending_threads = 0;
 
-    BOOST_VERIFY(cluster_assignments = new unsigned [nrow]);
+    assignments_mem = kpmbase::page_array<unsigned>::create(nrow,
+            kpmbase::INVALID_CLUSTER_ID);
+    cluster_assignments = assignments_mem->data();
     BOOST_VERIFY(cluster_assignment_counts = new size_t [k]);
 
-    clear_cluster_assignments();
     std::fill(cluster_assignment_counts,
             cluster_assignment_counts+k, 0);
 
@@ -64,6 +76,141 @@ base_kmeans_coordinator::base_kmeans_coordinator(const std::string fn,
     pthread_cond_init(&cond, NULL);
 }
 
+void base_kmeans_coordinator::set_weights(const double* weights) {
+    this->weights = weights;
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it)
+        (*it)->set_weights_ptr(weights);
+}
+
+void base_kmeans_coordinator::set_read_opts(const kpmbase::read_opts& io_opts) {
+    const bool remap = io_opts.page_bytes != this->io_opts.page_bytes;
+    this->io_opts = io_opts;
+    if (remap) {
+        BOOST_ASSERT_MSG(!data_loaded, "[FATAL]: Set the page size"
+                " before the data is loaded");
+        remap_row_arrays();
+    }
+}
+
+void base_kmeans_coordinator::set_thread_binding(
+        const kpmbase::bind_policy_t policy, const bool smt) {
+    BOOST_ASSERT_MSG(!data_loaded, "[FATAL]: Bind the threads before the"
+            " data is loaded");
+    std::vector<kpmbase::thread_place> places =
+        kpmbase::get_thread_places(threads.size(), nnodes, policy, smt);
+
+    for (unsigned thd_id = 0; thd_id < threads.size(); thd_id++) {
+        threads[thd_id]->set_placement(places[thd_id].node_id,
+                places[thd_id].cpu_id);
+        BOOST_LOG_TRIVIAL(info) << "Thread " << thd_id << " => node " <<
+            places[thd_id].node_id << ", PU " << places[thd_id].cpu_id;
+    }
+}
+
+void base_kmeans_coordinator::remap_row_arrays() {
+    kpmbase::page_array<unsigned>::ptr mem =
+        kpmbase::page_array<unsigned>::create(nrow,
+                kpmbase::INVALID_CLUSTER_ID, -1, io_opts.page_bytes);
+    std::copy(cluster_assignments, cluster_assignments+nrow, mem->data());
+    assignments_mem = mem;
+    cluster_assignments = mem->data();
+
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it)
+        (*it)->set_cluster_assignments_ptr(cluster_assignments);
+}
+
+void base_kmeans_coordinator::set_assignments_ptr(unsigned* v) {
+    cluster_assignments = v;
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it)
+        (*it)->set_cluster_assignments_ptr(cluster_assignments);
+}
+
+void base_kmeans_coordinator::set_in_mem(const double* data,
+        const kpmbase::buffer_use_t use) {
+    BOOST_ASSERT_MSG(!data_loaded, "[FATAL]: Set the rows before the data"
+            " is loaded");
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it)
+        (*it)->set_in_mem(data, use);
+}
+
+size_t base_kmeans_coordinator::run_kmeans(unsigned* assignments,
+        size_t* counts, double* centers) {
+    // Points the threads back at our own assignments on every way out of
+    //  `run', so none keeps writing to the caller's buffer
+    class assignments_guard {
+    private:
+        base_kmeans_coordinator& coord;
+
+    public:
+        assignments_guard(base_kmeans_coordinator& coord,
+                unsigned* assignments) : coord(coord) {
+            coord.set_assignments_ptr(assignments);
+        }
+
+        ~assignments_guard() {
+            coord.set_assignments_ptr(coord.assignments_mem->data());
+        }
+    };
+
+    std::fill(assignments, assignments+nrow, kpmbase::INVALID_CLUSTER_ID);
+    size_t iters;
+    {
+        assignments_guard guard(*this, assignments);
+        iters = run();
+    }
+
+    std::copy(cluster_assignment_counts, cluster_assignment_counts+k, counts);
+    const std::vector<double>& means = get_centers();
+    std::copy(means.begin(), means.end(), centers);
+    return iters;
+}
+
+void base_kmeans_coordinator::load_data() {
+    if (data_loaded)
+        return;
+
+    size_t nbytes = 0;
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it) {
+        (*it)->set_read_opts(io_opts);
+        nbytes += (*it)->get_data_size();
+    }
+
+    struct timeval start, end;
+    gettimeofday(&start , NULL);
+    wake4run(ALLOC_DATA);
+    wait4complete();
+    gettimeofday(&end, NULL);
+    data_loaded = true;
+
+    double secs = kpmbase::time_diff(start, end);
+    BOOST_LOG_TRIVIAL(info) << "Loaded " << (nbytes / (double)(1 << 20)) <<
+        " MB in " << secs << " sec (" << (secs > 0 ?
+                (nbytes / (double)(1 << 20)) / secs : 0) << " MB/s)";
+}
+
+bool base_kmeans_coordinator::check_objective(const double sse,
+        const double max_shift) {
+    sse_history.push_back(sse);
+    BOOST_LOG_TRIVIAL(info) << "SSE" << (exact_sse ? ": " : " <= ") << sse
+        << ", max center shift: " << max_shift;
+
+    if (shift_tol >= 0 && max_shift <= shift_tol) {
+        BOOST_LOG_TRIVIAL(info) << "No center moved further than " <<
+            shift_tol;
+        return true;
+    }
+
+    if (sse_tol >= 0 && sse_history.size() > 1) {
+        const double prev_sse = sse_history[sse_history.size()-2];
+        if (prev_sse > 0 && fabs(prev_sse - sse) / prev_sse <= sse_tol) {
+            BOOST_LOG_TRIVIAL(info) << "Relative SSE change is <= " <<
+                sse_tol;
+            return true;
+        }
+    }
+    return false;
+}
+
 void base_kmeans_coordinator::wait4complete() {
     //printf("Coordinator entering wait4complete ..\n");
     pthread_mutex_lock(&mutex);
@@ -73,4 +220,55 @@ void base_kmeans_coordinator::wait4complete() {
     pthread_mutex_unlock(&mutex);
     //printf("Coordinator exiting wait4complete!!\n");
 }
+
+/**
+  * \brief Cluster a uniform sample of the data in memory with the pruned
+  *     OpenMP engine & hand back the converged centers. These are then used
+  *     as the (NONE) starting centers of the full run.
+  * \param centers The `k x ncol' converged centers of the sample.
+  */
+void base_kmeans_coordinator::sample_centers(std::vector<double>& centers) {
+    struct timeval start, end;
+    gettimeofday(&start , NULL);
+
+    size_t nsample = std::min(nrow,
+            std::max((size_t)(nrow*sample_frac), (size_t)k));
+    BOOST_LOG_TRIVIAL(info) << "Subsample init of " << nsample << " rows";
+
+    // Stratified uniform sample i.e. one random row per `stride' rows
+    std::vector<size_t> sample_ids(nsample);
+    double stride = nrow / (double)nsample;
+    std::default_random_engine generator(seed);
+    std::uniform_real_distribution<double> distribution(0, 1);
+    for (size_t i = 0; i < nsample; i++)
+        sample_ids[i] = std::min(nrow - 1,
+                (size_t)((i + distribution(generator))*stride));
+
+    std::vector<double> sample(nsample*ncol);
+    std::vector<double> sample_weights(weights ? nsample : 0);
+#pragma omp parallel for num_threads(nthreads) shared(sample, sample_ids)
+    for (size_t i = 0; i < nsample; i++) {
+        const double* row = get_thd_data(sample_ids[i]);
+        std::copy(row, row+ncol, &sample[i*ncol]);
+        if (weights)
+            sample_weights[i] = weights[sample_ids[i]];
+    }
+
+    centers.resize(k*ncol);
+    std::vector<unsigned> sample_asgns(nsample);
+    std::vector<size_t> sample_asgn_cnts(k);
+
+    kpmbase::kmeans_t ret = kpmeans::omp::compute_min_kmeans(&sample[0],
+            &centers[0], &sample_asgns[0], &sample_asgn_cnts[0],
+            nsample, ncol, k, std::numeric_limits<size_t>::max(), nthreads,
+            "kmeanspp", tolerance,
+            _dist_t == kpmbase::dist_type_t::COS ? "cos" : "eucl", 1,
+            weights ? &sample_weights[0] : NULL);
+    centers = ret.centroids;
+
+    gettimeofday(&end, NULL);
+    BOOST_LOG_TRIVIAL(info) << "Subsample converged in " << ret.iters <<
+        " iterations. Initialization time: " <<
+        kpmbase::time_diff(start, end) << " sec\n";
+}
 } // End namespace kpmeans
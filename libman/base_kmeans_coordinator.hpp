@@ -24,10 +24,16 @@
 #include <unordered_map>
 #include <memory>
 #include <atomic>
+#include <random>
+
+#include <boost/assert.hpp>
 
 #include "kmeans_types.hpp"
 #include "thread_state.hpp"
 #include "exception.hpp"
+#include "numa_reader.hpp"
+#include "numa_mem.hpp"
+#include "topology.hpp"
 
 #ifdef PROFILER
 #include <gperftools/profiler.h>
@@ -38,18 +44,31 @@ namespace kpmeans {
 
 class base_kmeans_thread;
 
+// Fraction of the rows clustered in memory by a `subsample' init
+constexpr double DEFAULT_SAMPLE_FRAC = .02;
+
 class base_kmeans_coordinator {
 protected:
     unsigned nthreads, nnodes;
     size_t nrow, ncol;
     std::string fn; // file on disk
     unsigned* cluster_assignments;
+    kpmbase::page_array<unsigned>::ptr assignments_mem; // Backs the above
     size_t* cluster_assignment_counts;
     unsigned k;
     kpmbase::init_type_t _init_t;
     kpmbase::dist_type_t _dist_t;
     double tolerance;
     unsigned max_iters;
+    double sample_frac; // Fraction of rows drawn by the SUBSAMPLE init
+    unsigned seed; // Seeds the random, forgy & subsample inits
+    const double* weights; // Per-row weights (not owned). NULL => all 1
+    double sse_tol; // Stop once the relative SSE change is <= this. < 0 => off
+    double shift_tol; // Stop once no center moves > this. < 0 => off
+    bool exact_sse; // Recompute the SSE each iteration rather than bound it
+    std::vector<double> sse_history; // The (bound on the) SSE per iteration
+    kpmbase::read_opts io_opts; // How the threads read their rows
+    bool data_loaded; // The threads hold their NUMA-local rows
     size_t num_changed; // total # samples changed in an iter
     // how many threads have not completed their task
     std::atomic<unsigned> pending_threads;
@@ -66,6 +85,25 @@ protected:
             const double* centers, const kpmbase::init_type_t it,
             const double tolerance, const kpmbase::dist_type_t dt);
 
+    void sample_centers(std::vector<double>& centers);
+    /**
+      * \brief Record this iteration's SSE & apply the objective stopping
+      *     rules to it & to the largest center shift.
+      * \return true if either rule says the run has converged.
+      */
+    bool check_objective(const double sse, const double max_shift);
+    // Each thread reads its rows into NUMA-local memory once
+    void load_data();
+    // Move the per-row arrays onto pages of `io_opts.page_bytes'
+    virtual void remap_row_arrays();
+    // Have the engine assign rows into `v' (`nrow' long) from now on
+    virtual void set_assignments_ptr(unsigned* v);
+    // Run per the parameters, leaving the result in our own state
+    virtual size_t run() { throw kpmbase::not_implemented_exception(); }
+    virtual const std::vector<double>& get_centers() {
+        throw kpmbase::abstract_exception();
+    }
+
 public:
     const size_t get_num_changed() const { return num_changed; }
     typedef std::shared_ptr<base_kmeans_coordinator> ptr;
@@ -76,8 +114,19 @@ public:
     virtual void run_init() = 0;
     virtual void random_partition_init() = 0;
     virtual void forgy_init() = 0;
+    virtual void subsample_init() = 0;
 
     virtual kpmbase::kmeans_t run_kmeans() = 0;
+    /**
+      * \brief Run, but leave the result in the caller's buffers rather than
+      *     in a `kmeans_t'. The threads assign rows straight into
+      *     `assignments' so the `nrow' of them are never copied.
+      * \param assignments `nrow' cluster ids.
+      * \param counts `k' cluster sizes.
+      * \param centers `k' x `ncol' row-major centers.
+      * \return The number of iterations.
+      */
+    size_t run_kmeans(unsigned* assignments, size_t* counts, double* centers);
     virtual void kmeanspp_init() = 0;
     virtual void wake4run(thread_state_t state) = 0;
     virtual const double* get_thd_data(const unsigned row_id) const = 0;
@@ -105,6 +154,71 @@ public:
         std::fill(cluster_assignments,
                 cluster_assignments+nrow, kpmbase::INVALID_CLUSTER_ID);
     }
+    void set_sample_frac(const double sample_frac) {
+        if (!(sample_frac > 0 && sample_frac <= 1))
+            throw kpmbase::parameter_exception("The sample fraction must be"
+                    " in (0, 1]. It is " + std::to_string(sample_frac));
+        this->sample_frac = sample_frac;
+    }
+
+    void set_seed(const unsigned seed) {
+        this->seed = seed;
+    }
+
+    /**
+      * \brief Weigh each row's contribution to its center, the kmeans++
+      *     sampling & the SSE. The buffer holds `nrow' weights, must outlive
+      *     the coordinator & is not copied.
+      */
+    virtual void set_weights(const double* weights);
+    const double* get_weights() const { return weights; }
+
+    // Stop once |SSE - prev SSE| / prev SSE <= sse_tol. < 0 => off
+    void set_sse_tolerance(const double sse_tol) {
+        this->sse_tol = sse_tol;
+    }
+
+    // Stop once no center moves further than shift_tol. < 0 => off
+    void set_shift_tolerance(const double shift_tol) {
+        this->shift_tol = shift_tol;
+    }
+
+    /**
+      * \brief The pruned engine tracks an upper bound on the SSE from its
+      *     row bounds at no cost. Set this to pay a pass over the data per
+      *     iteration for the exact value instead.
+      */
+    void set_exact_sse(const bool exact_sse) {
+        this->exact_sse = exact_sse;
+    }
+
+    /**
+      * \brief How the threads read their rows. A `page_bytes' other than the
+      *     current one also moves the per-row arrays (assignments, bounds
+      *     ...) onto huge pages, so set it before the data is loaded.
+      */
+    void set_read_opts(const kpmbase::read_opts& io_opts);
+
+    /**
+      * \brief Cluster the caller's `nrow' x `ncol' row-major matrix rather
+      *     than the file. The buffer is never written & must outlive the
+      *     coordinator unless `use' is COPY. Set before the data is loaded.
+      */
+    void set_in_mem(const double* data, const kpmbase::buffer_use_t use);
+
+    /**
+      * \brief Pin the threads to cores per `policy'. See `get_thread_places'.
+      *     A thread's rows go to its node, so set this before the data is
+      *     loaded.
+      * \param smt Also use the SMT siblings (hyperthreads) of each core.
+      */
+    virtual void set_thread_binding(const kpmbase::bind_policy_t policy,
+            const bool smt=false);
+
+    const std::vector<double>& get_sse_history() const {
+        return sse_history;
+    }
+
     const size_t get_nrow() { return nrow; }
     const size_t get_ncol() { return ncol; }
 };
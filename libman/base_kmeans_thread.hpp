@@ -32,6 +32,10 @@
 
 #include "thread_state.hpp"
 #include "exception.hpp"
+#include "matrix_file.hpp"
+#include "numa_reader.hpp"
+#include "numa_mem.hpp"
+#include "padded.hpp"
 
 #define VERBOSE 0
 #define INVALID_THD_ID -1
@@ -41,7 +45,9 @@ class task_queue;
 
 namespace base {
     class clusters;
+    class prune_clusters;
     class thd_safe_bool_vector;
+    class kd_tree;
 }
 
 namespace prune {
@@ -63,6 +69,8 @@ class base_kmeans_thread {
 protected:
     pthread_t hw_thd;
     unsigned node_id; // Which NUMA node are you on?
+    int cpu_id; // Which PU are you pinned to? < 0 => any on `node_id'
+    std::atomic<bool> moved; // `set_placement' since we last bound
     int thd_id;
     size_t start_rid; // With respect to the original data
     size_t ncol; // How many columns in the data
@@ -77,15 +85,26 @@ protected:
     pthread_cond_t* parent_cond;
     std::atomic<unsigned>* parent_pending_threads;
 
-    metaunion meta;
+    // Updated for every row by this thread alone. On a cache line of their
+    //  own so that writes to the fields around them don't bounce it
+    alignas(kpmbase::CACHE_LINE_SIZE) metaunion meta;
+    double cuml_dist;
     //unsigned num_changed;
 
-    FILE* f; // Data file on disk
+    alignas(kpmbase::CACHE_LINE_SIZE) FILE* f; // Data file on disk
+    std::string fn;
+    size_t data_offset; // Of the first row in `fn'. > 0 => mapped in place
+    kpmbase::mapped_rows::ptr mapped;
+    kpmbase::read_opts io_opts;
+    std::pair<void*, size_t> alloc; // What `local_data' was read into
+    const double* in_mem; // All the caller's rows, used instead of `fn'
+    kpmbase::buffer_use_t in_mem_use;
     unsigned* cluster_assignments;
 
-    thread_state_t state;
-    double* dist_v;
-    double cuml_dist;
+    // The coordinator writes it to wake us: kept off the lines we read per row
+    alignas(kpmbase::CACHE_LINE_SIZE) thread_state_t state;
+    alignas(kpmbase::CACHE_LINE_SIZE) double* dist_v;
+    const double* weights; // Per-row weights, indexed like cluster_assignments
 
     friend void* callback(void* arg);
 
@@ -99,13 +118,25 @@ protected:
         pthread_mutex_init(&mutex, &mutex_attr);
         pthread_cond_init(&cond, NULL);
         this->node_id = node_id;
+        this->cpu_id = -1;
+        this->moved = false;
         this->thd_id = thd_id;
         this->ncol = ncol;
         this->cluster_assignments = cluster_assignments;
         this->start_rid = start_rid;
-        BOOST_VERIFY(this->f = fopen(fn.c_str(), "rb"));
+        this->fn = fn;
+        // No file => the rows come from `set_in_mem'
+        f = NULL;
+        data_offset = 0;
+        if (!fn.empty()) {
+            BOOST_VERIFY(this->f = fopen(fn.c_str(), "rb"));
+            data_offset = kpmbase::get_data_offset(fn);
+        }
+        in_mem = NULL;
+        in_mem_use = kpmbase::buffer_use_t::IN_PLACE;
 
         meta.num_changed = 0; // Same as meta.clust_idx = 0;
+        weights = NULL;
         set_thread_state(WAIT);
     }
 
@@ -134,6 +165,13 @@ public:
     virtual void set_prune_init(const bool prune_init) {
         throw kpmbase::abstract_exception();
     }
+    virtual void set_batch_rows(const size_t batch_rows) {
+        throw kpmbase::abstract_exception();
+    }
+    virtual void set_g_clusters(std::shared_ptr<kpmbase::prune_clusters>
+            g_clusters) {
+        throw kpmbase::abstract_exception();
+    }
     virtual void set_recalc_v_ptr(std::shared_ptr<kpmbase::thd_safe_bool_vector>
             recalculated_v) {
         throw kpmbase::abstract_exception();
@@ -141,6 +179,10 @@ public:
     virtual void set_dist_mat_ptr(std::shared_ptr<kpmprune::dist_matrix> dm) {
         throw kpmbase::abstract_exception();
     }
+    virtual void set_centroid_index(std::shared_ptr<kpmbase::kd_tree> cindex,
+            const size_t max_checks) {
+        throw kpmbase::abstract_exception();
+    }
     virtual bool try_steal_task() { throw kpmbase::abstract_exception(); }
     virtual task_queue* get_task_queue() {
         throw kpmbase::abstract_exception();
@@ -157,6 +199,14 @@ public:
         dist_v = v;
     }
 
+    void set_cluster_assignments_ptr(unsigned* v) {
+        cluster_assignments = v;
+    }
+
+    void set_weights_ptr(const double* v) {
+        weights = v;
+    }
+
     const thread_state_t get_state() const {
         return this->state;
     }
@@ -213,8 +263,26 @@ public:
         parent_pending_threads = ppt;
     }
 
+    void set_read_opts(const kpmbase::read_opts& io_opts) {
+        this->io_opts = io_opts;
+    }
+
+    /**
+      * \brief Take our rows from `data', all the rows of the matrix in
+      *     row-major order, rather than from the file. See `buffer_use_t'.
+      *     The buffer is never written & must outlive us unless copied.
+      */
+    void set_in_mem(const double* data, const kpmbase::buffer_use_t use) {
+        in_mem = data;
+        in_mem_use = use;
+    }
+
     void destroy_numa_mem() {
-        numa_free(local_data, get_data_size());
+        if (mapped)
+            mapped = NULL;
+        else if (alloc.first)
+            kpmbase::free_pages(alloc.first, alloc.second);
+        alloc = std::pair<void*, size_t>(NULL, 0);
     }
 
     const size_t get_start_rid() const {
@@ -249,16 +317,46 @@ public:
         f = NULL;
     }
 
-    // Move data ~equally to all nodes
+    // Move data ~equally to all nodes. A file with a header is mapped
+    //  rather than copied & its pages are placed on our node
     void numa_alloc_mem() {
+        if (in_mem) {
+            numa_alloc_in_mem();
+            return;
+        }
+
         BOOST_ASSERT_MSG(f, "File handle invalid, can only alloc once!");
         size_t blob_size = get_data_size();
-        local_data = static_cast<double*>(numa_alloc_onnode(blob_size, node_id));
-        fseek(f, start_rid*ncol*sizeof(double), SEEK_SET); // start position
-        BOOST_VERIFY(1 == fread(local_data, blob_size, 1, f));
+        if (data_offset) {
+            mapped = kpmbase::mapped_rows::create(fn,
+                    data_offset + start_rid*ncol*sizeof(double), blob_size);
+            mapped->place(node_id);
+            local_data = mapped->get_data();
+        } else {
+            local_data = reinterpret_cast<double*>(kpmbase::read_onnode(fn,
+                        start_rid*ncol*sizeof(double), blob_size, node_id,
+                        io_opts, alloc));
+        }
         close_file_handle();
     }
 
+    void numa_alloc_in_mem() {
+        const double* rows = in_mem + start_rid*ncol;
+        const size_t blob_size = get_data_size();
+
+        if (in_mem_use == kpmbase::buffer_use_t::COPY) {
+            local_data = static_cast<double*>(kpmbase::alloc_pages(blob_size,
+                        node_id, io_opts.page_bytes, alloc.second));
+            alloc.first = local_data;
+            std::copy(rows, rows + blob_size/sizeof(double), local_data);
+        } else {
+            if (in_mem_use == kpmbase::buffer_use_t::MOVE)
+                kpmbase::move_range(in_mem, start_rid*ncol*sizeof(double),
+                        start_rid*ncol*sizeof(double) + blob_size, node_id);
+            local_data = const_cast<double*>(rows); // Only ever read
+        }
+    }
+
     ~base_kmeans_thread() {
         pthread_cond_destroy(&cond);
         pthread_mutex_destroy(&mutex);
@@ -278,6 +376,35 @@ public:
         numa_bitmask_setbit(bmp, node_id);
         numa_bind(bmp);
         numa_free_nodemask(bmp);
+
+        if (cpu_id >= 0) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(cpu_id, &cpus);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus))
+                BOOST_LOG_TRIVIAL(warning) << "[WARNING]: Thread " << thd_id
+                    << " cannot be pinned to PU " << cpu_id;
+        }
+    }
+
+    /**
+      * \brief Run on `node_id' & if `cpu_id' >= 0 on that PU only. Applied by
+      *     the thread itself when it next wakes. Set before the data is
+      *     loaded as the rows go to `node_id'.
+      */
+    void set_placement(const unsigned node_id, const int cpu_id) {
+        this->node_id = node_id;
+        this->cpu_id = cpu_id;
+        moved = true;
+    }
+
+    void bind_if_moved() {
+        if (moved.exchange(false))
+            bind2node_id();
+    }
+
+    const int get_cpu_id() const {
+        return cpu_id;
     }
 };
 }
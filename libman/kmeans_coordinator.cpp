@@ -26,6 +26,7 @@
 #include "util.hpp"
 #include "io.hpp"
 #include "clusters.hpp"
+#include "kd_tree.hpp"
 
 namespace kpmeans {
 kmeans_coordinator::kmeans_coordinator(const std::string fn, const size_t nrow,
@@ -92,9 +93,21 @@ const double* kmeans_coordinator::get_thd_data(const unsigned row_id) const {
             [(row_id-(parent_thd*rows_per_thread))*ncol]);
 }
 
-void kmeans_coordinator::update_clusters() {
+void kmeans_coordinator::set_index_checks(const size_t max_checks) {
+    if (_dist_t != kpmbase::dist_type_t::EUCL)
+        throw kpmbase::not_implemented_exception();
+
+    cindex = kpmbase::kd_tree::create(k, ncol);
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it)
+        (*it)->set_centroid_index(cindex, max_checks);
+}
+
+void kmeans_coordinator::update_clusters(const bool full) {
     num_changed = 0; // Always reset here since there's no pruning
-    cltrs->clear();
+    if (full)
+        cltrs->clear();
+    else
+        cltrs->unfinalize_all();
 
     // Serial aggreate of OMP_MAX_THREADS vectors
     for (thread_iter it = threads.begin(); it != threads.end(); ++it) {
@@ -186,7 +199,7 @@ void kmeans_coordinator::kmeanspp_init() {
             break;
 
         for (size_t row = 0; row < nrow; row++) {
-            cuml_dist -= dist_v[row];
+            cuml_dist -= weights ? weights[row]*dist_v[row] : dist_v[row];
             if (cuml_dist <= 0) {
 #if KM_TEST
                 BOOST_LOG_TRIVIAL(info) << "Choosing "
@@ -210,14 +223,17 @@ void kmeans_coordinator::kmeanspp_init() {
 }
 
 void kmeans_coordinator::random_partition_init() {
-    std::default_random_engine generator;
+    std::default_random_engine generator(seed);
     std::uniform_int_distribution<unsigned> distribution(0, k-1);
 
     for (unsigned row = 0; row < nrow; row++) {
         unsigned asgnd_clust = distribution(generator);
         const double* dp = get_thd_data(row);
 
-        cltrs->add_member(dp, asgnd_clust);
+        if (weights)
+            cltrs->add_member(dp, asgnd_clust, weights[row]);
+        else
+            cltrs->add_member(dp, asgnd_clust);
         cluster_assignments[row] = asgnd_clust;
     }
 
@@ -230,7 +246,7 @@ void kmeans_coordinator::random_partition_init() {
 }
 
 void kmeans_coordinator::forgy_init() {
-    std::default_random_engine generator;
+    std::default_random_engine generator(seed);
     std::uniform_int_distribution<unsigned> distribution(0, nrow-1);
 
     BOOST_LOG_TRIVIAL(info) << "Forgy init start";
@@ -241,6 +257,12 @@ void kmeans_coordinator::forgy_init() {
     BOOST_LOG_TRIVIAL(info) << "Forgy init end";
 }
 
+void kmeans_coordinator::subsample_init() {
+    std::vector<double> centers;
+    sample_centers(centers);
+    cltrs->set_mean(centers);
+}
+
 void kmeans_coordinator::run_init() {
     switch(_init_t) {
         case kpmbase::init_type_t::RANDOM:
@@ -254,6 +276,9 @@ void kmeans_coordinator::run_init() {
             break;
         case kpmbase::init_type_t::NONE:
             break;
+        case kpmbase::init_type_t::SUBSAMPLE:
+            subsample_init();
+            break;
         default:
             fprintf(stderr, "[FATAL]: Unknown initialization type\n");
             exit(EXIT_FAILURE);
@@ -264,11 +289,21 @@ void kmeans_coordinator::run_init() {
  * Main driver for kmeans
  */
 kpmbase::kmeans_t kmeans_coordinator::run_kmeans() {
+    size_t iter = run();
+    return kpmbase::kmeans_t(this->nrow, this->ncol, iter, this->k,
+            cluster_assignments, cluster_assignment_counts,
+            cltrs->get_means());
+}
+
+const std::vector<double>& kmeans_coordinator::get_centers() {
+    return cltrs->get_means();
+}
+
+size_t kmeans_coordinator::run() {
 #ifdef PROFILER
     ProfilerStart("matrix/kmeans_coordinator.perf");
 #endif
-    wake4run(ALLOC_DATA);
-    wait4complete();
+    load_data();
 
     struct timeval start, end;
     gettimeofday(&start , NULL);
@@ -277,6 +312,8 @@ kpmbase::kmeans_t kmeans_coordinator::run_kmeans() {
     // Run kmeans loop
     bool converged = false;
     size_t iter = 0;
+    sse_history.clear();
+    std::vector<double> prev_means;
 
     if (max_iters > 0)
         iter++;
@@ -286,17 +323,29 @@ kpmbase::kmeans_t kmeans_coordinator::run_kmeans() {
             clear_cluster_assignments();
 
         BOOST_LOG_TRIVIAL(info) << "E-step Iteration: " << iter;
+        if (cindex)
+            cindex->build(&(cltrs->get_means()[0]));
         wake4run(EM);
         wait4complete();
 
-        update_clusters();
+        prev_means = cltrs->get_means();
+        update_clusters(iter == 1);
 
 #if VERBOSE
         printf("Cluster assignment counts: ");
         kpmbase::print_arr(cluster_assignment_counts, k);
 #endif
 
-        if (num_changed == 0 ||
+        // The E-step distances are exact, so this is the SSE of the new
+        //  assignment against the centers it was made with
+        double max_shift = 0;
+        for (unsigned clust_idx = 0; clust_idx < k; clust_idx++)
+            max_shift = std::max(max_shift, kpmbase::eucl_dist(
+                        &(cltrs->get_means()[clust_idx*ncol]),
+                        &prev_means[clust_idx*ncol], ncol));
+
+        if (check_objective(reduction_on_cuml_sum(), max_shift) ||
+                num_changed == 0 ||
                 ((num_changed/(double)nrow)) <= tolerance) {
             converged = true;
             break;
@@ -323,9 +372,7 @@ kpmbase::kmeans_t kmeans_coordinator::run_kmeans() {
     kpmbase::print_arr(cluster_assignment_counts, k);
     BOOST_LOG_TRIVIAL(info) << "\n******************************************\n";
 
-    return kpmbase::kmeans_t(this->nrow, this->ncol, iter, this->k,
-            cluster_assignments, cluster_assignment_counts,
-            cltrs->get_means());
+    return iter;
 }
 
 kmeans_coordinator::~kmeans_coordinator() {
@@ -333,7 +380,6 @@ kmeans_coordinator::~kmeans_coordinator() {
     for (; it != threads.end(); ++it)
         (*it)->destroy_numa_mem();
 
-    delete [] cluster_assignments;
     delete [] cluster_assignment_counts;
 
     pthread_cond_destroy(&cond);
@@ -30,6 +30,7 @@ namespace kpmeans {
 class base_kmeans_thread;
     namespace base {
     class clusters;
+    class kd_tree;
 } }
 
 namespace kpmeans {
@@ -39,6 +40,9 @@ class kmeans_coordinator : public kpmeans::base_kmeans_coordinator {
         // max index stored within each threads partition
         std::vector<unsigned> thd_max_row_idx;
         std::shared_ptr<kpmbase::clusters> cltrs;
+        // Center index the threads query, rebuilt each iteration. See
+        //  `set_index_checks'
+        std::shared_ptr<kpmbase::kd_tree> cindex;
 
         kmeans_coordinator(const std::string fn, const size_t nrow,
                 const size_t ncol, const unsigned k, const unsigned max_iters,
@@ -46,7 +50,12 @@ class kmeans_coordinator : public kpmeans::base_kmeans_coordinator {
                 const double* centers, const kpmbase::init_type_t it,
                 const double tolerance, const kpmbase::dist_type_t dt);
 
+        size_t run() override;
+        const std::vector<double>& get_centers() override;
+
     public:
+        using base_kmeans_coordinator::run_kmeans;
+
         static base_kmeans_coordinator::ptr create(const std::string fn,
                 const size_t nrow,
                 const size_t ncol, const unsigned k, const unsigned max_iters,
@@ -67,15 +76,48 @@ class kmeans_coordinator : public kpmeans::base_kmeans_coordinator {
                     nnodes, nthreads, centers, _init_t, tolerance, _dist_t));
         }
 
+        /**
+          * \brief Cluster the caller's `nrow' x `ncol' row-major `data'
+          *     rather than a file. See `set_in_mem'.
+          */
+        static base_kmeans_coordinator::ptr create(const double* data,
+                const size_t nrow, const size_t ncol, const unsigned k,
+                const unsigned max_iters, const unsigned nnodes,
+                const unsigned nthreads,
+                const kpmbase::buffer_use_t use=
+                kpmbase::buffer_use_t::IN_PLACE,
+                const double* centers=NULL, const std::string init="kmeanspp",
+                const double tolerance=-1,
+                const std::string dist_type="eucl") {
+            base_kmeans_coordinator::ptr kc = create("", nrow, ncol, k,
+                    max_iters, nnodes, nthreads, centers, init, tolerance,
+                    dist_type);
+            kc->set_in_mem(data, use);
+            return kc;
+        }
+
         std::shared_ptr<kpmbase::clusters> get_gcltrs() {
             return cltrs;
         }
 
+        /**
+          * \brief Assign rows by querying a k-d tree over the centers
+          *     instead of scanning all `k'. Euclidean only.
+          * \param max_checks Distance computations allowed per row. 0 is
+          *     exact, > 0 approximate.
+          */
+        void set_index_checks(const size_t max_checks);
+
         std::pair<unsigned, unsigned> get_rid_len_tup(const unsigned thd_id);
         // Pass file handle to threads to read & numa alloc
         void create_thread_map();
         virtual kpmbase::kmeans_t run_kmeans() override;
-        void update_clusters();
+        /**
+          * \brief Add the threads' deltas to the cluster sums.
+          * \param full The threads added every row (the first step), so
+          *     start from empty clusters.
+          */
+        void update_clusters(const bool full);
         void kmeanspp_init();
         void wake4run(kpmeans::thread_state_t state);
         void destroy_threads();
@@ -85,6 +127,7 @@ class kmeans_coordinator : public kpmeans::base_kmeans_coordinator {
         void run_init();
         void random_partition_init();
         void forgy_init();
+        void subsample_init();
         const double* get_thd_data(const unsigned row_id) const;
         ~kmeans_coordinator();
 
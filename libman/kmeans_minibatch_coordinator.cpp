@@ -0,0 +1,160 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/log/trivial.hpp>
+
+#include "kmeans_minibatch_coordinator.hpp"
+#include "kmeans_task_thread.hpp"
+#include "kcommon.hpp"
+
+namespace kpmeans { namespace prune {
+kmeans_minibatch_coordinator::kmeans_minibatch_coordinator(const std::string fn,
+        const size_t nrow, const size_t ncol, const unsigned k,
+        const unsigned max_iters, const unsigned nnodes,
+        const unsigned nthreads, const size_t batch_size,
+        const double* centers, const kpmbase::init_type_t it,
+        const double tolerance, const kpmbase::dist_type_t dt) :
+    kmeans_task_coordinator(fn, nrow, ncol, k, max_iters,
+            nnodes, nthreads, centers, it, tolerance, dt),
+    batch_size(batch_size) {
+        BOOST_ASSERT_MSG(batch_size > 0,
+                "[FATAL]: The mini-batch size must be > 0");
+        nseen.assign(k, 0);
+        set_thd_batch_rows();
+}
+
+// Each thread samples in proportion to the rows it owns
+void kmeans_minibatch_coordinator::set_thd_batch_rows() {
+    for (unsigned thd_id = 0; thd_id < threads.size(); thd_id++) {
+        size_t nlocal_rows = get_rid_len_tup(thd_id).second;
+        size_t batch_rows = std::max<size_t>(1,
+                (batch_size*nlocal_rows) / nrow);
+        threads[thd_id]->set_batch_rows(std::min(batch_rows, nlocal_rows));
+    }
+}
+
+/**
+  * \brief Merge the per-thread batch sums & step every center that received
+  *     members towards its batch mean.
+  * \return The largest distance any center moved.
+  */
+double kmeans_minibatch_coordinator::minibatch_update() {
+    kpmbase::clusters::ptr batch = kpmbase::clusters::create(k, ncol);
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it)
+        batch->peq((*it)->get_local_clusters());
+
+    kpmbase::kmsvector means = cltrs->get_means();
+    double max_shift = 0;
+
+    for (unsigned clust_idx = 0; clust_idx < k; clust_idx++) {
+        // Row count, or the summed row weights for weighted data
+        double nmemb = batch->get_weight(clust_idx);
+        if (nmemb <= 0)
+            continue;
+
+        nseen[clust_idx] += nmemb;
+        // (1-eta)*c + eta*(sum/nmemb) with eta = nmemb/nseen
+        double eta = nmemb / nseen[clust_idx];
+        double* mean = &means[clust_idx*ncol];
+        const double* sum = &(batch->get_means()[clust_idx*ncol]);
+        for (size_t col = 0; col < ncol; col++)
+            mean[col] += eta*((sum[col]/nmemb) - mean[col]);
+
+        max_shift = std::max(max_shift, kpmbase::eucl_dist(mean,
+                    &(cltrs->get_means()[clust_idx*ncol]), ncol));
+    }
+
+    cltrs->set_mean(means);
+    return max_shift;
+}
+
+// Assign every row to its nearest final center to get assignments & counts
+void kmeans_minibatch_coordinator::assign_all() {
+    std::fill(dist_v, dist_v+nrow, std::numeric_limits<double>::max());
+    set_prune_init(true);
+    wake4run(EM);
+    wait4complete();
+
+    std::fill(cluster_assignment_counts, cluster_assignment_counts+k, 0);
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it) {
+        kpmbase::clusters::ptr lc = (*it)->get_local_clusters();
+        for (unsigned clust_idx = 0; clust_idx < k; clust_idx++)
+            cluster_assignment_counts[clust_idx] +=
+                lc->get_num_members(clust_idx);
+    }
+}
+
+/**
+ * Main driver for mini-batch kmeans
+ */
+size_t kmeans_minibatch_coordinator::run() {
+    set_global_ptrs();
+    load_data();
+
+    struct timeval start, end;
+    gettimeofday(&start , NULL);
+    run_init(); // Initialize clusters
+
+    unsigned nsteps = max_iters;
+    if (tolerance < 0 && max_iters == std::numeric_limits<unsigned>::max()) {
+        BOOST_LOG_TRIVIAL(warning) << "[WARNING]: Mini-batch kmeans has no "
+            "stopping rule, running " << DEFAULT_MB_ITERS << " steps";
+        nsteps = DEFAULT_MB_ITERS;
+    }
+
+    unsigned iter = 1;
+    bool converged = false;
+    for (; iter <= nsteps; iter++) {
+        BOOST_LOG_TRIVIAL(info) << "Mini-batch step: " << iter;
+        wake4run(MB_EM);
+        wait4complete();
+        double max_shift = minibatch_update();
+#if KM_TEST
+        BOOST_LOG_TRIVIAL(info) << "Max center shift: " << max_shift;
+#endif
+        if (max_shift <= tolerance) {
+            converged = true;
+            break;
+        }
+    }
+    if (iter > nsteps)
+        iter = nsteps;
+
+    assign_all();
+
+    gettimeofday(&end, NULL);
+    BOOST_LOG_TRIVIAL(info) << "\n\nAlgorithmic time taken = " <<
+        kpmbase::time_diff(start, end) << " sec\n";
+
+    BOOST_LOG_TRIVIAL(info) << "\n******************************************\n";
+    if (converged) {
+        BOOST_LOG_TRIVIAL(info) <<
+            "Mini-batch k-means converged in " << iter << " steps";
+    } else {
+        BOOST_LOG_TRIVIAL(info) <<
+            "Mini-batch k-means ran " << iter << " steps";
+    }
+
+    printf("Final cluster counts: ");
+    kpmbase::print_arr(cluster_assignment_counts, k);
+    BOOST_LOG_TRIVIAL(info) << "\n******************************************\n";
+
+    return iter;
+}
+} } // End namespace kpmeans, prune
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __KPM_KMEANS_MINIBATCH_COORDINATOR_HPP__
+#define __KPM_KMEANS_MINIBATCH_COORDINATOR_HPP__
+
+#include "kmeans_task_coordinator.hpp"
+
+namespace kpmeans { namespace prune {
+
+// Rows sampled per mini-batch step summed over all threads
+constexpr size_t DEFAULT_BATCH_SIZE = 1024;
+// Steps taken when neither `max_iters' nor a tolerance is given
+constexpr unsigned DEFAULT_MB_ITERS = 100;
+
+/**
+  * \brief Mini-batch k-means (Sculley '10) on the task engine's thread pool.
+  *     Each step every thread samples rows from its NUMA-local data and
+  *     assigns them; the driver then moves each center towards the mean of
+  *     its batch members with a per-center learning rate 1/(# seen so far).
+  *     A final full assignment pass produces the cluster assignments.
+  */
+class kmeans_minibatch_coordinator : public kmeans_task_coordinator {
+private:
+    size_t batch_size;
+    std::vector<double> nseen; // Batch mass (row count or weight) absorbed
+
+    kmeans_minibatch_coordinator(const std::string fn, const size_t nrow,
+            const size_t ncol, const unsigned k, const unsigned max_iters,
+            const unsigned nnodes, const unsigned nthreads,
+            const size_t batch_size, const double* centers,
+            const kpmbase::init_type_t it, const double tolerance,
+            const kpmbase::dist_type_t dt);
+
+    void set_thd_batch_rows();
+    double minibatch_update();
+    void assign_all();
+
+protected:
+    size_t run() override;
+
+public:
+    static base_kmeans_coordinator::ptr create(
+            const std::string fn, const size_t nrow,
+            const size_t ncol, const unsigned k, const unsigned max_iters,
+            const unsigned nnodes, const unsigned nthreads,
+            const size_t batch_size=DEFAULT_BATCH_SIZE,
+            const double* centers=NULL, const std::string init="kmeanspp",
+            const double tolerance=-1, const std::string dist_type="eucl") {
+
+        kpmbase::init_type_t _init_t = kpmbase::get_init_type(init);
+        kpmbase::dist_type_t _dist_t = kpmbase::get_dist_type(dist_type);
+        // The batch & final assignment passes are euclidean only
+        if (_dist_t != kpmbase::dist_type_t::EUCL)
+            throw kpmbase::not_implemented_exception();
+
+#if KM_TEST
+        printf("kmeans minibatch coordinator => NUMA nodes: %u, nthreads: %u,"
+                " nrow: %lu, ncol: %lu, batch size: %lu, init: '%s',"
+                " dist_t: '%s', fn: '%s'\n\n", nnodes, nthreads, nrow, ncol,
+                batch_size, init.c_str(), dist_type.c_str(), fn.c_str());
+#endif
+        return base_kmeans_coordinator::ptr(
+                new kmeans_minibatch_coordinator(fn, nrow, ncol, k, max_iters,
+                    nnodes, nthreads, batch_size, centers, _init_t,
+                    tolerance, _dist_t));
+    }
+
+    const size_t get_batch_size() const { return batch_size; }
+};
+} } // End namespace kpmeans, prune
+#endif
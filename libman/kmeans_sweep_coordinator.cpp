@@ -0,0 +1,76 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/log/trivial.hpp>
+
+#include "kmeans_sweep_coordinator.hpp"
+#include "kmeans_task_thread.hpp"
+#include "kcommon.hpp"
+
+namespace kpmeans { namespace prune {
+kmeans_sweep_coordinator::kmeans_sweep_coordinator(const std::string fn,
+        const size_t nrow, const size_t ncol, const std::vector<unsigned>& ks,
+        const unsigned max_iters, const unsigned nnodes,
+        const unsigned nthreads, const kpmbase::init_type_t it,
+        const double tolerance, const kpmbase::dist_type_t dt) :
+    kmeans_task_coordinator(fn, nrow, ncol, ks[0], max_iters,
+            nnodes, nthreads, NULL, it, tolerance, dt) {
+        for (unsigned idx = 0; idx < ks.size(); idx++)
+            models.push_back(prune_model::create(ks[idx], nrow, ncol,
+                        io_opts.page_bytes));
+}
+
+/**
+ * Main driver for a sweep over k
+ */
+std::vector<kpmbase::kmeans_t> kmeans_sweep_coordinator::run_sweep() {
+    struct timeval start, end;
+    gettimeofday(&start , NULL);
+
+    run_models();
+    gettimeofday(&end, NULL);
+    BOOST_LOG_TRIVIAL(info) << "\n\nAlgorithmic time taken = " <<
+        kpmbase::time_diff(start, end) << " sec\n";
+
+    BOOST_LOG_TRIVIAL(info) << "\n******************************************\n";
+    std::vector<kpmbase::kmeans_t> ret;
+    for (unsigned idx = 0; idx < models.size(); idx++) {
+        prune_model& m = *models[idx];
+        printf("k: %u, iters: %lu, SSE: %f, BIC: %f\n", m.k, m.iters,
+                m.sse, get_bic(idx));
+
+        ret.push_back(get_model_result(idx));
+    }
+    BOOST_LOG_TRIVIAL(info) << "\n******************************************\n";
+
+    return ret;
+}
+
+kpmbase::kmeans_t kmeans_sweep_coordinator::run_kmeans() {
+    std::vector<kpmbase::kmeans_t> ret = run_sweep();
+
+    unsigned best = 0;
+    for (unsigned idx = 1; idx < models.size(); idx++) {
+        if (get_bic(idx) < get_bic(best))
+            best = idx;
+    }
+    BOOST_LOG_TRIVIAL(info) << "Lowest BIC at k = " << models[best]->k;
+    return ret[best];
+}
+} } // End namespace kpmeans, prune
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __KPM_KMEANS_SWEEP_COORDINATOR_HPP__
+#define __KPM_KMEANS_SWEEP_COORDINATOR_HPP__
+
+#include "kmeans_task_coordinator.hpp"
+
+namespace kpmeans { namespace prune {
+
+/**
+  * \brief Runs one pruned kmeans model per requested k over data that is
+  *     loaded once. Every E-step pass over a thread's NUMA-local tasks
+  *     updates all models that have not yet converged.
+  */
+class kmeans_sweep_coordinator : public kmeans_task_coordinator {
+private:
+    kmeans_sweep_coordinator(const std::string fn, const size_t nrow,
+            const size_t ncol, const std::vector<unsigned>& ks,
+            const unsigned max_iters, const unsigned nnodes,
+            const unsigned nthreads, const kpmbase::init_type_t it,
+            const double tolerance, const kpmbase::dist_type_t dt);
+
+protected:
+    // Our result is not a single model's home state
+    size_t run() override { throw kpmbase::not_implemented_exception(); }
+
+public:
+    typedef std::shared_ptr<kmeans_sweep_coordinator> ptr;
+
+    static ptr create(const std::string fn, const size_t nrow,
+            const size_t ncol, const std::vector<unsigned>& ks,
+            const unsigned max_iters, const unsigned nnodes,
+            const unsigned nthreads, const std::string init="kmeanspp",
+            const double tolerance=-1, const std::string dist_type="eucl") {
+
+        kpmbase::init_type_t _init_t = kpmbase::get_init_type(init);
+        kpmbase::dist_type_t _dist_t = kpmbase::get_dist_type(dist_type);
+        BOOST_ASSERT_MSG(!ks.empty(), "[FATAL]: A sweep needs at least one k");
+        BOOST_ASSERT_MSG(_init_t != kpmbase::init_type_t::NONE,
+                "[FATAL]: A sweep cannot use provided centers");
+
+#if KM_TEST
+        printf("kmeans sweep coordinator => NUMA nodes: %u, nthreads: %u, "
+                "nrow: %lu, ncol: %lu, nmodels: %lu, init: '%s', "
+                "dist_t: '%s', fn: '%s'\n\n", nnodes, nthreads, nrow, ncol,
+                ks.size(), init.c_str(), dist_type.c_str(), fn.c_str());
+#endif
+        return ptr(new kmeans_sweep_coordinator(fn, nrow, ncol, ks,
+                    max_iters, nnodes, nthreads, _init_t, tolerance, _dist_t));
+    }
+
+    // One result per k, in the order the k's were given
+    std::vector<kpmbase::kmeans_t> run_sweep();
+    // Runs the sweep & returns the model with the lowest BIC
+    virtual kpmbase::kmeans_t run_kmeans() override;
+
+    const double get_sse(const unsigned idx) const {
+        return models[idx]->sse;
+    }
+    const double get_bic(const unsigned idx) const {
+        return kpmbase::get_bic(models[idx]->sse, nrow, ncol, models[idx]->k);
+    }
+};
+} } // End namespace kpmeans, prune
+#endif
@@ -50,10 +50,25 @@ kmeans_task_coordinator::kmeans_task_coordinator(const std::string fn, const siz
 
         // For pruning
         recalculated_v = kpmbase::thd_safe_bool_vector::create(nrow, false);
-        dist_v = new double[nrow];
-        std::fill(dist_v, dist_v+nrow, std::numeric_limits<double>::max());
+        dist_v_mem = kpmbase::page_array<double>::create(nrow,
+                std::numeric_limits<double>::max());
+        dist_v = dist_v_mem->data();
         dm = prune::dist_matrix::create(k);
+        for (unsigned node_id = 0; node_id < nnodes; node_id++)
+            replicas.push_back(node_replica::create(node_id));
+        n_init = 1;
+        warm_nrow = 0;
+        home_ran = false;
         build_thread_state();
+
+        home_k = k;
+        home_cltrs = cltrs;
+        home_dm = dm;
+        home_recalculated_v = recalculated_v;
+        home_dist_v = dist_v;
+        home_cluster_assignments = cluster_assignments;
+        home_cluster_assignment_counts = cluster_assignment_counts;
+        place_row_arrays();
 }
 
 void kmeans_task_coordinator::build_thread_state() {
@@ -83,14 +98,86 @@ std::pair<size_t, size_t> kmeans_task_coordinator::get_rid_len_tup(
 }
 
 
+void kmeans_task_coordinator::remap_row_arrays() {
+    restore_home();
+    base_kmeans_coordinator::remap_row_arrays();
+
+    kpmbase::page_array<double>::ptr mem =
+        kpmbase::page_array<double>::create(nrow, 0, -1, io_opts.page_bytes);
+    std::copy(dist_v, dist_v+nrow, mem->data());
+    dist_v_mem = mem;
+    dist_v = mem->data();
+
+    std::shared_ptr<kpmbase::thd_safe_bool_vector> rv =
+        kpmbase::thd_safe_bool_vector::create(nrow, false, io_opts.page_bytes);
+    for (size_t row = 0; row < nrow; row++)
+        rv->set(row, recalculated_v->get(row));
+    recalculated_v = rv;
+
+    home_recalculated_v = recalculated_v;
+    home_dist_v = dist_v;
+    home_cluster_assignments = cluster_assignments;
+    set_global_ptrs();
+    place_row_arrays();
+
+    // Models that have yet to run, e.g. a sweep's, move too
+    for (unsigned idx = 0; idx < models.size(); idx++) {
+        if (models[idx]->iters)
+            continue;
+        prune_model::ptr m = prune_model::create(models[idx]->k, nrow, ncol,
+                io_opts.page_bytes);
+        m->seed = models[idx]->seed;
+        m->cltrs = models[idx]->cltrs;
+        models[idx] = m;
+    }
+}
+
+void kmeans_task_coordinator::set_thread_binding(
+        const kpmbase::bind_policy_t policy, const bool smt) {
+    base_kmeans_coordinator::set_thread_binding(policy, smt);
+
+    // Node ids are the OS's & need not be < nnodes
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it)
+        while (replicas.size() <= (*it)->get_node_id())
+            replicas.push_back(node_replica::create(replicas.size()));
+    set_global_ptrs();
+    place_row_arrays();
+}
+
+void kmeans_task_coordinator::place_row_arrays() {
+    for (unsigned thd_id = 0; thd_id < threads.size(); thd_id++) {
+        std::pair<size_t, size_t> tup = get_rid_len_tup(thd_id);
+        const int node_id = threads[thd_id]->get_node_id();
+        assignments_mem->place(tup.first, tup.first + tup.second, node_id);
+        dist_v_mem->place(tup.first, tup.first + tup.second, node_id);
+        home_recalculated_v->place(tup.first, tup.first + tup.second,
+                node_id);
+    }
+}
+
+void kmeans_task_coordinator::place_model(prune_model& m) {
+    for (unsigned node_id = m.replicas.size(); node_id < replicas.size();
+            node_id++)
+        m.replicas.push_back(node_replica::create(node_id));
+
+    for (unsigned thd_id = 0; thd_id < threads.size(); thd_id++) {
+        std::pair<size_t, size_t> tup = get_rid_len_tup(thd_id);
+        const int node_id = threads[thd_id]->get_node_id();
+        m.cluster_assignments->place(tup.first, tup.first + tup.second,
+                node_id);
+        m.dist_v->place(tup.first, tup.first + tup.second, node_id);
+        m.recalculated_v->place(tup.first, tup.first + tup.second, node_id);
+    }
+}
+
 kmeans_task_coordinator::~kmeans_task_coordinator() {
+    restore_home();
+
     thread_iter it = threads.begin();
     for (; it != threads.end(); ++it)
         (*it)->destroy_numa_mem();
 
-    delete [] cluster_assignments;
     delete [] cluster_assignment_counts;
-    delete [] dist_v;
 
     pthread_cond_destroy(&cond);
     pthread_mutex_destroy(&mutex);
@@ -106,12 +193,59 @@ void kmeans_task_coordinator::set_prune_init(const bool prune_init) {
         (*it)->set_prune_init(prune_init);
 }
 
+void kmeans_task_coordinator::set_thd_warm_nrow(const size_t warm_nrow) {
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it)
+        std::static_pointer_cast<kmeans_task_thread>(*it)->
+            set_warm_nrow(warm_nrow);
+}
+
+void kmeans_task_coordinator::set_warm_start(const kpmbase::kmeans_t& prev,
+        const std::vector<double>& bounds) {
+    if (prev.k != k || prev.ncol != ncol ||
+            prev.centroids.size() != k*ncol)
+        throw kpmbase::parameter_exception("The model is " +
+                std::to_string(prev.k) + " centers of " +
+                std::to_string(prev.ncol) + " columns. Expected " +
+                std::to_string(k) + " of " + std::to_string(ncol));
+    if (prev.nrow > nrow || prev.assignments.size() != prev.nrow)
+        throw kpmbase::parameter_exception("The model must cover a prefix of"
+                " the " + std::to_string(nrow) + " rows");
+    if (!bounds.empty() && bounds.size() != prev.nrow)
+        throw kpmbase::parameter_exception("Expected one bound per resumed"
+                " row");
+    for (unsigned clust_idx : prev.assignments)
+        if (clust_idx >= k)
+            throw kpmbase::parameter_exception("The model assigns a row to"
+                    " center " + std::to_string(clust_idx));
+
+    cltrs->set_mean(prev.centroids);
+    _init_t = kpmbase::init_type_t::NONE;
+    std::copy(prev.assignments.begin(), prev.assignments.end(),
+            cluster_assignments);
+    std::fill(dist_v, dist_v+nrow, std::numeric_limits<double>::max());
+    if (!bounds.empty())
+        std::copy(bounds.begin(), bounds.end(), dist_v);
+    warm_nrow = prev.nrow;
+    set_prune_init(true);
+    home_ran = false;
+}
+
+void kmeans_task_coordinator::get_bounds(std::vector<double>& bounds) {
+    bounds.resize(nrow);
+    // `dist_v' bounds the distance to the means of the last E-step
+    for (size_t row = 0; row < nrow; row++)
+        bounds[row] = dist_v[row] +
+            cltrs->get_prev_dist(cluster_assignments[row]);
+}
+
 void kmeans_task_coordinator::set_global_ptrs() {
     for (thread_iter it = threads.begin(); it != threads.end(); ++it) {
         pthread_mutex_lock(&mutex);
         (*it)->set_dist_v_ptr(dist_v);
         (*it)->set_recalc_v_ptr(recalculated_v);
         (*it)->set_dist_mat_ptr(dm);
+        std::static_pointer_cast<kmeans_task_thread>(*it)->set_replica(
+                replicas[(*it)->get_node_id()]);
         pthread_mutex_unlock(&mutex);
     }
 }
@@ -179,6 +313,16 @@ double kmeans_task_coordinator::reduction_on_cuml_sum() {
 }
 
 void kmeans_task_coordinator::wake4run(const thread_state_t state) {
+    // The E-step reads the centers from its node's replica
+    if (state == EM) {
+        refresh_replicas(replicas, *cltrs, *dm);
+    } else if (state == SWEEP_EM) {
+        for (unsigned idx = 0; idx < models.size(); idx++)
+            if (!models[idx]->converged)
+                refresh_replicas(models[idx]->replicas, *models[idx]->cltrs,
+                        *models[idx]->dm);
+    }
+
     pending_threads = nthreads;
     for (unsigned thd_id = 0; thd_id < threads.size(); thd_id++)
         threads[thd_id]->wake(state);
@@ -226,7 +370,7 @@ void kmeans_task_coordinator::kmeanspp_init() {
             break;
 
         for (size_t row = 0; row < nrow; row++) {
-            cuml_dist -= dist_v[row];
+            cuml_dist -= weights ? weights[row]*dist_v[row] : dist_v[row];
             if (cuml_dist <= 0) {
 #if KM_TEST
                 BOOST_LOG_TRIVIAL(info) << "Choosing "
@@ -250,14 +394,17 @@ void kmeans_task_coordinator::kmeanspp_init() {
 }
 
 void kmeans_task_coordinator::random_partition_init() {
-    std::default_random_engine generator;
+    std::default_random_engine generator(seed);
     std::uniform_int_distribution<unsigned> distribution(0, k-1);
 
     for (unsigned row = 0; row < nrow; row++) {
         unsigned asgnd_clust = distribution(generator);
         const double* dp = get_thd_data(row);
 
-        cltrs->add_member(dp, asgnd_clust);
+        if (weights)
+            cltrs->add_member(dp, asgnd_clust, weights[row]);
+        else
+            cltrs->add_member(dp, asgnd_clust);
         cluster_assignments[row] = asgnd_clust;
     }
 
@@ -270,7 +417,7 @@ void kmeans_task_coordinator::random_partition_init() {
 }
 
 void kmeans_task_coordinator::forgy_init() {
-    std::default_random_engine generator;
+    std::default_random_engine generator(seed);
     std::uniform_int_distribution<unsigned> distribution(0, nrow-1);
 
     BOOST_LOG_TRIVIAL(info) << "Forgy init start";
@@ -281,6 +428,12 @@ void kmeans_task_coordinator::forgy_init() {
     BOOST_LOG_TRIVIAL(info) << "Forgy init end";
 }
 
+void kmeans_task_coordinator::subsample_init() {
+    std::vector<double> centers;
+    sample_centers(centers);
+    cltrs->set_mean(centers);
+}
+
 void kmeans_task_coordinator::run_init() {
     switch(_init_t) {
         case kpmbase::init_type_t::RANDOM:
@@ -294,6 +447,9 @@ void kmeans_task_coordinator::run_init() {
             break;
         case kpmbase::init_type_t::NONE:
             break;
+        case kpmbase::init_type_t::SUBSAMPLE:
+            subsample_init();
+            break;
         default:
             fprintf(stderr, "[FATAL]: Unknow initialization type\n");
             exit(EXIT_FAILURE);
@@ -309,16 +465,341 @@ void const kmeans_task_coordinator::print_thread_data() {
     }
 }
 
+// Point the driver & the threads at model `m' so the inits can run on it
+void kmeans_task_coordinator::activate(prune_model::ptr m) {
+    k = m->k;
+    cltrs = m->cltrs;
+    dm = m->dm;
+    recalculated_v = m->recalculated_v;
+    dist_v = m->dist_v->data();
+    cluster_assignments = m->cluster_assignments->data();
+    cluster_assignment_counts = &m->cluster_assignment_counts[0];
+
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it) {
+        (*it)->set_g_clusters(cltrs);
+        (*it)->set_cluster_assignments_ptr(cluster_assignments);
+    }
+    set_global_ptrs();
+}
+
+void kmeans_task_coordinator::restore_home() {
+    k = home_k;
+    cltrs = home_cltrs;
+    dm = home_dm;
+    recalculated_v = home_recalculated_v;
+    dist_v = home_dist_v;
+    cluster_assignments = home_cluster_assignments;
+    cluster_assignment_counts = home_cluster_assignment_counts;
+
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it) {
+        (*it)->set_g_clusters(cltrs);
+        (*it)->set_cluster_assignments_ptr(cluster_assignments);
+    }
+    set_global_ptrs();
+}
+
 /**
- * Main driver for kmeans
+  * \brief The M-step for model `idx' from the threads' per-model updates.
+  *     Decides convergence the same way `run_kmeans' does.
+  */
+void kmeans_task_coordinator::update_model(const unsigned idx) {
+    prune_model& m = *models[idx];
+
+    if (m.prune_init) {
+        m.cltrs->clear();
+    } else {
+        m.cltrs->set_prev_means();
+        m.cltrs->unfinalize_all();
+    }
+
+    size_t nchanged = 0;
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it) {
+        std::shared_ptr<kmeans_task_thread> thd =
+            std::static_pointer_cast<kmeans_task_thread>(*it);
+        nchanged += thd->get_model_num_changed(idx);
+        m.cltrs->peq(thd->get_model_local_clusters(idx));
+    }
+
+    size_t chk_nmemb = 0;
+    for (unsigned clust_idx = 0; clust_idx < m.k; clust_idx++) {
+        m.cltrs->finalize(clust_idx);
+        m.cltrs->set_prev_dist(
+                kpmbase::eucl_dist(&(m.cltrs->get_means()[clust_idx*ncol]),
+                &(m.cltrs->get_prev_means()[clust_idx*ncol]), ncol), clust_idx);
+        m.cluster_assignment_counts[clust_idx] =
+            m.cltrs->get_num_members(clust_idx);
+        chk_nmemb += m.cluster_assignment_counts[clust_idx];
+    }
+    BOOST_VERIFY(chk_nmemb == nrow);
+
+    m.iters++;
+    if (!m.prune_init && (nchanged == 0 ||
+                (nchanged/(double)nrow) <= tolerance)) {
+        m.converged = true;
+        BOOST_LOG_TRIVIAL(info) << "Model " << idx << " (k = " << m.k <<
+            ") converged in " << m.iters << " iterations";
+    }
+    m.prune_init = false;
+
+    if (!m.converged)
+        m.dm->compute_dist(m.cltrs, ncol);
+}
+
+/**
+  * \brief The SSE of the current assignment. Unless `exact_sse' this sums
+  *     the row bounds, i.e. an upper bound on the SSE against the centers
+  *     of the last E-step, without touching the data.
+  */
+double kmeans_task_coordinator::get_sse() {
+    double sse = 0;
+    if (exact_sse) {
+#pragma omp parallel for num_threads(nthreads) reduction(+:sse)
+        for (size_t row = 0; row < nrow; row++) {
+            double dist = kpmbase::eucl_dist(get_thd_data(row),
+                    &(cltrs->get_means()[cluster_assignments[row]*ncol]),
+                    ncol);
+            sse += weights ? weights[row]*dist*dist : dist*dist;
+        }
+    } else {
+#pragma omp parallel for num_threads(nthreads) reduction(+:sse)
+        for (size_t row = 0; row < nrow; row++)
+            sse += weights ? weights[row]*dist_v[row]*dist_v[row] :
+                dist_v[row]*dist_v[row];
+    }
+    return sse;
+}
+
+// Exact SSE of every model in one pass over the data
+void kmeans_task_coordinator::compute_models_sse() {
+    std::vector<double> sse(models.size(), 0);
+
+#pragma omp parallel num_threads(nthreads)
+    {
+        std::vector<double> local_sse(models.size(), 0);
+#pragma omp for
+        for (size_t row = 0; row < nrow; row++) {
+            const double* data = get_thd_data(row);
+            for (unsigned idx = 0; idx < models.size(); idx++) {
+                prune_model& m = *models[idx];
+                double dist = kpmbase::eucl_dist(data,
+                        &(m.cltrs->get_means()
+                            [(*m.cluster_assignments)[row]*ncol]), ncol);
+                local_sse[idx] += weights ? weights[row]*dist*dist :
+                    dist*dist;
+            }
+        }
+#pragma omp critical
+        for (unsigned idx = 0; idx < models.size(); idx++)
+            sse[idx] += local_sse[idx];
+    }
+
+    for (unsigned idx = 0; idx < models.size(); idx++)
+        models[idx]->sse = sse[idx];
+}
+
+/**
+  * \brief Run every model in `models' to convergence (or `max_iters').
+  *     Each model is initialized on its own, then all share the E-step
+  *     passes so the data is streamed from memory once per iteration.
+  */
+void kmeans_task_coordinator::run_models() {
+    BOOST_ASSERT_MSG(max_iters > 0, "[FATAL]: Multiple models need "
+            "max_iters > 0");
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it)
+        std::static_pointer_cast<kmeans_task_thread>(*it)->set_models(models);
+    for (unsigned idx = 0; idx < models.size(); idx++)
+        place_model(*models[idx]);
+
+    set_global_ptrs();
+    load_data();
+
+    unsigned home_seed = seed;
+    for (unsigned idx = 0; idx < models.size(); idx++) {
+        BOOST_LOG_TRIVIAL(info) << "Initializing model " << idx <<
+            " (k = " << models[idx]->k << ")";
+        activate(models[idx]);
+        seed = models[idx]->seed;
+        run_init();
+    }
+    seed = home_seed;
+    restore_home();
+
+    for (unsigned iter = 1; iter <= max_iters; iter++) {
+        bool done = true;
+        for (unsigned idx = 0; idx < models.size(); idx++)
+            done &= models[idx]->converged;
+        if (done)
+            break;
+
+        BOOST_LOG_TRIVIAL(info) << "Shared E-step Iteration: " << iter;
+        wake4run(SWEEP_EM);
+        wait4complete();
+
+        for (unsigned idx = 0; idx < models.size(); idx++) {
+            if (!models[idx]->converged)
+                update_model(idx);
+        }
+    }
+
+    compute_models_sse();
+
+    for (unsigned idx = 0; idx < models.size(); idx++) {
+        if (!models[idx]->converged)
+            BOOST_LOG_TRIVIAL(warning) << "[Warning]: Model " << idx <<
+                " (k = " << models[idx]->k << ") failed to converge in "
+                << models[idx]->iters << " iterations";
+    }
+}
+
+kpmbase::kmeans_t kmeans_task_coordinator::get_model_result(
+        const unsigned idx) {
+    prune_model& m = *models[idx];
+    return kpmbase::kmeans_t(nrow, ncol, m.iters, m.k,
+            m.cluster_assignments->data(), &m.cluster_assignment_counts[0],
+            m.cltrs->get_means());
+}
+
+/**
+ * Driver for `n_init' restarts. Restart r seeds its init with `seed'+r.
  */
+size_t kmeans_task_coordinator::run_restarts() {
+    struct timeval start, end;
+    gettimeofday(&start , NULL);
+
+    models.clear();
+    for (unsigned r = 0; r < n_init; r++) {
+        models.push_back(prune_model::create(k, nrow, ncol,
+                    io_opts.page_bytes));
+        models.back()->seed = seed + r;
+    }
+    run_models();
+
+    unsigned best = 0;
+    for (unsigned idx = 0; idx < models.size(); idx++) {
+        BOOST_LOG_TRIVIAL(info) << "Restart " << idx << ": SSE = " <<
+            models[idx]->sse << ", iterations = " << models[idx]->iters;
+        if (models[idx]->sse < models[best]->sse)
+            best = idx;
+    }
+
+    // Leave the winner in our own state too
+    prune_model& m = *models[best];
+    std::copy(m.cluster_assignments->begin(), m.cluster_assignments->end(),
+            cluster_assignments);
+    std::copy(m.cluster_assignment_counts.begin(),
+            m.cluster_assignment_counts.end(), cluster_assignment_counts);
+    cltrs->set_mean(m.cltrs->get_means());
+
+    gettimeofday(&end, NULL);
+    BOOST_LOG_TRIVIAL(info) << "\n\nAlgorithmic time taken = " <<
+        kpmbase::time_diff(start, end) << " sec\n";
+    BOOST_LOG_TRIVIAL(info) << "\n******************************************\n";
+    BOOST_LOG_TRIVIAL(info) << "Best of " << n_init << " restarts is " <<
+        best << " with SSE = " << m.sse;
+    printf("Final cluster counts: ");
+    kpmbase::print_arr(cluster_assignment_counts, k);
+    BOOST_LOG_TRIVIAL(info) << "\n******************************************\n";
+
+    return m.iters;
+}
+
+kpmbase::kmeans_t kmeans_task_coordinator::run_kmeans(const unsigned k,
+        const std::string init, const unsigned max_iters,
+        const double tolerance, const double* centers) {
+    if (k < 2 || k > nrow)
+        throw kpmbase::parameter_exception("k must be between 2 and the " +
+                std::to_string(nrow) + " rows. It is " + std::to_string(k));
+    kpmbase::init_type_t it = kpmbase::get_init_type(init);
+    if (!centers && it == kpmbase::init_type_t::NONE)
+        throw kpmbase::parameter_exception("The `none' init needs centers");
+    if (centers && it != kpmbase::init_type_t::NONE)
+        BOOST_LOG_TRIVIAL(warning) << "[WARNING]: Both init centers" <<
+            "provided & non-NONE init method specified";
+
+    // The creation parameters stay the defaults for `run_kmeans()'
+    const kpmbase::init_type_t home_init_t = _init_t;
+    const unsigned home_max_iters = this->max_iters;
+    const double home_tolerance = this->tolerance;
+    _init_t = it;
+    this->max_iters = max_iters;
+    this->tolerance = tolerance;
+
+    struct timeval start, end;
+    gettimeofday(&start , NULL);
+
+    // Same centers => same restarts
+    const unsigned nmodels = it == kpmbase::init_type_t::NONE ? 1 : n_init;
+    models.clear();
+    for (unsigned r = 0; r < nmodels; r++) {
+        models.push_back(prune_model::create(k, nrow, ncol,
+                    io_opts.page_bytes));
+        models.back()->seed = seed + r;
+        if (centers)
+            models.back()->cltrs->set_mean(centers);
+    }
+    run_models();
+
+    unsigned best = 0;
+    for (unsigned idx = 1; idx < models.size(); idx++) {
+        if (models[idx]->sse < models[best]->sse)
+            best = idx;
+    }
+
+    _init_t = home_init_t;
+    this->max_iters = home_max_iters;
+    this->tolerance = home_tolerance;
+
+    gettimeofday(&end, NULL);
+    BOOST_LOG_TRIVIAL(info) << "\n\nAlgorithmic time taken = " <<
+        kpmbase::time_diff(start, end) << " sec\n";
+    prune_model& m = *models[best];
+    BOOST_LOG_TRIVIAL(info) << "k = " << k << ": SSE = " << m.sse <<
+        ", iterations = " << m.iters;
+
+    return get_model_result(best);
+}
+
 kpmbase::kmeans_t kmeans_task_coordinator::run_kmeans() {
+    size_t iter = run();
+    return kpmbase::kmeans_t(this->nrow, this->ncol, iter, this->k,
+            cluster_assignments, cluster_assignment_counts,
+            cltrs->get_means());
+}
+
+const std::vector<double>& kmeans_task_coordinator::get_centers() {
+    return cltrs->get_means();
+}
+
+void kmeans_task_coordinator::set_assignments_ptr(unsigned* v) {
+    home_cluster_assignments = v;
+    base_kmeans_coordinator::set_assignments_ptr(v);
+}
+
+/**
+ * Main driver for kmeans
+ */
+size_t kmeans_task_coordinator::run() {
 #ifdef PROFILER
     ProfilerStart("matrix/kmeans_task_coordinator.perf");
 #endif
+    if (n_init > 1) {
+        if (_init_t == kpmbase::init_type_t::NONE)
+            BOOST_LOG_TRIVIAL(warning) << "[WARNING]: Restarts from the same"
+                " provided centers are identical. Running once";
+        else
+            return run_restarts();
+    }
+
     set_global_ptrs();
-    wake4run(ALLOC_DATA);
-    wait4complete();
+    load_data();
+    if (home_ran) { // A repeat run starts over
+        std::fill(dist_v, dist_v+nrow, std::numeric_limits<double>::max());
+        clear_cluster_assignments();
+        set_prune_init(true);
+        warm_nrow = 0; // The resumed assignments are gone
+    }
+    home_ran = true;
+    sse_history.clear();
 
     struct timeval start, end;
     gettimeofday(&start , NULL);
@@ -334,10 +815,21 @@ kpmbase::kmeans_t kmeans_task_coordinator::run_kmeans() {
     if (max_iters > 0) {
         // Init Engine
         printf("Running init engine:\n");
+        if (warm_nrow) {
+            BOOST_LOG_TRIVIAL(info) << "Resuming " << warm_nrow << " rows. "
+                << (nrow - warm_nrow) << " new rows are fully assigned";
+            // Drift is measured from the centroids the bounds refer to
+            cltrs->set_prev_means();
+            set_thd_warm_nrow(warm_nrow);
+        }
         wake4run(EM);
         wait4complete();
         update_clusters(true);
         set_prune_init(false);
+        // Resumed once. A later run must not trust the old rows' state
+        warm_nrow = 0;
+        set_thd_warm_nrow(0);
+        sse_history.push_back(get_sse());
 
         // Run kmeans loop
         iter = 2;
@@ -363,7 +855,11 @@ kpmbase::kmeans_t kmeans_task_coordinator::run_kmeans() {
         kpmbase::print_arr(cluster_assignment_counts, k);
 #endif
 
-        if (num_changed == 0 ||
+        double max_shift = 0;
+        for (unsigned clust_idx = 0; clust_idx < k; clust_idx++)
+            max_shift = std::max(max_shift, cltrs->get_prev_dist(clust_idx));
+
+        if (check_objective(get_sse(), max_shift) || num_changed == 0 ||
                 ((num_changed/(double)nrow)) <= tolerance) {
             converged = true;
             break;
@@ -392,8 +888,6 @@ kpmbase::kmeans_t kmeans_task_coordinator::run_kmeans() {
     kpmbase::print_arr(cluster_assignment_counts, k);
     BOOST_LOG_TRIVIAL(info) << "\n******************************************\n";
 
-    return kpmbase::kmeans_t(this->nrow, this->ncol, iter, this->k,
-            cluster_assignments, cluster_assignment_counts,
-            cltrs->get_means());
+    return iter;
 }
 } } // End namespace kpmeans, prune
@@ -37,6 +37,7 @@ class task;
 }
 
 #include "dist_matrix.hpp" // FIXME: Unnecessitate this
+#include "prune_model.hpp"
 namespace kpmbase = kpmeans::base;
 namespace kpmprune = kpmeans::prune;
 
@@ -50,7 +51,40 @@ protected: // So lazy ..
     std::shared_ptr<kpmbase::prune_clusters> cltrs;
     std::shared_ptr<kpmbase::thd_safe_bool_vector> recalculated_v;
     double* dist_v; // global
+    kpmbase::page_array<double>::ptr dist_v_mem; // Backs our own `dist_v'
     std::shared_ptr<kpmprune::dist_matrix> dm;
+    // Per node copies of `cltrs' & `dm' read by the E-step. See `wake4run'
+    std::vector<node_replica::ptr> replicas;
+    unsigned n_init; // # of restarts, run interleaved in the same passes
+    size_t warm_nrow; // # of leading rows resumed from a previous model
+    bool home_ran; // `run_kmeans()' must reset the per-row state first
+
+    // Independent models sharing each E-step pass. See `run_models'
+    std::vector<prune_model::ptr> models;
+    // Our own state, restored once the models are done borrowing it
+    unsigned home_k;
+    std::shared_ptr<kpmbase::prune_clusters> home_cltrs;
+    std::shared_ptr<kpmprune::dist_matrix> home_dm;
+    std::shared_ptr<kpmbase::thd_safe_bool_vector> home_recalculated_v;
+    double* home_dist_v;
+    unsigned* home_cluster_assignments;
+    size_t* home_cluster_assignment_counts;
+
+    void activate(prune_model::ptr m);
+    void restore_home();
+    void update_model(const unsigned idx);
+    void compute_models_sse();
+    double get_sse();
+    void run_models();
+    kpmbase::kmeans_t get_model_result(const unsigned idx);
+    size_t run_restarts();
+    void remap_row_arrays() override;
+    void set_assignments_ptr(unsigned* v) override;
+    size_t run() override;
+    const std::vector<double>& get_centers() override;
+    // Put each thread's rows of the per-row arrays on the thread's node
+    void place_row_arrays();
+    void place_model(prune_model& m);
 
     kmeans_task_coordinator(const std::string fn, const size_t nrow,
             const size_t ncol, const unsigned k, const unsigned max_iters,
@@ -59,6 +93,8 @@ protected: // So lazy ..
             const double tolerance, const kpmbase::dist_type_t dt);
 
 public:
+    using base_kmeans_coordinator::run_kmeans;
+
     static base_kmeans_coordinator::ptr create(
             const std::string fn, const size_t nrow,
             const size_t ncol, const unsigned k, const unsigned max_iters,
@@ -80,6 +116,24 @@ public:
                     nnodes, nthreads, centers, _init_t, tolerance, _dist_t));
     }
 
+    /**
+      * \brief Cluster the caller's `nrow' x `ncol' row-major `data' rather
+      *     than a file. See `set_in_mem'.
+      */
+    static base_kmeans_coordinator::ptr create(const double* data,
+            const size_t nrow, const size_t ncol, const unsigned k,
+            const unsigned max_iters, const unsigned nnodes,
+            const unsigned nthreads,
+            const kpmbase::buffer_use_t use=kpmbase::buffer_use_t::IN_PLACE,
+            const double* centers=NULL, const std::string init="kmeanspp",
+            const double tolerance=-1, const std::string dist_type="eucl") {
+        base_kmeans_coordinator::ptr kc = create("", nrow, ncol, k,
+                max_iters, nnodes, nthreads, centers, init, tolerance,
+                dist_type);
+        kc->set_in_mem(data, use);
+        return kc;
+    }
+
     std::shared_ptr<kpmbase::prune_clusters> get_gcltrs() {
         return cltrs;
     }
@@ -88,6 +142,30 @@ public:
         return dm;
     }
 
+    // Run `n_init' restarts & keep the one with the lowest SSE
+    void set_n_init(const unsigned n_init) {
+        BOOST_ASSERT_MSG(n_init > 0, "[FATAL]: n_init must be > 0");
+        this->n_init = n_init;
+    }
+
+    const std::vector<prune_model::ptr>& get_models() const { return models; }
+
+    /**
+      * \brief Resume from a model computed on the first `prev.nrow' rows of
+      *     this (grown) data. Those rows keep their centroid & bound for the
+      *     init pass, which only scans every center for the new rows. Old
+      *     bounds are then loosened by each centroid's drift as usual.
+      * \param bounds Per-row bounds from `get_bounds'. If empty, the
+      *     distance of each old row to its centroid is computed instead.
+      */
+    void set_warm_start(const kpmbase::kmeans_t& prev,
+            const std::vector<double>& bounds);
+    /**
+      * \brief Upper bound on the distance of each row to its final centroid,
+      *     to store with the model for a later `set_warm_start'.
+      */
+    void get_bounds(std::vector<double>& bounds);
+
     std::pair<size_t, size_t> get_rid_len_tup(const unsigned thd_id);
     // Pass file handle to threads to read & numa alloc
     void create_thread_map();
@@ -97,13 +175,28 @@ public:
     void set_thread_clust_idx(const unsigned clust_idx);
     double reduction_on_cuml_sum();
     void set_thd_dist_v_ptr(double* v);
+    void set_thd_warm_nrow(const size_t warm_nrow);
     void run_init();
     void set_global_ptrs();
 
     virtual void kmeanspp_init();
     virtual void random_partition_init();
     virtual void forgy_init();
+    virtual void subsample_init();
     virtual kpmbase::kmeans_t run_kmeans() override;
+    /**
+      * \brief Run again on the data already in memory with another k, init
+      *     & stopping rule, e.g. for a parameter sweep or interactive use.
+      *     The threads & their NUMA-local rows live as long as the
+      *     coordinator, so only the first run pays for the load. Each call
+      *     starts from scratch & honors `set_n_init', `set_seed' etc.
+      * \param centers `k' x ncol initial centers for the `none' init.
+      */
+    kpmbase::kmeans_t run_kmeans(const unsigned k,
+            const std::string init="kmeanspp", const unsigned max_iters=100,
+            const double tolerance=-1, const double* centers=NULL);
+    void set_thread_binding(const kpmbase::bind_policy_t policy,
+            const bool smt=false) override;
 
     const double* get_thd_data(const unsigned row_id) const;
 
@@ -40,7 +40,13 @@ kmeans_task_thread::kmeans_task_thread(const int node_id, const unsigned thd_id,
             tasks->set_nrow(nlocal_rows);
             tasks->set_ncol(ncol);
             prune_init = true;
+            warm_nrow = 0;
             _is_numa = false; // TODO: param this
+            batch_rows = 0;
+            split_parents = NULL;
+            split_asgns = NULL;
+            split_num_changed = 0;
+            mb_generator.seed(thd_id + 1);
             local_clusters =
                 kpmbase::clusters::create(g_clusters->get_nclust(), ncol);
 
@@ -220,6 +226,18 @@ void kmeans_task_thread::run() {
             EM_step();
             request_task();
             break;
+        case SWEEP_EM:
+            sweep_EM_step();
+            request_task();
+            break;
+        case SPLIT_EM:
+            split_EM_step();
+            request_task();
+            break;
+        case MB_EM: /* No tasks, rows are sampled from local_data */
+            minibatch_step();
+            lock_sleep();
+            break;
         case EXIT:
             fprintf(stderr, "[FATAL]: Thread state is EXIT but running!\n");
             exit(EXIT_FAILURE);
@@ -251,7 +269,9 @@ void kmeans_task_thread::wake(thread_state_t state) {
     set_thread_state(state);
 
     if (state == thread_state_t::EM ||
-            state == thread_state_t::KMSPP_INIT) {
+            state == thread_state_t::KMSPP_INIT ||
+            state == thread_state_t::SWEEP_EM ||
+            state == thread_state_t::SPLIT_EM) {
         // Threads only sleep if they AND all other threads have no tasks
         tasks->reset(); // NOTE: Only place this is reset
         curr_task = tasks->get_task();
@@ -263,9 +283,24 @@ void kmeans_task_thread::wake(thread_state_t state) {
         if (state == thread_state_t::KMSPP_INIT)
             cuml_dist = 0;
 
+        if (state == thread_state_t::SWEEP_EM) {
+            for (unsigned idx = 0; idx < models.size(); idx++) {
+                model_local_clusters[idx]->clear();
+                model_num_changed[idx].val = 0;
+            }
+        }
+
+        if (state == thread_state_t::SPLIT_EM) {
+            split_local_clusters->clear();
+            std::fill(split_sse.begin(), split_sse.end(), 0);
+            split_num_changed = 0;
+        }
+
         local_clusters->clear();
 
         //printf("wake: Thd: %u, Task ==> ", get_thd_id()); curr_task.print();
+    } else if (state == thread_state_t::MB_EM) {
+        local_clusters->clear();
     }
 
     rc = pthread_mutex_unlock(&mutex);
@@ -281,6 +316,7 @@ void* callback(void* arg) {
     while (true) { // So we can receive task after task
         if (t->get_state() == WAIT)
             t->wait();
+        t->bind_if_moved();
 
         if (t->get_state() == EXIT) {// No more work to do
             //printf("Thread %d exiting ...\n", t->thd_id);
@@ -310,87 +346,238 @@ get_global_data_id(const unsigned row_id) const {
     return row_id + curr_task->get_start_rid();
 }
 
-void kmeans_task_thread::EM_step() {
-    for (unsigned row = 0; row < curr_task->get_nrow(); row++) {
-        unsigned true_row_id = get_global_data_id(row);
-        unsigned old_clust = cluster_assignments[true_row_id];
+/**
+  * \brief The pruned E-step for one row against one set of clusters. Updates
+  *     the row's assignment & bound & records any change in `local_clusters'.
+  */
+void kmeans_task_thread::estep_row(const double* row,
+        const unsigned true_row_id, const node_replica& cl,
+        double* dist_v, kpmbase::thd_safe_bool_vector& recalculated_v,
+        unsigned* cluster_assignments,
+        const bool prune_init, kpmbase::clusters& local_clusters,
+        unsigned& num_changed) {
+    unsigned old_clust = cluster_assignments[true_row_id];
+
+    if (prune_init && true_row_id < warm_nrow) {
+        // Resumed: keep the row's centroid. Without a stored bound only the
+        //  distance to it is computed
+        if (dist_v[true_row_id] == std::numeric_limits<double>::max())
+            dist_v[true_row_id] = kpmbase::dist_comp_raw<double>(row,
+                    &(cl.get_means()[old_clust*ncol]), ncol,
+                    kpmbase::dist_type_t::EUCL);
+    } else if (prune_init) {
+        double dist = std::numeric_limits<double>::max();
+
+        for (unsigned clust_idx = 0;
+                clust_idx < cl.get_nclust(); clust_idx++) {
+            dist = kpmbase::dist_comp_raw<double>(row,
+                    &(cl.get_means()[clust_idx*ncol]), ncol,
+                    kpmbase::dist_type_t::EUCL);
+
+            if (dist < dist_v[true_row_id]) {
+                dist_v[true_row_id] = dist;
+                cluster_assignments[true_row_id] = clust_idx;
+            }
+        }
 
-        if (prune_init) {
-            double dist = std::numeric_limits<double>::max();
+    } else {
+        recalculated_v.set(true_row_id, false);
+        dist_v[true_row_id] +=
+            cl.get_prev_dist(cluster_assignments[true_row_id]);
 
+        if (dist_v[true_row_id] <=
+                cl.get_s_val(cluster_assignments[true_row_id])) {
+            // Skip all rows
+        } else {
             for (unsigned clust_idx = 0;
-                    clust_idx < g_clusters->get_nclust(); clust_idx++) {
-                dist = kpmbase::dist_comp_raw<double>(
-                        &curr_task->get_data_ptr()[row*ncol],
-                        &(g_clusters->get_means()[clust_idx*ncol]), ncol,
-                        kpmbase::dist_type_t::EUCL);
+                    clust_idx < cl.get_nclust(); clust_idx++) {
 
-                if (dist < dist_v[true_row_id]) {
-                    dist_v[true_row_id] = dist;
-                    cluster_assignments[true_row_id] = clust_idx;
+                if (dist_v[true_row_id] <= cl.get_dist(cluster_assignments
+                            [true_row_id], clust_idx)) {
+                    // Skip this cluster
+                    continue;
                 }
-            }
 
-        } else {
-            recalculated_v->set(true_row_id, false);
-            dist_v[true_row_id] +=
-                g_clusters->get_prev_dist(cluster_assignments[true_row_id]);
-
-            if (dist_v[true_row_id] <=
-                    g_clusters->get_s_val(cluster_assignments[true_row_id])) {
-                // Skip all rows
-            } else {
-                for (unsigned clust_idx = 0;
-                        clust_idx < g_clusters->get_nclust(); clust_idx++) {
-
-                    if (dist_v[true_row_id] <= dm->get(cluster_assignments
-                                [true_row_id], clust_idx)) {
-                        // Skip this cluster
-                        continue;
-                    }
-
-                    if (!recalculated_v->get(true_row_id)) {
-                        dist_v[true_row_id] = kpmbase::dist_comp_raw<double>(
-                                &curr_task->get_data_ptr()[row*ncol],
-                                &(g_clusters->get_means()[cluster_assignments
-                                    [true_row_id]*ncol]), ncol,
-                                kpmbase::dist_type_t::EUCL);
-                        recalculated_v->set(true_row_id, true);
-                    }
-
-                    if (dist_v[true_row_id] <=
-                            dm->get(cluster_assignments[true_row_id], clust_idx)) {
-                        // Skip this cluster
-                        continue;
-                    }
-
-                    // Track 5
-                    double jdist = kpmbase::dist_comp_raw(
-                            &curr_task->get_data_ptr()[row*ncol],
-                            &(g_clusters->get_means()[clust_idx*ncol]), ncol,
+                if (!recalculated_v.get(true_row_id)) {
+                    dist_v[true_row_id] = kpmbase::dist_comp_raw<double>(row,
+                            &(cl.get_means()[cluster_assignments
+                                [true_row_id]*ncol]), ncol,
                             kpmbase::dist_type_t::EUCL);
+                    recalculated_v.set(true_row_id, true);
+                }
 
-                    if (jdist < dist_v[true_row_id]) {
-                        dist_v[true_row_id] = jdist;
-                        cluster_assignments[true_row_id] = clust_idx;
-                    }
-                } // endfor
-            }
+                if (dist_v[true_row_id] <=
+                        cl.get_dist(cluster_assignments[true_row_id],
+                            clust_idx)) {
+                    // Skip this cluster
+                    continue;
+                }
+
+                // Track 5
+                double jdist = kpmbase::dist_comp_raw(row,
+                        &(cl.get_means()[clust_idx*ncol]), ncol,
+                        kpmbase::dist_type_t::EUCL);
+
+                if (jdist < dist_v[true_row_id]) {
+                    dist_v[true_row_id] = jdist;
+                    cluster_assignments[true_row_id] = clust_idx;
+                }
+            } // endfor
         }
+    }
 
-        BOOST_VERIFY(cluster_assignments[true_row_id] >= 0 &&
-                cluster_assignments[true_row_id] < g_clusters->get_nclust());
-
-        if (prune_init) {
-            meta.num_changed++;
-            local_clusters->add_member(&(curr_task->get_data_ptr()[row*ncol]),
-                    cluster_assignments[true_row_id]);
-        } else if (old_clust != cluster_assignments[true_row_id]) {
-            meta.num_changed++;
-            local_clusters->swap_membership(
-                    &(curr_task->get_data_ptr()[row*ncol]),
+    BOOST_VERIFY(cluster_assignments[true_row_id] >= 0 &&
+            cluster_assignments[true_row_id] < cl.get_nclust());
+
+    if (prune_init) {
+        num_changed++;
+        if (weights)
+            local_clusters.add_member(row, cluster_assignments[true_row_id],
+                    weights[true_row_id]);
+        else
+            local_clusters.add_member(row, cluster_assignments[true_row_id]);
+    } else if (old_clust != cluster_assignments[true_row_id]) {
+        num_changed++;
+        if (weights)
+            local_clusters.swap_membership(row, old_clust,
+                    cluster_assignments[true_row_id], weights[true_row_id]);
+        else
+            local_clusters.swap_membership(row,
                     old_clust, cluster_assignments[true_row_id]);
+    }
+}
+
+void kmeans_task_thread::EM_step() {
+    for (unsigned row = 0; row < curr_task->get_nrow(); row++) {
+        estep_row(&curr_task->get_data_ptr()[row*ncol],
+                get_global_data_id(row), *replica, dist_v,
+                *recalculated_v, cluster_assignments, prune_init,
+                *local_clusters, meta.num_changed);
+    }
+}
+
+/**
+  * \brief Row-major over the task & model-major within a row so each row is
+  *     brought into cache once for every model still running.
+  */
+void kmeans_task_thread::sweep_EM_step() {
+    for (unsigned row = 0; row < curr_task->get_nrow(); row++) {
+        const double* data = &curr_task->get_data_ptr()[row*ncol];
+        unsigned true_row_id = get_global_data_id(row);
+
+        for (unsigned idx = 0; idx < models.size(); idx++) {
+            prune_model& m = *models[idx];
+            if (m.converged)
+                continue;
+
+            estep_row(data, true_row_id, *m.replicas[node_id],
+                    m.dist_v->data(), *m.recalculated_v,
+                    m.cluster_assignments->data(),
+                    m.prune_init, *model_local_clusters[idx],
+                    model_num_changed[idx].val);
+        }
+    }
+}
+
+/**
+  * \brief Each row is only compared to the 2 children of its center, so a
+  *     pass tests every candidate split at once for 2 distances per row.
+  */
+void kmeans_task_thread::split_EM_step() {
+    const kpmbase::kmsvector& means = split_cltrs->get_means();
+
+    for (unsigned row = 0; row < curr_task->get_nrow(); row++) {
+        const double* data = &curr_task->get_data_ptr()[row*ncol];
+        unsigned true_row_id = get_global_data_id(row);
+        unsigned child = 2*split_parents[true_row_id];
+
+        double dist = kpmbase::dist_comp_raw<double>(data,
+                &means[child*ncol], ncol, kpmbase::dist_type_t::EUCL);
+        double sib_dist = kpmbase::dist_comp_raw<double>(data,
+                &means[(child+1)*ncol], ncol, kpmbase::dist_type_t::EUCL);
+        if (sib_dist < dist) {
+            dist = sib_dist;
+            child++;
+        }
+
+        if (split_asgns[true_row_id] != child) {
+            split_asgns[true_row_id] = child;
+            split_num_changed++;
+        }
+
+        if (weights) {
+            split_local_clusters->add_member(data, child,
+                    weights[true_row_id]);
+            split_sse[child] += weights[true_row_id]*dist*dist;
+        } else {
+            split_local_clusters->add_member(data, child);
+            split_sse[child] += dist*dist;
+        }
+    }
+}
+
+void kmeans_task_thread::set_g_clusters(
+        std::shared_ptr<kpmbase::prune_clusters> g_clusters) {
+    if (g_clusters->get_nclust() != this->g_clusters->get_nclust())
+        local_clusters =
+            kpmbase::clusters::create(g_clusters->get_nclust(), ncol);
+    this->g_clusters = g_clusters;
+}
+
+void kmeans_task_thread::set_models(const std::vector<prune_model::ptr>&
+        models) {
+    this->models = models;
+    model_local_clusters.clear();
+    for (unsigned idx = 0; idx < models.size(); idx++)
+        model_local_clusters.push_back(
+                kpmbase::clusters::create(models[idx]->k, ncol));
+    model_num_changed.assign(models.size(), kpmbase::padded<unsigned>());
+}
+
+void kmeans_task_thread::set_split(
+        std::shared_ptr<kpmbase::clusters> split_cltrs,
+        const unsigned* split_parents, unsigned* split_asgns) {
+    this->split_cltrs = split_cltrs;
+    this->split_parents = split_parents;
+    this->split_asgns = split_asgns;
+    split_local_clusters =
+        kpmbase::clusters::create(split_cltrs->get_nclust(), ncol);
+    split_sse.assign(split_cltrs->get_nclust(), 0);
+}
+
+/**
+  * \brief Sample `batch_rows' rows (with replacement) from this thread's
+  *     NUMA-local data, assign each to its nearest center & accumulate it in
+  *     `local_clusters'. The coordinator applies the per-center updates.
+  */
+void kmeans_task_thread::minibatch_step() {
+    const size_t nlocal_rows = tasks->get_nrow();
+    if (!nlocal_rows)
+        return;
+    std::uniform_int_distribution<size_t> distribution(0, nlocal_rows-1);
+
+    for (size_t i = 0; i < batch_rows; i++) {
+        const size_t local_rid = distribution(mb_generator);
+        const double* row = &local_data[local_rid*ncol];
+        unsigned asgnd_clust = kpmbase::INVALID_CLUSTER_ID;
+        double best = std::numeric_limits<double>::max();
+
+        for (unsigned clust_idx = 0;
+                clust_idx < g_clusters->get_nclust(); clust_idx++) {
+            double dist = kpmbase::dist_comp_raw<double>(row,
+                    &(g_clusters->get_means()[clust_idx*ncol]), ncol,
+                    kpmbase::dist_type_t::EUCL);
+            if (dist < best) {
+                best = dist;
+                asgnd_clust = clust_idx;
+            }
         }
+        BOOST_VERIFY(asgnd_clust != kpmbase::INVALID_CLUSTER_ID);
+        if (weights)
+            local_clusters->add_member(row, asgnd_clust,
+                    weights[tasks->get_start_rid()+local_rid]);
+        else
+            local_clusters->add_member(row, asgnd_clust);
     }
 }
 
@@ -412,7 +599,8 @@ void kmeans_task_thread::kmspp_dist() {
             cluster_assignments[true_row_id] = clust_idx;
         }
 
-        cuml_dist += dist_v[true_row_id];
+        cuml_dist += weights ? weights[true_row_id]*dist_v[true_row_id] :
+            dist_v[true_row_id];
     }
 }
 
@@ -21,8 +21,10 @@
 #define __KPM_KMEANS_TASK_THREAD_HPP__
 
 #include <atomic>
+#include <random>
 
 #include "base_kmeans_thread.hpp"
+#include "prune_model.hpp"
 
 namespace kpmeans {
 class task_queue;
@@ -50,10 +52,38 @@ protected: // Lazy
     kpmeans::task* curr_task;
 
     bool prune_init;
+    // Rows below this id keep the assignment & bound they were given when
+    //  the init pass runs. See `kmeans_task_coordinator::set_warm_start'
+    size_t warm_nrow;
     std::shared_ptr<dist_matrix> dm; // global
+    node_replica::ptr replica; // Our node's copy of `g_clusters' & `dm'
     std::shared_ptr<kpmbase::thd_safe_bool_vector> recalculated_v; // global
     bool _is_numa;
 
+    // Mini-batch
+    size_t batch_rows; // # of local rows sampled per mini-batch step
+    std::default_random_engine mb_generator;
+
+    // Sweep: models sharing each E-step pass & their per-thread updates
+    std::vector<prune_model::ptr> models;
+    std::vector<std::shared_ptr<kpmbase::clusters> > model_local_clusters;
+    std::vector<kpmbase::padded<unsigned> > model_num_changed;
+
+    // X-means: rows pick between the 2 children (2c, 2c+1) of their center c
+    std::shared_ptr<kpmbase::clusters> split_cltrs; // global
+    const unsigned* split_parents; // global. The row's center
+    unsigned* split_asgns; // global. The row's child
+    std::shared_ptr<kpmbase::clusters> split_local_clusters;
+    std::vector<double> split_sse; // Per child
+    alignas(kpmbase::CACHE_LINE_SIZE) unsigned split_num_changed;
+
+    void estep_row(const double* row, const unsigned true_row_id,
+            const node_replica& cl, double* dist_v,
+            kpmbase::thd_safe_bool_vector& recalculated_v,
+            unsigned* cluster_assignments,
+            const bool prune_init, kpmbase::clusters& local_clusters,
+            unsigned& num_changed);
+
     kmeans_task_thread(const int node_id, const unsigned thd_id,
             const unsigned start_rid, const unsigned nlocal_rows,
             const unsigned ncol,
@@ -76,6 +106,9 @@ public:
     void start(const kpmeans::thread_state_t state);
     // Allocate and move data using this thread
     void EM_step();
+    void minibatch_step();
+    void sweep_EM_step();
+    void split_EM_step();
     void kmspp_dist();
     const unsigned get_global_data_id(const unsigned row_id) const;
     void run();
@@ -112,6 +145,43 @@ public:
         return prune_init;
     }
 
+    void set_warm_nrow(const size_t warm_nrow) {
+        this->warm_nrow = warm_nrow;
+    }
+
+    void set_batch_rows(const size_t batch_rows) {
+        this->batch_rows = batch_rows;
+    }
+
+    // Swap in another set of clusters, possibly with a different k
+    void set_g_clusters(std::shared_ptr<kpmbase::prune_clusters> g_clusters);
+
+    void set_models(const std::vector<prune_model::ptr>& models);
+
+    void set_split(std::shared_ptr<kpmbase::clusters> split_cltrs,
+            const unsigned* split_parents, unsigned* split_asgns);
+
+    const std::shared_ptr<kpmbase::clusters> get_split_local_clusters() const {
+        return split_local_clusters;
+    }
+
+    const std::vector<double>& get_split_sse() const {
+        return split_sse;
+    }
+
+    const unsigned get_split_num_changed() const {
+        return split_num_changed;
+    }
+
+    const std::shared_ptr<kpmbase::clusters>
+        get_model_local_clusters(const unsigned idx) const {
+        return model_local_clusters[idx];
+    }
+
+    const unsigned get_model_num_changed(const unsigned idx) const {
+        return model_num_changed[idx].val;
+    }
+
     void set_recalc_v_ptr(std::shared_ptr<kpmbase::thd_safe_bool_vector>
             recalculated_v) {
         this->recalculated_v = recalculated_v;
@@ -121,6 +191,10 @@ public:
         this->dm = dm;
     }
 
+    void set_replica(node_replica::ptr replica) {
+        this->replica = replica;
+    }
+
     kpmeans::task_queue* get_task_queue() {
       return tasks;
     }
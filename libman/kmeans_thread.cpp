@@ -25,6 +25,7 @@
 #include "util.hpp"
 #include "io.hpp"
 #include "clusters.hpp"
+#include "kd_tree.hpp"
 
 namespace kpmeans {
 kmeans_thread::kmeans_thread(const int node_id, const unsigned thd_id,
@@ -35,6 +36,7 @@ kmeans_thread::kmeans_thread(const int node_id, const unsigned thd_id,
             g_clusters->get_nclust(), cluster_assignments, start_rid, fn) {
 
             this->nprocrows = nprocrows;
+            this->max_checks = 0;
             this->g_clusters = g_clusters;
             local_clusters =
                 kpmbase::clusters::create(g_clusters->get_nclust(), ncol);
@@ -122,6 +124,7 @@ void* callback(void* arg) {
     while (true) { // So we can receive task after task
         if (t->get_state() == WAIT)
             t->wait();
+        t->bind_if_moved();
 
         if (t->get_state() == EXIT) {// No more work to do
             //printf("Thread %d exiting ...\n", t->thd_id);
@@ -150,35 +153,60 @@ get_global_data_id(const unsigned row_id) const {
     return start_rid+row_id;
 }
 
+// `local_clusters' gets the change this step makes to the cluster sums:
+//  rows without a cluster yet are added & only rows that moved are swapped
 void kmeans_thread::EM_step() {
     meta.num_changed = 0; // Always reset at the beginning of an EM-step
     local_clusters->clear();
+    cuml_dist = 0; // The E-step's share of the SSE
 
     for (unsigned row = 0; row < nprocrows; row++) {
         unsigned asgnd_clust = kpmbase::INVALID_CLUSTER_ID;
         double best, dist;
         dist = best = std::numeric_limits<double>::max();
 
-        for (unsigned clust_idx = 0;
-                clust_idx < g_clusters->get_nclust(); clust_idx++) {
-            dist = kpmbase::dist_comp_raw<double>(&local_data[row*ncol],
-                    &(g_clusters->get_means()[clust_idx*ncol]), ncol,
-                    kpmbase::dist_type_t::EUCL);
-
-            if (dist < best) {
-                best = dist;
-                asgnd_clust = clust_idx;
+        if (cindex) {
+            asgnd_clust = cindex->nearest(&local_data[row*ncol], best,
+                    max_checks);
+        } else {
+            for (unsigned clust_idx = 0;
+                    clust_idx < g_clusters->get_nclust(); clust_idx++) {
+                dist = kpmbase::dist_comp_raw<double>(&local_data[row*ncol],
+                        &(g_clusters->get_means()[clust_idx*ncol]), ncol,
+                        kpmbase::dist_type_t::EUCL);
+
+                if (dist < best) {
+                    best = dist;
+                    asgnd_clust = clust_idx;
+                }
             }
         }
 
         BOOST_VERIFY(asgnd_clust != kpmbase::INVALID_CLUSTER_ID);
         unsigned true_row_id = get_global_data_id(row);
-
-        if (asgnd_clust != cluster_assignments[true_row_id])
-            meta.num_changed++;
-
+        const unsigned old_clust = cluster_assignments[true_row_id];
         cluster_assignments[true_row_id] = asgnd_clust;
-        local_clusters->add_member(&local_data[row*ncol], asgnd_clust);
+        cuml_dist += weights ? weights[true_row_id]*best*best : best*best;
+
+        if (asgnd_clust == old_clust)
+            continue;
+        meta.num_changed++;
+
+        if (old_clust == kpmbase::INVALID_CLUSTER_ID) {
+            if (weights)
+                local_clusters->add_member(&local_data[row*ncol],
+                        asgnd_clust, weights[true_row_id]);
+            else
+                local_clusters->add_member(&local_data[row*ncol],
+                        asgnd_clust);
+        } else {
+            if (weights)
+                local_clusters->swap_membership(&local_data[row*ncol],
+                        old_clust, asgnd_clust, weights[true_row_id]);
+            else
+                local_clusters->swap_membership(&local_data[row*ncol],
+                        old_clust, asgnd_clust);
+        }
     }
 }
 
@@ -198,7 +226,8 @@ void kmeans_thread::kmspp_dist() {
             dist_v[true_row_id] = dist;
             cluster_assignments[true_row_id] = clust_idx;
         }
-        cuml_dist += dist_v[true_row_id];
+        cuml_dist += weights ? weights[true_row_id]*dist_v[true_row_id] :
+            dist_v[true_row_id];
     }
 }
 
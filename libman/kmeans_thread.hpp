@@ -24,6 +24,7 @@
 
 namespace kpmeans { namespace base {
     class clusters;
+    class kd_tree;
 } }
 namespace kpmbase = kpmeans::base;
 
@@ -34,6 +35,9 @@ class kmeans_thread : public base_kmeans_thread {
          // Pointer to global cluster data
         std::shared_ptr<kpmbase::clusters> g_clusters;
         unsigned nprocrows; // How many rows to process
+        // Queried instead of scanning the centers when set
+        std::shared_ptr<kpmbase::kd_tree> cindex;
+        size_t max_checks;
 
         kmeans_thread(const int node_id, const unsigned thd_id,
                 const unsigned start_rid, const unsigned nprocrows,
@@ -64,6 +68,11 @@ class kmeans_thread : public base_kmeans_thread {
         void sleep();
         void wake(thread_state_t state);
         const void print_local_data() const;
+        void set_centroid_index(std::shared_ptr<kpmbase::kd_tree> cindex,
+                const size_t max_checks) override {
+            this->cindex = cindex;
+            this->max_checks = max_checks;
+        }
 };
 }
 #endif
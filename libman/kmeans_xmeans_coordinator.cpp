@@ -0,0 +1,225 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <boost/log/trivial.hpp>
+
+#include <algorithm>
+#include <random>
+
+#include "kmeans_xmeans_coordinator.hpp"
+#include "kmeans_task_thread.hpp"
+#include "kcommon.hpp"
+
+namespace kpmeans { namespace prune {
+kmeans_xmeans_coordinator::kmeans_xmeans_coordinator(const std::string fn,
+        const size_t nrow, const size_t ncol, const unsigned k,
+        const unsigned k_max, const unsigned max_iters, const unsigned nnodes,
+        const unsigned nthreads, const kpmbase::init_type_t it,
+        const double tolerance, const kpmbase::dist_type_t dt) :
+    kmeans_task_coordinator(fn, nrow, ncol, k, max_iters,
+            nnodes, nthreads, NULL, it, tolerance, dt) {
+        this->k_max = k_max;
+}
+
+// Exact SSE of each of the model's clusters
+void kmeans_xmeans_coordinator::get_cluster_sse(const prune_model& m,
+        std::vector<double>& sse) {
+    sse.assign(m.k, 0);
+
+#pragma omp parallel num_threads(nthreads)
+    {
+        std::vector<double> local_sse(m.k, 0);
+#pragma omp for
+        for (size_t row = 0; row < nrow; row++) {
+            unsigned clust_idx = (*m.cluster_assignments)[row];
+            double dist = kpmbase::eucl_dist(get_thd_data(row),
+                    &(m.cltrs->get_means()[clust_idx*ncol]), ncol);
+            local_sse[clust_idx] += weights ? weights[row]*dist*dist :
+                dist*dist;
+        }
+#pragma omp critical
+        for (unsigned clust_idx = 0; clust_idx < m.k; clust_idx++)
+            sse[clust_idx] += local_sse[clust_idx];
+    }
+}
+
+/**
+  * \brief Run a 2-means on the members of every center of `m' at once &
+  *     keep the splits that raise the local BIC the most, up to `k_max'.
+  * \param centers The centers to resume from: the model's, with each split
+  *     center replaced by its first child & its second child appended.
+  * \return The number of centers split.
+  */
+unsigned kmeans_xmeans_coordinator::split_round(const prune_model& m,
+        std::vector<double>& centers) {
+    std::vector<double> parent_sse;
+    get_cluster_sse(m, parent_sse);
+
+    // Seed the children of c a member's RMS distance either side of c in a
+    //  random direction
+    std::default_random_engine generator(seed + k_history.size());
+    std::normal_distribution<double> distribution(0, 1);
+    const kpmbase::kmsvector& means = m.cltrs->get_means();
+    kpmbase::kmsvector split_means(2*m.k*ncol);
+    std::vector<double> dir(ncol);
+
+    for (unsigned clust_idx = 0; clust_idx < m.k; clust_idx++) {
+        double norm = 0;
+        for (size_t col = 0; col < ncol; col++) {
+            dir[col] = distribution(generator);
+            norm += dir[col]*dir[col];
+        }
+        double weight = m.cltrs->get_weight(clust_idx);
+        double scale = (weight > 0 && norm > 0) ?
+            sqrt(parent_sse[clust_idx] / weight) / sqrt(norm) : 0;
+
+        for (size_t col = 0; col < ncol; col++) {
+            double mean = means[clust_idx*ncol+col];
+            split_means[2*clust_idx*ncol+col] = mean - scale*dir[col];
+            split_means[(2*clust_idx+1)*ncol+col] = mean + scale*dir[col];
+        }
+    }
+
+    kpmbase::clusters::ptr split_cltrs =
+        kpmbase::clusters::create(2*m.k, ncol);
+    split_cltrs->set_mean(split_means);
+    std::vector<unsigned> split_asgns(nrow, kpmbase::INVALID_CLUSTER_ID);
+    for (thread_iter it = threads.begin(); it != threads.end(); ++it)
+        std::static_pointer_cast<kmeans_task_thread>(*it)->set_split(
+                split_cltrs, m.cluster_assignments->data(), &split_asgns[0]);
+
+    std::vector<double> child_sse(2*m.k);
+    for (unsigned iter = 1; iter <= max_iters; iter++) {
+        wake4run(SPLIT_EM);
+        wait4complete();
+
+        kpmbase::kmsvector prev_means = split_cltrs->get_means();
+        split_cltrs->clear();
+        std::fill(child_sse.begin(), child_sse.end(), 0);
+        size_t nchanged = 0;
+
+        for (thread_iter it = threads.begin(); it != threads.end(); ++it) {
+            std::shared_ptr<kmeans_task_thread> thd =
+                std::static_pointer_cast<kmeans_task_thread>(*it);
+            nchanged += thd->get_split_num_changed();
+            split_cltrs->peq(thd->get_split_local_clusters());
+            for (unsigned child = 0; child < 2*m.k; child++)
+                child_sse[child] += thd->get_split_sse()[child];
+        }
+
+        for (unsigned child = 0; child < 2*m.k; child++) {
+            if (split_cltrs->get_num_members(child))
+                split_cltrs->finalize(child);
+            else // An empty child stays put
+                split_cltrs->set_mean(&prev_means[child*ncol], child);
+        }
+
+        if (nchanged == 0 || (nchanged/(double)nrow) <= tolerance)
+            break;
+    }
+
+    // <BIC gain, center>
+    std::vector<std::pair<double, unsigned> > gains;
+    for (unsigned clust_idx = 0; clust_idx < m.k; clust_idx++) {
+        if (!split_cltrs->get_num_members(2*clust_idx) ||
+                !split_cltrs->get_num_members(2*clust_idx+1))
+            continue;
+        // Weight totals, to match the weighted SSEs
+        std::vector<double> sizes {split_cltrs->get_weight(2*clust_idx),
+            split_cltrs->get_weight(2*clust_idx+1)};
+
+        double parent_bic = kpmbase::get_xmeans_bic(
+                std::vector<double>(1, sizes[0] + sizes[1]),
+                parent_sse[clust_idx], ncol);
+        double child_bic = kpmbase::get_xmeans_bic(sizes,
+                child_sse[2*clust_idx] + child_sse[2*clust_idx+1], ncol);
+        if (child_bic > parent_bic)
+            gains.push_back(std::pair<double, unsigned>(
+                        child_bic - parent_bic, clust_idx));
+    }
+    std::sort(gains.begin(), gains.end(),
+            std::greater<std::pair<double, unsigned> >());
+
+    unsigned nsplit = std::min<size_t>(gains.size(), k_max - m.k);
+    centers.assign(means.begin(), means.end());
+    for (unsigned idx = 0; idx < nsplit; idx++) {
+        unsigned clust_idx = gains[idx].second;
+        const double* child = &(split_cltrs->get_means()[2*clust_idx*ncol]);
+        std::copy(child, child + ncol, centers.begin() + clust_idx*ncol);
+        centers.insert(centers.end(), child + ncol, child + 2*ncol);
+#if KM_TEST
+        BOOST_LOG_TRIVIAL(info) << "Splitting center " << clust_idx <<
+            ", BIC gain: " << gains[idx].first;
+#endif
+    }
+    return nsplit;
+}
+
+/**
+ * Main driver for X-means
+ */
+kpmbase::kmeans_t kmeans_xmeans_coordinator::run_kmeans() {
+    struct timeval start, end;
+    gettimeofday(&start , NULL);
+
+    const kpmbase::init_type_t home_init_t = _init_t;
+    prune_model::ptr m = prune_model::create(k, nrow, ncol,
+            io_opts.page_bytes);
+    m->seed = seed;
+    size_t iters = 0;
+    k_history.clear();
+
+    while (true) {
+        models.assign(1, m);
+        run_models();
+        iters += m->iters;
+        k_history.push_back(m->k);
+        BOOST_LOG_TRIVIAL(info) << "X-means round " << k_history.size() <<
+            ": k = " << m->k << ", SSE = " << m->sse;
+
+        if (m->k >= k_max)
+            break;
+
+        std::vector<double> centers;
+        unsigned nsplit = split_round(*m, centers);
+        if (!nsplit)
+            break;
+
+        m = prune_model::create(m->k + nsplit, nrow, ncol,
+                io_opts.page_bytes);
+        m->cltrs->set_mean(centers);
+        _init_t = kpmbase::init_type_t::NONE; // Resume from the children
+    }
+    _init_t = home_init_t;
+
+    gettimeofday(&end, NULL);
+    BOOST_LOG_TRIVIAL(info) << "\n\nAlgorithmic time taken = " <<
+        kpmbase::time_diff(start, end) << " sec\n";
+    BOOST_LOG_TRIVIAL(info) << "\n******************************************\n";
+    BOOST_LOG_TRIVIAL(info) << "X-means chose k = " << m->k << " after " <<
+        k_history.size() << " rounds";
+    printf("Final cluster counts: ");
+    kpmbase::print_arr(&m->cluster_assignment_counts[0], m->k);
+    BOOST_LOG_TRIVIAL(info) << "\n******************************************\n";
+
+    return kpmbase::kmeans_t(nrow, ncol, iters, m->k,
+            m->cluster_assignments->data(), &m->cluster_assignment_counts[0],
+            m->cltrs->get_means());
+}
+} } // End namespace kpmeans, prune
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __KPM_KMEANS_XMEANS_COORDINATOR_HPP__
+#define __KPM_KMEANS_XMEANS_COORDINATOR_HPP__
+
+#include "kmeans_task_coordinator.hpp"
+
+namespace kpmeans { namespace prune {
+
+/**
+  * \brief X-means: grows k from `k' up to `k_max'. After each pruned kmeans
+  *     run every center is tested as a 2-means split of its members, all
+  *     tests sharing each pass over the NUMA-local data. Splits that
+  *     improve the local BIC are kept & the run resumes from the new centers.
+  */
+class kmeans_xmeans_coordinator : public kmeans_task_coordinator {
+private:
+    unsigned k_max;
+    std::vector<unsigned> k_history; // k of each round's model
+
+    kmeans_xmeans_coordinator(const std::string fn, const size_t nrow,
+            const size_t ncol, const unsigned k, const unsigned k_max,
+            const unsigned max_iters, const unsigned nnodes,
+            const unsigned nthreads, const kpmbase::init_type_t it,
+            const double tolerance, const kpmbase::dist_type_t dt);
+
+    void get_cluster_sse(const prune_model& m, std::vector<double>& sse);
+    unsigned split_round(const prune_model& m, std::vector<double>& centers);
+
+protected:
+    // Our result is not a single model's home state
+    size_t run() override { throw kpmbase::not_implemented_exception(); }
+
+public:
+    typedef std::shared_ptr<kmeans_xmeans_coordinator> ptr;
+
+    static ptr create(const std::string fn, const size_t nrow,
+            const size_t ncol, const unsigned k, const unsigned k_max,
+            const unsigned max_iters, const unsigned nnodes,
+            const unsigned nthreads, const std::string init="kmeanspp",
+            const double tolerance=-1, const std::string dist_type="eucl") {
+
+        kpmbase::init_type_t _init_t = kpmbase::get_init_type(init);
+        kpmbase::dist_type_t _dist_t = kpmbase::get_dist_type(dist_type);
+        BOOST_ASSERT_MSG(k > 1 && k <= k_max,
+                "[FATAL]: X-means needs 1 < k <= k_max");
+        BOOST_ASSERT_MSG(_init_t != kpmbase::init_type_t::NONE,
+                "[FATAL]: X-means cannot use provided centers");
+
+#if KM_TEST
+        printf("kmeans xmeans coordinator => NUMA nodes: %u, nthreads: %u, "
+                "nrow: %lu, ncol: %lu, k: [%u, %u], init: '%s', "
+                "dist_t: '%s', fn: '%s'\n\n", nnodes, nthreads, nrow, ncol,
+                k, k_max, init.c_str(), dist_type.c_str(), fn.c_str());
+#endif
+        return ptr(new kmeans_xmeans_coordinator(fn, nrow, ncol, k, k_max,
+                    max_iters, nnodes, nthreads, _init_t, tolerance, _dist_t));
+    }
+
+    // The model of the last round. `iters' counts the iterations of all rounds
+    virtual kpmbase::kmeans_t run_kmeans() override;
+
+    const std::vector<unsigned>& get_k_history() const {
+        return k_history;
+    }
+};
+} } // End namespace kpmeans, prune
+#endif
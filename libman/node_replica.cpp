@@ -0,0 +1,60 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <algorithm>
+#include "node_replica.hpp"
+#include "clusters.hpp"
+#include "dist_matrix.hpp"
+
+namespace kpmeans { namespace prune {
+
+void node_replica::alloc(const unsigned nclust, const unsigned ncol) {
+    this->nclust = nclust;
+    this->ncol = ncol;
+    means = kpmbase::page_array<double>::create(nclust*ncol, 0, node_id);
+    prev_dist_v = kpmbase::page_array<double>::create(nclust, 0, node_id);
+    s_val_v = kpmbase::page_array<double>::create(nclust, 0, node_id);
+    dist_v = kpmbase::page_array<double>::create(
+            std::max(1U, nclust*(nclust-1)/2), 0, node_id);
+}
+
+void node_replica::refresh(kpmbase::prune_clusters& cl, dist_matrix& dm) {
+    if (cl.get_nclust() != nclust || cl.get_ncol() != ncol)
+        alloc(cl.get_nclust(), cl.get_ncol());
+
+    memcpy(means->data(), &cl.get_means()[0], nclust*ncol*sizeof(double));
+    for (unsigned idx = 0; idx < nclust; idx++) {
+        (*prev_dist_v)[idx] = cl.get_prev_dist(idx);
+        (*s_val_v)[idx] = cl.get_s_val(idx);
+    }
+
+    double* dist = dist_v->data();
+    for (unsigned row = 0; row < nclust; row++)
+        for (unsigned col = row+1; col < nclust; col++)
+            *dist++ = dm.get(row, col);
+}
+
+void refresh_replicas(std::vector<node_replica::ptr>& replicas,
+        kpmbase::prune_clusters& cl, dist_matrix& dm) {
+#pragma omp parallel for
+    for (unsigned node_id = 0; node_id < replicas.size(); node_id++)
+        replicas[node_id]->refresh(cl, dm);
+}
+} } // End namespace kpmeans, prune
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __KPM_NODE_REPLICA_HPP__
+#define __KPM_NODE_REPLICA_HPP__
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "numa_mem.hpp"
+
+namespace kpmeans {
+    namespace base {
+    class prune_clusters;
+    }
+    namespace prune {
+    class dist_matrix;
+    }
+}
+
+namespace kpmbase = kpmeans::base;
+
+namespace kpmeans { namespace prune {
+
+/**
+  * \brief A copy, in memory bound to one NUMA node, of all the pruned E-step
+  *     reads about the centers: the means, each center's drift
+  *     (`prev_dist') & half distance to its nearest neighbour (`s_val'), &
+  *     the half distances between centers. The threads of a node read only
+  *     their node's replica.
+  */
+class node_replica {
+private:
+    unsigned nclust, ncol;
+    int node_id;
+    kpmbase::page_array<double>::ptr means;
+    kpmbase::page_array<double>::ptr prev_dist_v;
+    kpmbase::page_array<double>::ptr s_val_v;
+    kpmbase::page_array<double>::ptr dist_v; // Upper triangle, as `dist_matrix'
+
+    node_replica(const int node_id) : nclust(0), ncol(0), node_id(node_id) { }
+    void alloc(const unsigned nclust, const unsigned ncol);
+
+public:
+    typedef std::shared_ptr<node_replica> ptr;
+
+    static ptr create(const int node_id) {
+        return ptr(new node_replica(node_id));
+    }
+
+    // Copy the current centers. Reallocates only when their shape changes
+    void refresh(kpmbase::prune_clusters& cl, dist_matrix& dm);
+
+    const unsigned get_nclust() const { return nclust; }
+    const double* get_means() const { return means->data(); }
+    const double get_prev_dist(const unsigned idx) const {
+        return (*prev_dist_v)[idx];
+    }
+    const double get_s_val(const unsigned idx) const {
+        return (*s_val_v)[idx];
+    }
+
+    // Same as `dist_matrix::get'
+    const double get_dist(unsigned row, unsigned col) const {
+        if (row == col)
+            return std::numeric_limits<double>::max();
+        if (row > col)
+            std::swap(row, col);
+        return (*dist_v)[row*(2*nclust - row - 1)/2 + (col - row - 1)];
+    }
+};
+
+/**
+  * \brief Refresh one replica per node from `cl' & `dm', a node at a time in
+  *     parallel.
+  */
+void refresh_replicas(std::vector<node_replica::ptr>& replicas,
+        kpmbase::prune_clusters& cl, dist_matrix& dm);
+} } // End namespace kpmeans, prune
+#endif
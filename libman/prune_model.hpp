@@ -0,0 +1,83 @@
+/*
+ * Copyright 2016 neurodata (http://neurodata.io/)
+ * Written by Disa Mhembere (disa@jhu.edu)
+ *
+ * This file is part of k-par-means
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY CURRENT_KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __KPM_PRUNE_MODEL_HPP__
+#define __KPM_PRUNE_MODEL_HPP__
+
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "clusters.hpp"
+#include "dist_matrix.hpp"
+#include "numa_mem.hpp"
+#include "node_replica.hpp"
+#include "thd_safe_bool_vector.hpp"
+
+namespace kpmbase = kpmeans::base;
+
+namespace kpmeans { namespace prune {
+
+/**
+  * \brief The per-model state of the pruned algorithm so that several
+  *     independent sets of clusters can share one pass over the data.
+  */
+class prune_model {
+private:
+    prune_model(const unsigned k, const size_t nrow, const size_t ncol,
+            const size_t page_bytes) :
+        k(k), cluster_assignment_counts(k, 0), prune_init(true),
+        converged(false), iters(0), sse(0),
+        seed(std::default_random_engine::default_seed) {
+        cltrs = kpmbase::prune_clusters::create(k, ncol);
+        dm = dist_matrix::create(k);
+        recalculated_v = kpmbase::thd_safe_bool_vector::create(nrow, false,
+                page_bytes);
+        dist_v = kpmbase::page_array<double>::create(nrow,
+                std::numeric_limits<double>::max(), -1, page_bytes);
+        cluster_assignments = kpmbase::page_array<unsigned>::create(nrow,
+                kpmbase::INVALID_CLUSTER_ID, -1, page_bytes);
+    }
+
+public:
+    typedef std::shared_ptr<prune_model> ptr;
+
+    unsigned k;
+    std::shared_ptr<kpmbase::prune_clusters> cltrs;
+    std::shared_ptr<dist_matrix> dm;
+    std::shared_ptr<kpmbase::thd_safe_bool_vector> recalculated_v;
+    // One per node, refreshed before each E-step pass the model is in
+    std::vector<node_replica::ptr> replicas;
+    kpmbase::page_array<double>::ptr dist_v;
+    kpmbase::page_array<unsigned>::ptr cluster_assignments;
+    std::vector<size_t> cluster_assignment_counts;
+    bool prune_init; // The next E-step is a full scan
+    bool converged; // Converged models are skipped by the E-step
+    size_t iters;
+    double sse;
+    unsigned seed; // Used by this model's init
+
+    // `page_bytes' backs the per-row arrays with huge pages. See `alloc_pages'
+    static ptr create(const unsigned k, const size_t nrow, const size_t ncol,
+            const size_t page_bytes=0) {
+        return ptr(new prune_model(k, nrow, ncol, page_bytes));
+    }
+};
+} } // End namespace kpmeans, prune
+#endif
@@ -17,7 +17,15 @@
  * limitations under the License.
  */
 
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <thread>
+
 #include "kmeans.hpp"
+#include "exception.hpp"
+#include "matrix_file.hpp"
 #include "test_shared.hpp"
 #include "util.hpp"
 
@@ -124,6 +132,457 @@ int main(int argc, char* argv[]) {
                         ret_min_auto.centroids.end(),
                         kpmtest::TEST_TOL));
         }
+
+        /////////////////////////// Restarts ///////////////////////////
+        {
+            constexpr unsigned N_INIT = 4;
+            kpmbase::kmeans_t once = kpmeans::omp::compute_kmeans(
+                    &p_data[0], &p_centers[0], &p_clust_asgns[0],
+                    &p_clust_asgn_cnt[0], kpmtest::TEST_NROW,
+                    kpmtest::TEST_NCOL, kpmtest::TEST_K, 10, 2, "forgy", 0);
+            kpmbase::kmeans_t best = kpmeans::omp::compute_kmeans(
+                    &p_data[0], &p_centers[0], &p_clust_asgns[0],
+                    &p_clust_asgn_cnt[0], kpmtest::TEST_NROW,
+                    kpmtest::TEST_NCOL, kpmtest::TEST_K, 10, 2, "forgy", 0,
+                    "eucl", N_INIT);
+            kpmbase::kmeans_t min_best = kpmeans::omp::compute_min_kmeans(
+                    &p_data[0], &p_centers[0], &p_clust_asgns[0],
+                    &p_clust_asgn_cnt[0], kpmtest::TEST_NROW,
+                    kpmtest::TEST_NCOL, kpmtest::TEST_K, 10, 2, "forgy", 0,
+                    "eucl", N_INIT);
+
+            // Restart 0 is the single run so the best can't be worse
+            BOOST_VERIFY(kpmbase::get_sse(&p_data[0], &best.centroids[0],
+                        &best.assignments[0], kpmtest::TEST_NROW,
+                        kpmtest::TEST_NCOL, 2) <=
+                    kpmbase::get_sse(&p_data[0], &once.centroids[0],
+                        &once.assignments[0], kpmtest::TEST_NROW,
+                        kpmtest::TEST_NCOL, 2) + kpmtest::TEST_TOL);
+            BOOST_VERIFY(kpmtest::check_collection_equal(
+                        best.centroids.begin(), best.centroids.end(),
+                        min_best.centroids.begin(), min_best.centroids.end(),
+                        kpmtest::TEST_TOL));
+            std::cout << "\n***Restarts passed ***\n";
+        }
+
+        /////////////////////////// Weights ///////////////////////////
+        {
+            // A row of integer weight w must act as w copies of itself
+            kpmbase::bin_io<double> br(kpmtest::TESTDATA_FN,
+                    kpmtest::TEST_NROW, kpmtest::TEST_NCOL);
+            br.read(&p_data[0]);
+            std::vector<double> init_centers(p_centers.size());
+            kpmbase::bin_io<double> bc(kpmtest::TEST_INIT_CLUSTERS,
+                    kpmtest::TEST_K, kpmtest::TEST_NCOL);
+            bc.read(&init_centers[0]);
+
+            std::vector<double> weights(kpmtest::TEST_NROW);
+            std::vector<double> dup_data;
+            for (size_t row = 0; row < kpmtest::TEST_NROW; row++) {
+                weights[row] = 1 + (row % 3);
+                for (unsigned w = 0; w < weights[row]; w++)
+                    dup_data.insert(dup_data.end(),
+                            &p_data[row*kpmtest::TEST_NCOL],
+                            &p_data[(row+1)*kpmtest::TEST_NCOL]);
+            }
+            const size_t dup_nrow = dup_data.size() / kpmtest::TEST_NCOL;
+            std::vector<unsigned> dup_asgns(dup_nrow);
+
+            std::vector<double> centers = init_centers;
+            kpmbase::kmeans_t dup = kpmeans::omp::compute_kmeans(
+                    &dup_data[0], &centers[0], &dup_asgns[0],
+                    &p_clust_asgn_cnt[0], dup_nrow, kpmtest::TEST_NCOL,
+                    kpmtest::TEST_K, 10, 2, "none", 0);
+
+            centers = init_centers;
+            kpmbase::kmeans_t weighted = kpmeans::omp::compute_kmeans(
+                    &p_data[0], &centers[0], &p_clust_asgns[0],
+                    &p_clust_asgn_cnt[0], kpmtest::TEST_NROW,
+                    kpmtest::TEST_NCOL, kpmtest::TEST_K, 10, 2, "none", 0,
+                    "eucl", 1, &weights[0]);
+
+            centers = init_centers;
+            kpmbase::kmeans_t min_weighted = kpmeans::omp::compute_min_kmeans(
+                    &p_data[0], &centers[0], &p_clust_asgns[0],
+                    &p_clust_asgn_cnt[0], kpmtest::TEST_NROW,
+                    kpmtest::TEST_NCOL, kpmtest::TEST_K, 10, 2, "none", 0,
+                    "eucl", 1, &weights[0]);
+
+            BOOST_VERIFY(kpmtest::check_collection_equal(
+                        dup.centroids.begin(), dup.centroids.end(),
+                        weighted.centroids.begin(), weighted.centroids.end(),
+                        kpmtest::TEST_TOL));
+            BOOST_VERIFY(kpmtest::check_collection_equal(
+                        weighted.centroids.begin(), weighted.centroids.end(),
+                        min_weighted.centroids.begin(),
+                        min_weighted.centroids.end(), kpmtest::TEST_TOL));
+            std::cout << "\n***Weights passed ***\n";
+        }
+
+        /////////////////////////// Sparse ///////////////////////////
+        {
+            kpmbase::bin_io<double> br(kpmtest::TESTDATA_FN,
+                    kpmtest::TEST_NROW, kpmtest::TEST_NCOL);
+            br.read(&p_data[0]);
+            std::vector<double> sparse_data = p_data;
+            for (size_t i = 0; i < sparse_data.size(); i += 3)
+                sparse_data[i] = 0;
+            kpmbase::csr_matrix::ptr mat = kpmbase::csr_matrix::create(
+                    &sparse_data[0], kpmtest::TEST_NROW, kpmtest::TEST_NCOL);
+
+            std::vector<double> init_centers(p_centers.size());
+            kpmbase::bin_io<double> bc(kpmtest::TEST_INIT_CLUSTERS,
+                    kpmtest::TEST_K, kpmtest::TEST_NCOL);
+            bc.read(&init_centers[0]);
+
+            std::vector<double> centers = init_centers;
+            kpmbase::kmeans_t dense = kpmeans::omp::compute_kmeans(
+                    &sparse_data[0], &centers[0], &p_clust_asgns[0],
+                    &p_clust_asgn_cnt[0], kpmtest::TEST_NROW,
+                    kpmtest::TEST_NCOL, kpmtest::TEST_K, 10, 2, "none", 0);
+            centers = init_centers;
+            kpmbase::kmeans_t sparse = kpmeans::omp::compute_sparse_kmeans(
+                    mat, &centers[0], &p_clust_asgns[0], &p_clust_asgn_cnt[0],
+                    kpmtest::TEST_K, 10, 2, "none", 0);
+
+            BOOST_VERIFY(dense.iters == sparse.iters);
+            BOOST_VERIFY(std::equal(dense.assignments.begin(),
+                        dense.assignments.end(), sparse.assignments.begin()));
+            BOOST_VERIFY(kpmtest::check_collection_equal(
+                        dense.centroids.begin(), dense.centroids.end(),
+                        sparse.centroids.begin(), sparse.centroids.end(),
+                        kpmtest::TEST_TOL));
+
+            // Seeded inits pick the same rows as the dense engine's
+            const char* seeded[] = {"forgy", "random"};
+            for (unsigned i = 0; i < 2; i++) {
+                dense = kpmeans::omp::compute_kmeans(&sparse_data[0],
+                        &centers[0], &p_clust_asgns[0], &p_clust_asgn_cnt[0],
+                        kpmtest::TEST_NROW, kpmtest::TEST_NCOL,
+                        kpmtest::TEST_K, 10, 2, seeded[i], 0);
+                sparse = kpmeans::omp::compute_sparse_kmeans(mat, &centers[0],
+                        &p_clust_asgns[0], &p_clust_asgn_cnt[0],
+                        kpmtest::TEST_K, 10, 2, seeded[i], 0, "eucl",
+                        std::default_random_engine::default_seed);
+                BOOST_VERIFY(dense.iters == sparse.iters);
+                BOOST_VERIFY(kpmtest::check_collection_equal(
+                            dense.centroids.begin(), dense.centroids.end(),
+                            sparse.centroids.begin(), sparse.centroids.end(),
+                            kpmtest::TEST_TOL));
+            }
+            std::cout << "\n***Sparse passed ***\n";
+        }
+
+        /////////////////////////// Center index ///////////////////////////
+        {
+            kpmbase::bin_io<double> br(kpmtest::TESTDATA_FN,
+                    kpmtest::TEST_NROW, kpmtest::TEST_NCOL);
+            br.read(&p_data[0]);
+            std::vector<double> init_centers(p_centers.size());
+            kpmbase::bin_io<double> bc(kpmtest::TEST_INIT_CLUSTERS,
+                    kpmtest::TEST_K, kpmtest::TEST_NCOL);
+            bc.read(&init_centers[0]);
+
+            std::vector<double> centers = init_centers;
+            kpmbase::kmeans_t scan = kpmeans::omp::compute_kmeans(
+                    &p_data[0], &centers[0], &p_clust_asgns[0],
+                    &p_clust_asgn_cnt[0], kpmtest::TEST_NROW,
+                    kpmtest::TEST_NCOL, kpmtest::TEST_K, 10, 2, "none", 0);
+            centers = init_centers;
+            kpmbase::kmeans_t indexed = kpmeans::omp::compute_kmeans(
+                    &p_data[0], &centers[0], &p_clust_asgns[0],
+                    &p_clust_asgn_cnt[0], kpmtest::TEST_NROW,
+                    kpmtest::TEST_NCOL, kpmtest::TEST_K, 10, 2, "none", 0,
+                    "eucl", 1, NULL, 0);
+
+            // An exact index query must not change the result
+            BOOST_VERIFY(scan.iters == indexed.iters);
+            BOOST_VERIFY(std::equal(scan.assignments.begin(),
+                        scan.assignments.end(), indexed.assignments.begin()));
+            BOOST_VERIFY(kpmtest::check_collection_equal(
+                        scan.centroids.begin(), scan.centroids.end(),
+                        indexed.centroids.begin(), indexed.centroids.end(),
+                        kpmtest::TEST_TOL));
+            std::cout << "\n***Center index passed ***\n";
+        }
+
+        /////////////////////////// Concurrent ///////////////////////////
+        {
+            kpmbase::bin_io<double> br(kpmtest::TESTDATA_FN,
+                    kpmtest::TEST_NROW, kpmtest::TEST_NCOL);
+            br.read(&p_data[0]);
+            const unsigned min_k = kpmtest::TEST_K-1;
+
+            // Each run on its own team & buffers
+            std::vector<double> centers(p_centers.size());
+            std::vector<unsigned> asgns(kpmtest::TEST_NROW);
+            std::vector<size_t> counts(kpmtest::TEST_K);
+            std::vector<double> min_centers(min_k*kpmtest::TEST_NCOL);
+            std::vector<unsigned> min_asgns(kpmtest::TEST_NROW);
+            std::vector<size_t> min_counts(min_k);
+
+            // kmeans++ draws too, so it must be just as independent
+            const std::string inits[] = {"forgy", "kmeanspp"};
+            for (const std::string& init : inits) {
+                kpmbase::kmeans_t serial = kpmeans::omp::compute_kmeans(
+                        &p_data[0], &centers[0], &asgns[0], &counts[0],
+                        kpmtest::TEST_NROW, kpmtest::TEST_NCOL, kpmtest::TEST_K,
+                        10, 2, init, 0);
+                kpmbase::kmeans_t min_serial = kpmeans::omp::compute_min_kmeans(
+                        &p_data[0], &min_centers[0], &min_asgns[0],
+                        &min_counts[0], kpmtest::TEST_NROW, kpmtest::TEST_NCOL,
+                        min_k, 10, 2, init, 0);
+
+                kpmbase::kmeans_t conc, min_conc;
+                std::thread t([&] {
+                        conc = kpmeans::omp::compute_kmeans(&p_data[0],
+                                &centers[0], &asgns[0], &counts[0],
+                                kpmtest::TEST_NROW, kpmtest::TEST_NCOL,
+                                kpmtest::TEST_K, 10, 2, init, 0);
+                        });
+                std::thread min_t([&] {
+                        min_conc = kpmeans::omp::compute_min_kmeans(&p_data[0],
+                                &min_centers[0], &min_asgns[0], &min_counts[0],
+                                kpmtest::TEST_NROW, kpmtest::TEST_NCOL, min_k,
+                                10, 2, init, 0);
+                        });
+                t.join();
+                min_t.join();
+
+                // Neither run sees the other's k, counts or draws
+                BOOST_VERIFY(conc.iters == serial.iters);
+                BOOST_VERIFY(conc.assignments == serial.assignments);
+                BOOST_VERIFY(conc.centroids == serial.centroids);
+                BOOST_VERIFY(min_conc.iters == min_serial.iters);
+                BOOST_VERIFY(min_conc.assignments == min_serial.assignments);
+                BOOST_VERIFY(min_conc.centroids == min_serial.centroids);
+            }
+            std::cout << "\n***Concurrent passed ***\n";
+        }
+
+        /////////////////////////// Stream ///////////////////////////
+        {
+            // Distant blobs, interleaved so the first k rows seed one center
+            //  each. Every row then joins its own blob's center & the
+            //  per-center learning rate keeps each at its blob's mean.
+            constexpr unsigned NBLOB = 4;
+            constexpr size_t NROW = 400;
+            const std::string binfn = "test_stream.bin";
+            const std::string txtfn = "test_stream.txt";
+            std::vector<double> blobs(NROW*kpmtest::TEST_NCOL);
+            std::vector<double> means(NBLOB*kpmtest::TEST_NCOL, 0);
+            std::ofstream txt(txtfn);
+            for (size_t row = 0; row < NROW; row++) {
+                for (size_t col = 0; col < kpmtest::TEST_NCOL; col++) {
+                    double val = 100*(row % NBLOB) + .25*((row + col) % 7);
+                    blobs[row*kpmtest::TEST_NCOL+col] = val;
+                    means[(row % NBLOB)*kpmtest::TEST_NCOL+col] +=
+                        val/(NROW/NBLOB);
+                    txt << val << (col + 1 < kpmtest::TEST_NCOL ? " " : "\n");
+                }
+                if (row == NROW/2)
+                    txt << "\n"; // Blank lines are skipped
+            }
+            txt.close();
+            {
+                kpmbase::bin_io<double> bw(binfn, "wb");
+                bw.write(blobs, blobs.size());
+            }
+
+            for (std::string format : {"bin", "text"}) {
+                std::vector<double> centers(NBLOB*kpmtest::TEST_NCOL);
+                kpmbase::kmeans_t ret = kpmeans::omp::compute_stream_kmeans(
+                        format == "bin" ? binfn : txtfn, format, &centers[0],
+                        kpmtest::TEST_NCOL, NBLOB, 2, 16, 2);
+                BOOST_VERIFY(ret.nrow == NROW);
+                BOOST_VERIFY(ret.assignment_count ==
+                        std::vector<size_t>(NBLOB, NROW/NBLOB));
+                BOOST_VERIFY(kpmtest::check_collection_equal(
+                            ret.centroids.begin(), ret.centroids.end(),
+                            means.begin(), means.end(), kpmtest::TEST_TOL));
+            }
+            remove(binfn.c_str());
+            remove(txtfn.c_str());
+            std::cout << "\n***Stream passed ***\n";
+        }
+
+        /////////////////////////// Stream errors ///////////////////////////
+        {
+            // Too few rows to seed every center
+            const unsigned big_k = kpmtest::TEST_NROW+1;
+            std::vector<double> centers(big_k*kpmtest::TEST_NCOL);
+            bool threw = false;
+            try {
+                kpmeans::omp::compute_stream_kmeans(kpmtest::TESTDATA_FN,
+                        "bin", &centers[0], kpmtest::TEST_NCOL, big_k, 2, 8);
+            } catch (kpmbase::io_exception& e) {
+                threw = true;
+            }
+            BOOST_VERIFY(threw);
+
+            // A failed checkpoint unwinds with the reader still running.
+            //  Renaming onto a directory fails
+            const std::string ckpt_dir = "stream_ckpt_dir";
+            mkdir(ckpt_dir.c_str(), 0755);
+            threw = false;
+            try {
+                kpmeans::omp::compute_stream_kmeans(kpmtest::TESTDATA_FN,
+                        "bin", &p_centers[0], kpmtest::TEST_NCOL,
+                        kpmtest::TEST_K, 2, 8, 1, "forgy", ckpt_dir, 1);
+            } catch (kpmbase::io_exception& e) {
+                threw = true;
+            }
+            BOOST_VERIFY(threw);
+            remove((ckpt_dir + ".tmp").c_str());
+            rmdir(ckpt_dir.c_str());
+
+            // Text rows with too many or too few values
+            const std::string txtfn = "test_stream_bad.txt";
+            for (std::string bad : {"1 2 3 4 5 6", "1 2"}) {
+                std::ofstream txt(txtfn);
+                for (unsigned row = 0; row < kpmtest::TEST_K; row++)
+                    txt << "1 2 3 4 5\n";
+                txt << bad << "\n";
+                txt.close();
+                BOOST_VERIFY(kpmtest::throws<kpmbase::io_exception>([&] {
+                            kpmeans::omp::compute_stream_kmeans(txtfn, "text",
+                                &p_centers[0], kpmtest::TEST_NCOL,
+                                kpmtest::TEST_K, 2, 4); }));
+            }
+            remove(txtfn.c_str());
+            std::cout << "\n***Stream errors passed ***\n";
+        }
+
+        /////////////////////////// Bisecting ///////////////////////////
+        {
+            kpmbase::bin_io<double> br(kpmtest::TESTDATA_FN,
+                    kpmtest::TEST_NROW, kpmtest::TEST_NCOL);
+            br.read(&p_data[0]);
+
+            for (unsigned branching = 2; branching <= 3; branching++) {
+                kpmbase::cluster_tree::ptr tree;
+                kpmbase::kmeans_t ret =
+                    kpmeans::omp::compute_bisecting_kmeans(&p_data[0],
+                            &p_centers[0], &p_clust_asgns[0],
+                            &p_clust_asgn_cnt[0], kpmtest::TEST_NROW,
+                            kpmtest::TEST_NCOL, kpmtest::TEST_K, 10, 2,
+                            branching, "kmeanspp", 0, "eucl", NULL, &tree);
+                BOOST_VERIFY(ret.k == kpmtest::TEST_K);
+                BOOST_VERIFY(tree->number_leaves() == kpmtest::TEST_K);
+                if (branching == 2)
+                    BOOST_VERIFY(tree->size() == 2*kpmtest::TEST_K-1);
+
+                // Every leaf mean is the mean of the rows assigned to it
+                std::vector<double> means(ret.centroids.size(), 0);
+                std::vector<size_t> counts(kpmtest::TEST_K, 0);
+                for (size_t row = 0; row < kpmtest::TEST_NROW; row++) {
+                    counts[ret.assignments[row]]++;
+                    for (size_t col = 0; col < kpmtest::TEST_NCOL; col++)
+                        means[ret.assignments[row]*kpmtest::TEST_NCOL+col] +=
+                            p_data[row*kpmtest::TEST_NCOL+col];
+                }
+                for (size_t i = 0; i < means.size(); i++)
+                    means[i] /= counts[i/kpmtest::TEST_NCOL];
+                BOOST_VERIFY(std::equal(counts.begin(), counts.end(),
+                            ret.assignment_count.begin()));
+                BOOST_VERIFY(kpmtest::check_collection_equal(means.begin(),
+                            means.end(), ret.centroids.begin(),
+                            ret.centroids.end(), kpmtest::TEST_TOL));
+
+                // Children partition their parent
+                for (unsigned id = 0; id < tree->size(); id++) {
+                    const kpmbase::cluster_tree::node& n = tree->get_node(id);
+                    size_t size = 0;
+                    for (unsigned i = 0; i < n.children.size(); i++)
+                        size += tree->get_node(n.children[i]).size;
+                    BOOST_VERIFY(n.children.empty() || size == n.size);
+                }
+
+                // Routing a leaf mean through the tree lands on that leaf
+                for (unsigned clust = 0; clust < kpmtest::TEST_K; clust++) {
+                    double dist;
+                    BOOST_VERIFY(tree->predict(&ret.centroids[
+                                clust*kpmtest::TEST_NCOL], dist) == clust);
+                    BOOST_VERIFY(dist == 0);
+                }
+            }
+            std::cout << "\n***Bisecting passed ***\n";
+        }
+
+        /////////////////////////// Predict ///////////////////////////
+        {
+            kpmbase::bin_io<double> br(kpmtest::TESTDATA_FN,
+                    kpmtest::TEST_NROW, kpmtest::TEST_NCOL);
+            br.read(&p_data[0]);
+            kpmbase::kmeans_t ret = kpmtest::run_test(&p_centers[0],
+                    &p_data[0], &p_clust_asgn_cnt[0], &p_clust_asgns[0],
+                    false, "none", std::numeric_limits<unsigned>::max());
+
+            // Converged centers label every row as the run did
+            std::vector<unsigned> asgns(kpmtest::TEST_NROW);
+            std::vector<double> dists(kpmtest::TEST_NROW);
+            std::vector<size_t> counts(kpmtest::TEST_K);
+            kpmeans::omp::predict(&p_data[0], &ret.centroids[0], &asgns[0],
+                    &dists[0], &counts[0], kpmtest::TEST_NROW,
+                    kpmtest::TEST_NCOL, kpmtest::TEST_K, 2);
+            BOOST_VERIFY(asgns == ret.assignments);
+            BOOST_VERIFY(counts == ret.assignment_count);
+            for (size_t row = 0; row < kpmtest::TEST_NROW; row++)
+                BOOST_VERIFY(dists[row] == kpmbase::eucl_dist(
+                            &p_data[row*kpmtest::TEST_NCOL], &ret.centroids[
+                            asgns[row]*kpmtest::TEST_NCOL],
+                            kpmtest::TEST_NCOL));
+
+            // Two disjoint ranges of the file, as two processes would
+            const std::string asgnfn = "test_predict_asgns.bin";
+            const std::string distfn = "test_predict_dists.bin";
+            remove(asgnfn.c_str());
+            remove(distfn.c_str());
+            constexpr size_t SPLIT = 23;
+            std::vector<size_t> file_counts(kpmtest::TEST_K);
+            kpmeans::omp::predict_file(kpmtest::TESTDATA_FN, 0, SPLIT,
+                    &ret.centroids[0], kpmtest::TEST_NCOL, kpmtest::TEST_K,
+                    asgnfn, distfn, &file_counts[0], 2, 7);
+            std::vector<size_t> tail_counts(kpmtest::TEST_K);
+            kpmeans::omp::predict_file(kpmtest::TESTDATA_FN, SPLIT,
+                    kpmtest::TEST_NROW-SPLIT, &ret.centroids[0],
+                    kpmtest::TEST_NCOL, kpmtest::TEST_K, asgnfn, distfn,
+                    &tail_counts[0], 2, 7);
+            for (unsigned clust = 0; clust < kpmtest::TEST_K; clust++)
+                file_counts[clust] += tail_counts[clust];
+
+            std::vector<unsigned> file_asgns(kpmtest::TEST_NROW);
+            std::vector<double> file_dists(kpmtest::TEST_NROW);
+            {
+                kpmbase::bin_io<unsigned> ba(asgnfn, kpmtest::TEST_NROW, 1);
+                ba.read(&file_asgns);
+                kpmbase::bin_io<double> bd(distfn, kpmtest::TEST_NROW, 1);
+                bd.read(&file_dists);
+            }
+            remove(asgnfn.c_str());
+            remove(distfn.c_str());
+            BOOST_VERIFY(file_asgns == asgns);
+            BOOST_VERIFY(file_dists == dists);
+            BOOST_VERIFY(file_counts == counts);
+
+            // The rows of a file with a header start after it
+            const std::string hdrfn = "test_predict_header.bin";
+            kpmbase::write_matrix(hdrfn, &p_data[0], kpmtest::TEST_NROW,
+                    kpmtest::TEST_NCOL);
+            kpmeans::omp::predict_file(hdrfn, 0, kpmtest::TEST_NROW,
+                    &ret.centroids[0], kpmtest::TEST_NCOL, kpmtest::TEST_K,
+                    asgnfn, "", &file_counts[0], 2, 7, "eucl",
+                    kpmbase::get_data_offset(hdrfn));
+            {
+                kpmbase::bin_io<unsigned> ba(asgnfn, kpmtest::TEST_NROW, 1);
+                ba.read(&file_asgns);
+            }
+            remove(hdrfn.c_str());
+            remove(asgnfn.c_str());
+            BOOST_VERIFY(file_asgns == asgns);
+            BOOST_VERIFY(file_counts == counts);
+            std::cout << "\n***Predict passed ***\n";
+        }
     }
     return EXIT_SUCCESS;
 }
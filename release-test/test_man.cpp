@@ -18,9 +18,16 @@
  */
 
 #include <numa.h>
+#include <unistd.h>
+#include <numeric>
 
+#include "kmeans.hpp"
 #include "kmeans_coordinator.hpp"
 #include "kmeans_task_coordinator.hpp"
+#include "kmeans_minibatch_coordinator.hpp"
+#include "kmeans_sweep_coordinator.hpp"
+#include "kmeans_xmeans_coordinator.hpp"
+#include "matrix_file.hpp"
 #include "test_shared.hpp"
 #include "util.hpp"
 
@@ -106,6 +113,7 @@ int main(int argc, char* argv[]) {
 
         inits.push_back("random");
         inits.push_back("forgy");
+        inits.push_back("subsample");
 
         for (std::vector<std::string>::iterator it = inits.begin();
                 it != inits.end(); ++it) {
@@ -133,5 +141,562 @@ int main(int argc, char* argv[]) {
                         kpmtest::TEST_TOL));
         }
     }
+
+    /////////////////////////// Mini-batch ///////////////////////////
+    {
+        p_centers.resize(kpmtest::TEST_K*kpmtest::TEST_NCOL);
+        kpmbase::bin_io<double> br(kpmtest::TEST_INIT_CLUSTERS,
+                kpmtest::TEST_K, kpmtest::TEST_NCOL);
+        br.read(&p_centers[0]);
+        kpmbase::bin_io<double> br2(kpmtest::TESTDATA_FN,
+                kpmtest::TEST_NROW, kpmtest::TEST_NCOL);
+        br2.read(&p_data[0]);
+
+        kpmeans::base_kmeans_coordinator::ptr kc =
+            kpmprune::kmeans_minibatch_coordinator::create(
+                    kpmtest::TESTDATA_FN, kpmtest::TEST_NROW,
+                    kpmtest::TEST_NCOL, kpmtest::TEST_K, 5,
+                    numa_num_task_nodes(), 2, kpmtest::TEST_NROW/4,
+                    &p_centers[0], "none");
+        kpmbase::kmeans_t ret = kc->run_kmeans();
+
+        BOOST_VERIFY(std::accumulate(ret.assignment_count.begin(),
+                    ret.assignment_count.end(), 0UL) == kpmtest::TEST_NROW);
+        // Every row must be labelled with its nearest final center
+        for (size_t row = 0; row < kpmtest::TEST_NROW; row++) {
+            const double* rp = &p_data[row*kpmtest::TEST_NCOL];
+            double best = kpmbase::eucl_dist(rp,
+                    &ret.centroids[ret.assignments[row]*kpmtest::TEST_NCOL],
+                    kpmtest::TEST_NCOL);
+            for (unsigned c = 0; c < kpmtest::TEST_K; c++)
+                BOOST_VERIFY(best <= kpmbase::eucl_dist(rp,
+                            &ret.centroids[c*kpmtest::TEST_NCOL],
+                            kpmtest::TEST_NCOL) + kpmtest::TEST_TOL);
+        }
+        std::cout << "\n***Mini-batch passed ***\n";
+    }
+
+    /////////////////////////// Sweep over k ///////////////////////////
+    {
+        std::vector<unsigned> ks {2, kpmtest::TEST_K, 5};
+        kpmprune::kmeans_sweep_coordinator::ptr sc =
+            kpmprune::kmeans_sweep_coordinator::create(kpmtest::TESTDATA_FN,
+                    kpmtest::TEST_NROW, kpmtest::TEST_NCOL, ks, 10,
+                    numa_num_task_nodes(), 2, "forgy", 0);
+        std::vector<kpmbase::kmeans_t> rets = sc->run_sweep();
+
+        // Each model must match an independent run with the same k
+        for (unsigned idx = 0; idx < ks.size(); idx++) {
+            kpmbase::kmeans_t ret =
+                kpmprune::kmeans_task_coordinator::create(
+                        kpmtest::TESTDATA_FN, kpmtest::TEST_NROW,
+                        kpmtest::TEST_NCOL, ks[idx], 10,
+                        numa_num_task_nodes(), 2, NULL, "forgy", 0)->
+                run_kmeans();
+
+            BOOST_VERIFY(ret.iters == rets[idx].iters);
+            BOOST_VERIFY(std::equal(ret.assignment_count.begin(),
+                        ret.assignment_count.end(),
+                        rets[idx].assignment_count.begin()));
+            BOOST_VERIFY(kpmtest::check_collection_equal(
+                        ret.centroids.begin(), ret.centroids.end(),
+                        rets[idx].centroids.begin(), rets[idx].centroids.end(),
+                        kpmtest::TEST_TOL));
+            BOOST_VERIFY(sc->get_sse(idx) > 0);
+        }
+        std::cout << "\n***Sweep passed ***\n";
+    }
+
+    /////////////////////////// Restarts ///////////////////////////
+    {
+        constexpr unsigned N_INIT = 3;
+        kpmprune::kmeans_task_coordinator::ptr kc =
+            kpmprune::kmeans_task_coordinator::create(kpmtest::TESTDATA_FN,
+                    kpmtest::TEST_NROW, kpmtest::TEST_NCOL, kpmtest::TEST_K,
+                    10, numa_num_task_nodes(), 2, NULL, "forgy", 0);
+        std::static_pointer_cast<kpmprune::kmeans_task_coordinator>(kc)->
+            set_n_init(N_INIT);
+        kpmbase::kmeans_t best = kc->run_kmeans();
+        double best_sse = kpmbase::get_sse(&p_data[0], &best.centroids[0],
+                &best.assignments[0], kpmtest::TEST_NROW,
+                kpmtest::TEST_NCOL, 2);
+
+        // Interleaved restarts must match the same seeds run one by one
+        double min_sse = std::numeric_limits<double>::max();
+        for (unsigned r = 0; r < N_INIT; r++) {
+            kpmprune::kmeans_task_coordinator::ptr rc =
+                kpmprune::kmeans_task_coordinator::create(
+                        kpmtest::TESTDATA_FN, kpmtest::TEST_NROW,
+                        kpmtest::TEST_NCOL, kpmtest::TEST_K, 10,
+                        numa_num_task_nodes(), 2, NULL, "forgy", 0);
+            rc->set_seed(std::default_random_engine::default_seed + r);
+            kpmbase::kmeans_t ret = rc->run_kmeans();
+            min_sse = std::min(min_sse, kpmbase::get_sse(&p_data[0],
+                        &ret.centroids[0], &ret.assignments[0],
+                        kpmtest::TEST_NROW, kpmtest::TEST_NCOL, 2));
+        }
+        BOOST_VERIFY(std::abs(best_sse - min_sse) < kpmtest::TEST_TOL);
+        std::cout << "\n***Restarts passed ***\n";
+    }
+
+    /////////////////////////// Reuse ///////////////////////////
+    {
+        kpmeans::base_kmeans_coordinator::ptr kc =
+            kpmprune::kmeans_task_coordinator::create(kpmtest::TESTDATA_FN,
+                    kpmtest::TEST_NROW, kpmtest::TEST_NCOL, kpmtest::TEST_K,
+                    10, numa_num_task_nodes(), 2, NULL, "forgy", 0);
+        kpmprune::kmeans_task_coordinator& engine =
+            *std::static_pointer_cast<kpmprune::kmeans_task_coordinator>(kc);
+
+        // Every run on the loaded data must match a fresh coordinator's
+        std::vector<unsigned> ks {2, kpmtest::TEST_K, 5, 2};
+        for (unsigned idx = 0; idx < ks.size(); idx++) {
+            kpmbase::kmeans_t ret = engine.run_kmeans(ks[idx], "forgy", 10, 0);
+            kpmbase::kmeans_t fresh =
+                kpmprune::kmeans_task_coordinator::create(
+                        kpmtest::TESTDATA_FN, kpmtest::TEST_NROW,
+                        kpmtest::TEST_NCOL, ks[idx], 10,
+                        numa_num_task_nodes(), 2, NULL, "forgy", 0)->
+                run_kmeans();
+
+            BOOST_VERIFY(ret.k == ks[idx] && ret.iters == fresh.iters);
+            BOOST_VERIFY(ret.assignments == fresh.assignments);
+            BOOST_VERIFY(kpmtest::check_collection_equal(
+                        ret.centroids.begin(), ret.centroids.end(),
+                        fresh.centroids.begin(), fresh.centroids.end(),
+                        kpmtest::TEST_TOL));
+        }
+
+        // Provided centers, then the creation parameters again
+        std::vector<double> centers(kpmtest::TEST_K*kpmtest::TEST_NCOL);
+        kpmbase::bin_io<double> bc(kpmtest::TEST_INIT_CLUSTERS,
+                kpmtest::TEST_K, kpmtest::TEST_NCOL);
+        bc.read(&centers[0]);
+        kpmbase::kmeans_t ret = engine.run_kmeans(kpmtest::TEST_K, "none", 10,
+                0, &centers[0]);
+        kpmbase::kmeans_t fresh = kpmprune::kmeans_task_coordinator::create(
+                kpmtest::TESTDATA_FN, kpmtest::TEST_NROW, kpmtest::TEST_NCOL,
+                kpmtest::TEST_K, 10, numa_num_task_nodes(), 2, &centers[0],
+                "none", 0)->run_kmeans();
+        BOOST_VERIFY(ret.iters == fresh.iters &&
+                ret.assignments == fresh.assignments);
+        kpmbase::kmeans_t first = kc->run_kmeans();
+        BOOST_VERIFY(first.k == kpmtest::TEST_K &&
+                first.assignments == kc->run_kmeans().assignments);
+
+        // A resumed run, then one that starts over without the old rows
+        kpmbase::kmeans_t prefix = kpmprune::kmeans_task_coordinator::create(
+                kpmtest::TESTDATA_FN, kpmtest::TEST_NROW-10,
+                kpmtest::TEST_NCOL, kpmtest::TEST_K, 10,
+                numa_num_task_nodes(), 2, &centers[0], "none", 0)->
+            run_kmeans();
+        engine.set_warm_start(prefix, std::vector<double>());
+        kpmbase::kmeans_t warm = kc->run_kmeans();
+        // Restarts from the converged centers, so nothing moves
+        ret = kc->run_kmeans();
+        BOOST_VERIFY(ret.assignments == warm.assignments);
+        BOOST_VERIFY(ret.assignment_count == warm.assignment_count);
+        std::cout << "\n***Reuse passed ***\n";
+    }
+
+    /////////////////////////// In memory ///////////////////////////
+    {
+        std::vector<double> centers(kpmtest::TEST_K*kpmtest::TEST_NCOL);
+        kpmbase::bin_io<double> bc(kpmtest::TEST_INIT_CLUSTERS,
+                kpmtest::TEST_K, kpmtest::TEST_NCOL);
+        bc.read(&centers[0]);
+
+        kpmbase::buffer_use_t uses[] = {kpmbase::buffer_use_t::IN_PLACE,
+            kpmbase::buffer_use_t::MOVE, kpmbase::buffer_use_t::COPY};
+        for (bool prune : {true, false}) {
+            kpmbase::kmeans_t file_ret = prune ?
+                kpmprune::kmeans_task_coordinator::create(
+                        kpmtest::TESTDATA_FN, kpmtest::TEST_NROW,
+                        kpmtest::TEST_NCOL, kpmtest::TEST_K, 10,
+                        numa_num_task_nodes(), 2, &centers[0], "none", 0)->
+                run_kmeans() :
+                kpmeans::kmeans_coordinator::create(kpmtest::TESTDATA_FN,
+                        kpmtest::TEST_NROW, kpmtest::TEST_NCOL,
+                        kpmtest::TEST_K, 10, numa_num_task_nodes(), 2,
+                        &centers[0], "none", 0)->run_kmeans();
+
+            for (kpmbase::buffer_use_t use : uses) {
+                kpmeans::base_kmeans_coordinator::ptr kc = prune ?
+                    kpmprune::kmeans_task_coordinator::create(&p_data[0],
+                            kpmtest::TEST_NROW, kpmtest::TEST_NCOL,
+                            kpmtest::TEST_K, 10, numa_num_task_nodes(), 2,
+                            use, &centers[0], "none", 0) :
+                    kpmeans::kmeans_coordinator::create(&p_data[0],
+                            kpmtest::TEST_NROW, kpmtest::TEST_NCOL,
+                            kpmtest::TEST_K, 10, numa_num_task_nodes(), 2,
+                            use, &centers[0], "none", 0);
+
+                // Straight into our buffers
+                std::vector<unsigned> asgns(kpmtest::TEST_NROW);
+                std::vector<size_t> counts(kpmtest::TEST_K);
+                std::vector<double> means(kpmtest::TEST_K*kpmtest::TEST_NCOL);
+                size_t iters = kc->run_kmeans(&asgns[0], &counts[0],
+                        &means[0]);
+
+                BOOST_VERIFY(iters == file_ret.iters);
+                BOOST_VERIFY(asgns == file_ret.assignments);
+                BOOST_VERIFY(counts == file_ret.assignment_count);
+                BOOST_VERIFY(kpmtest::check_collection_equal(
+                            means.begin(), means.end(),
+                            file_ret.centroids.begin(),
+                            file_ret.centroids.end(), kpmtest::TEST_TOL));
+            }
+        }
+
+        // A run that throws must not leave the threads on our buffer
+        kpmeans::base_kmeans_coordinator::ptr xc =
+            kpmprune::kmeans_xmeans_coordinator::create(kpmtest::TESTDATA_FN,
+                    kpmtest::TEST_NROW, kpmtest::TEST_NCOL, 2,
+                    kpmtest::TEST_K, 10, numa_num_task_nodes(), 2, "forgy", 0);
+        std::vector<unsigned> asgns(kpmtest::TEST_NROW);
+        std::vector<size_t> counts(kpmtest::TEST_K);
+        std::vector<double> means(kpmtest::TEST_K*kpmtest::TEST_NCOL);
+        bool threw = false;
+        try {
+            xc->run_kmeans(&asgns[0], &counts[0], &means[0]);
+        } catch (kpmbase::not_implemented_exception& e) {
+            threw = true;
+        }
+        BOOST_VERIFY(threw);
+        BOOST_VERIFY(xc->get_cluster_assignments() != &asgns[0]);
+        std::cout << "\n***In memory passed ***\n";
+    }
+
+    /////////////////////////// Weights ///////////////////////////
+    {
+        std::vector<double> weights(kpmtest::TEST_NROW);
+        for (size_t row = 0; row < kpmtest::TEST_NROW; row++)
+            weights[row] = .5 + (row % 4);
+
+        std::vector<double> centers(kpmtest::TEST_K*kpmtest::TEST_NCOL);
+        kpmbase::bin_io<double> bc(kpmtest::TEST_INIT_CLUSTERS,
+                kpmtest::TEST_K, kpmtest::TEST_NCOL);
+        bc.read(&centers[0]);
+        std::vector<double> omp_centers = centers;
+        std::vector<unsigned> omp_asgns(kpmtest::TEST_NROW);
+        std::vector<size_t> omp_asgn_cnt(kpmtest::TEST_K);
+
+        kpmbase::kmeans_t omp_ret = kpmeans::omp::compute_kmeans(&p_data[0],
+                &omp_centers[0], &omp_asgns[0], &omp_asgn_cnt[0],
+                kpmtest::TEST_NROW, kpmtest::TEST_NCOL, kpmtest::TEST_K, 10, 2,
+                "none", 0, "eucl", 1, &weights[0]);
+
+        kpmeans::base_kmeans_coordinator::ptr kcs[] = {
+            kpmprune::kmeans_task_coordinator::create(kpmtest::TESTDATA_FN,
+                    kpmtest::TEST_NROW, kpmtest::TEST_NCOL, kpmtest::TEST_K,
+                    10, numa_num_task_nodes(), 2, &centers[0], "none", 0),
+            kpmeans::kmeans_coordinator::create(kpmtest::TESTDATA_FN,
+                    kpmtest::TEST_NROW, kpmtest::TEST_NCOL, kpmtest::TEST_K,
+                    10, numa_num_task_nodes(), 2, &centers[0], "none", 0)
+        };
+
+        for (unsigned i = 0; i < 2; i++) {
+            kcs[i]->set_weights(&weights[0]);
+            kpmbase::kmeans_t ret = kcs[i]->run_kmeans();
+            BOOST_VERIFY(std::equal(ret.assignments.begin(),
+                        ret.assignments.end(), omp_ret.assignments.begin()));
+            BOOST_VERIFY(kpmtest::check_collection_equal(
+                        ret.centroids.begin(), ret.centroids.end(),
+                        omp_ret.centroids.begin(), omp_ret.centroids.end(),
+                        kpmtest::TEST_TOL));
+        }
+        std::cout << "\n***Weights passed ***\n";
+    }
+
+    /////////////////////////// Center index ///////////////////////////
+    {
+        kpmbase::kmeans_t scan = kpmtest::run_test(kpmtest::TESTDATA_FN,
+                &p_centers[0], &p_clust_asgn_cnt[0], &p_clust_asgns[0],
+                false, "none", 10);
+
+        kpmbase::bin_io<double> bc(kpmtest::TEST_INIT_CLUSTERS,
+                kpmtest::TEST_K, kpmtest::TEST_NCOL);
+        bc.read(&p_centers[0]);
+        kpmeans::base_kmeans_coordinator::ptr kc =
+            kpmeans::kmeans_coordinator::create(kpmtest::TESTDATA_FN,
+                    kpmtest::TEST_NROW, kpmtest::TEST_NCOL, kpmtest::TEST_K,
+                    10, numa_num_task_nodes(), 2, &p_centers[0], "none", 0);
+        std::static_pointer_cast<kpmeans::kmeans_coordinator>(kc)->
+            set_index_checks(0);
+        kpmbase::kmeans_t indexed = kc->run_kmeans();
+
+        BOOST_VERIFY(std::equal(scan.assignments.begin(),
+                    scan.assignments.end(), indexed.assignments.begin()));
+        BOOST_VERIFY(kpmtest::check_collection_equal(
+                    scan.centroids.begin(), scan.centroids.end(),
+                    indexed.centroids.begin(), indexed.centroids.end(),
+                    kpmtest::TEST_TOL));
+        std::cout << "\n***Center index passed ***\n";
+    }
+
+    /////////////////////////// Warm start ///////////////////////////
+    {
+        constexpr size_t OLD_NROW = 40; // The rest are "appended"
+        std::vector<double> centers(kpmtest::TEST_K*kpmtest::TEST_NCOL);
+        kpmbase::bin_io<double> bc(kpmtest::TEST_INIT_CLUSTERS,
+                kpmtest::TEST_K, kpmtest::TEST_NCOL);
+        bc.read(&centers[0]);
+
+        kpmeans::base_kmeans_coordinator::ptr kc =
+            kpmprune::kmeans_task_coordinator::create(kpmtest::TESTDATA_FN,
+                    OLD_NROW, kpmtest::TEST_NCOL, kpmtest::TEST_K, 100,
+                    numa_num_task_nodes(), 2, &centers[0], "none", 0);
+        kpmbase::kmeans_t old = kc->run_kmeans();
+        std::vector<double> bounds;
+        std::static_pointer_cast<kpmprune::kmeans_task_coordinator>(kc)->
+            get_bounds(bounds);
+        for (size_t row = 0; row < OLD_NROW; row++)
+            BOOST_VERIFY(kpmbase::eucl_dist(&p_data[row*kpmtest::TEST_NCOL],
+                        &old.centroids[old.assignments[row]*
+                        kpmtest::TEST_NCOL], kpmtest::TEST_NCOL) <=
+                    bounds[row] + kpmtest::TEST_TOL);
+
+        const std::string modelfn = "test_warm_start_model.bin";
+        old.write_model(modelfn, bounds);
+        std::vector<double> read_bounds;
+        kpmbase::kmeans_t read = kpmbase::kmeans_t::read_model(modelfn,
+                read_bounds);
+        remove(modelfn.c_str());
+        BOOST_VERIFY(read == old && read.iters == old.iters);
+        BOOST_VERIFY(read_bounds == bounds);
+
+        // With & without the stored bounds
+        kpmbase::kmeans_t warm[2];
+        for (unsigned i = 0; i < 2; i++) {
+            kpmeans::base_kmeans_coordinator::ptr wkc =
+                kpmprune::kmeans_task_coordinator::create(
+                        kpmtest::TESTDATA_FN, kpmtest::TEST_NROW,
+                        kpmtest::TEST_NCOL, kpmtest::TEST_K, 100,
+                        numa_num_task_nodes(), 2, NULL, "kmeanspp", 0);
+            std::static_pointer_cast<kpmprune::kmeans_task_coordinator>(wkc)->
+                set_warm_start(read, i ? std::vector<double>() : read_bounds);
+            warm[i] = wkc->run_kmeans();
+        }
+        BOOST_VERIFY(warm[0] == warm[1]);
+
+        // Converged: every row sits on its nearest centroid
+        for (size_t row = 0; row < kpmtest::TEST_NROW; row++) {
+            unsigned best = kpmbase::INVALID_CLUSTER_ID;
+            double best_dist = std::numeric_limits<double>::max();
+            for (unsigned clust = 0; clust < kpmtest::TEST_K; clust++) {
+                double dist = kpmbase::eucl_dist(
+                        &p_data[row*kpmtest::TEST_NCOL],
+                        &warm[0].centroids[clust*kpmtest::TEST_NCOL],
+                        kpmtest::TEST_NCOL);
+                if (dist < best_dist) {
+                    best_dist = dist;
+                    best = clust;
+                }
+            }
+            BOOST_VERIFY(warm[0].assignments[row] == best);
+        }
+
+        // A model of another shape or a damaged file is refused
+        kpmbase::kmeans_t small_k = kpmprune::kmeans_task_coordinator::create(
+                kpmtest::TESTDATA_FN, OLD_NROW, kpmtest::TEST_NCOL,
+                kpmtest::TEST_K-1, 10, numa_num_task_nodes(), 2, NULL,
+                "forgy", 0)->run_kmeans();
+        kpmeans::base_kmeans_coordinator::ptr wkc =
+            kpmprune::kmeans_task_coordinator::create(kpmtest::TESTDATA_FN,
+                    kpmtest::TEST_NROW, kpmtest::TEST_NCOL, kpmtest::TEST_K,
+                    100, numa_num_task_nodes(), 2, NULL, "kmeanspp", 0);
+        kpmprune::kmeans_task_coordinator& wengine =
+            *std::static_pointer_cast<kpmprune::kmeans_task_coordinator>(wkc);
+        BOOST_VERIFY(kpmtest::throws<kpmbase::parameter_exception>([&] {
+                    wengine.set_warm_start(small_k, std::vector<double>()); }));
+        kpmbase::kmeans_t bad_asgn = old;
+        bad_asgn.assignments[0] = kpmtest::TEST_K;
+        BOOST_VERIFY(kpmtest::throws<kpmbase::parameter_exception>([&] {
+                    wengine.set_warm_start(bad_asgn, std::vector<double>()); }));
+        BOOST_VERIFY(kpmtest::throws<kpmbase::parameter_exception>([&] {
+                    wengine.set_warm_start(old, std::vector<double>(1)); }));
+
+        BOOST_VERIFY(kpmtest::throws<kpmbase::io_exception>([&] {
+                    kpmbase::kmeans_t::read_model(modelfn, read_bounds); }));
+        old.write_model(modelfn, bounds);
+        BOOST_VERIFY(truncate(modelfn.c_str(),
+                    kpmbase::filesize(modelfn.c_str()) - 1) == 0);
+        BOOST_VERIFY(kpmtest::throws<kpmbase::io_exception>([&] {
+                    kpmbase::kmeans_t::read_model(modelfn, read_bounds); }));
+        BOOST_VERIFY(truncate(modelfn.c_str(), 3) == 0);
+        BOOST_VERIFY(kpmtest::throws<kpmbase::io_exception>([&] {
+                    kpmbase::kmeans_t::read_model(modelfn, read_bounds); }));
+        remove(modelfn.c_str());
+        std::cout << "\n***Warm start passed ***\n";
+    }
+
+    /////////////////////////// Objective ///////////////////////////
+    {
+        std::vector<double> centers(kpmtest::TEST_K*kpmtest::TEST_NCOL);
+        kpmbase::bin_io<double> bc(kpmtest::TEST_INIT_CLUSTERS,
+                kpmtest::TEST_K, kpmtest::TEST_NCOL);
+        bc.read(&centers[0]);
+
+        for (unsigned prune = 0; prune < 2; prune++) {
+            kpmeans::base_kmeans_coordinator::ptr kcs[3];
+            for (unsigned i = 0; i < 3; i++)
+                kcs[i] = prune ?
+                    kpmprune::kmeans_task_coordinator::create(
+                            kpmtest::TESTDATA_FN, kpmtest::TEST_NROW,
+                            kpmtest::TEST_NCOL, kpmtest::TEST_K, 100,
+                            numa_num_task_nodes(), 2, &centers[0], "none", 0) :
+                    kpmeans::kmeans_coordinator::create(kpmtest::TESTDATA_FN,
+                            kpmtest::TEST_NROW, kpmtest::TEST_NCOL,
+                            kpmtest::TEST_K, 100, numa_num_task_nodes(), 2,
+                            &centers[0], "none", 0);
+
+            kcs[0]->set_exact_sse(true);
+            kpmbase::kmeans_t full = kcs[0]->run_kmeans();
+
+            // Lloyd's never increases the objective
+            const std::vector<double> sse = kcs[0]->get_sse_history();
+            BOOST_VERIFY(sse.size() == full.iters);
+            for (unsigned i = 1; i < sse.size(); i++)
+                BOOST_VERIFY(sse[i] <= sse[i-1] + kpmtest::TEST_TOL);
+            if (prune) // Against the final centers
+                BOOST_VERIFY(fabs(sse.back() - kpmbase::get_sse(&p_data[0],
+                                &full.centroids[0], &full.assignments[0],
+                                kpmtest::TEST_NROW, kpmtest::TEST_NCOL, 2))
+                        <= kpmtest::TEST_TOL);
+
+            // Any shift is small enough => stop after the first update
+            kcs[1]->set_shift_tolerance(std::numeric_limits<double>::max());
+            BOOST_VERIFY(kcs[1]->run_kmeans().iters == (prune ? 2 : 1));
+
+            // A loose SSE rule stops no later than full convergence
+            kcs[2]->set_sse_tolerance(.5);
+            BOOST_VERIFY(kcs[2]->run_kmeans().iters <= full.iters);
+        }
+        std::cout << "\n***Objective passed ***\n";
+    }
+
+    /////////////////////////// X-means ///////////////////////////
+    {
+        // 2 tight, distant blobs favor the split. 1 blob does not
+        BOOST_VERIFY(kpmbase::get_xmeans_bic(std::vector<double> {25, 25},
+                    2*25*kpmtest::TEST_NCOL, kpmtest::TEST_NCOL) >
+                kpmbase::get_xmeans_bic(std::vector<double>(1, 50),
+                    2*25*kpmtest::TEST_NCOL + 50*100, kpmtest::TEST_NCOL));
+
+        // 4 tight blobs far apart. Growing from 2 centers must find them all
+        constexpr unsigned NBLOB = 4, BLOB_NROW = 25;
+        constexpr size_t NROW = NBLOB*BLOB_NROW;
+        const std::string blobfn = "test_xmeans_blobs.bin";
+        std::vector<double> blobs(NROW*kpmtest::TEST_NCOL);
+        std::default_random_engine generator;
+        std::uniform_real_distribution<double> noise(-1, 1);
+        for (size_t row = 0; row < NROW; row++)
+            for (size_t col = 0; col < kpmtest::TEST_NCOL; col++)
+                blobs[row*kpmtest::TEST_NCOL+col] = 100*(row/BLOB_NROW) +
+                    noise(generator);
+        {
+            kpmbase::bin_io<double> bw(blobfn, "wb");
+            bw.write(blobs, blobs.size());
+        }
+
+        kpmprune::kmeans_xmeans_coordinator::ptr xc =
+            kpmprune::kmeans_xmeans_coordinator::create(blobfn, NROW,
+                    kpmtest::TEST_NCOL, 2, kpmtest::TEST_K, 100,
+                    numa_num_task_nodes(), 2, "forgy", 0);
+        kpmbase::kmeans_t ret = xc->run_kmeans();
+        remove(blobfn.c_str());
+
+        const std::vector<unsigned>& ks = xc->get_k_history();
+        BOOST_VERIFY(ks.front() == 2 && ks.back() == ret.k);
+        BOOST_VERIFY(ret.k >= NBLOB && ret.k <= kpmtest::TEST_K);
+        for (unsigned i = 1; i < ks.size(); i++)
+            BOOST_VERIFY(ks[i] > ks[i-1]);
+
+        // No cluster straddles 2 blobs
+        std::vector<size_t> counts(ret.k, 0);
+        std::vector<unsigned> blob_of(ret.k, NBLOB);
+        for (size_t row = 0; row < NROW; row++) {
+            unsigned clust_idx = ret.assignments[row];
+            BOOST_VERIFY(clust_idx < ret.k);
+            counts[clust_idx]++;
+            if (blob_of[clust_idx] == NBLOB)
+                blob_of[clust_idx] = row/BLOB_NROW;
+            BOOST_VERIFY(blob_of[clust_idx] == row/BLOB_NROW);
+        }
+        BOOST_VERIFY(std::equal(counts.begin(), counts.end(),
+                    ret.assignment_count.begin()));
+
+        // Unit weights size the BIC by weight totals equal to the counts
+        {
+            kpmbase::bin_io<double> bw(blobfn, "wb");
+            bw.write(blobs, blobs.size());
+        }
+        std::vector<double> ones(NROW, 1);
+        kpmprune::kmeans_xmeans_coordinator::ptr wxc =
+            kpmprune::kmeans_xmeans_coordinator::create(blobfn, NROW,
+                    kpmtest::TEST_NCOL, 2, kpmtest::TEST_K, 100,
+                    numa_num_task_nodes(), 2, "forgy", 0);
+        wxc->set_weights(&ones[0]);
+        kpmbase::kmeans_t wret = wxc->run_kmeans();
+        remove(blobfn.c_str());
+        BOOST_VERIFY(wret == ret);
+        BOOST_VERIFY(wxc->get_k_history() == ks);
+        std::cout << "\n***X-means passed (k = " << ret.k << ") ***\n";
+    }
+
+    /////////////////////////// Mapped input ///////////////////////////
+    {
+        // The same data with a header is mapped by the threads, not read
+        const std::string hdrfn = "test_mapped_data.bin";
+        kpmbase::write_matrix(hdrfn, &p_data[0], kpmtest::TEST_NROW,
+                kpmtest::TEST_NCOL);
+
+        for (unsigned prune = 0; prune < 2; prune++) {
+            kpmbase::kmeans_t rets[2];
+            for (unsigned mapped = 0; mapped < 2; mapped++) {
+                const std::string fn = mapped ? hdrfn : kpmtest::TESTDATA_FN;
+                rets[mapped] = (prune ?
+                    kpmprune::kmeans_task_coordinator::create(fn,
+                            kpmtest::TEST_NROW, kpmtest::TEST_NCOL,
+                            kpmtest::TEST_K, 10, numa_num_task_nodes(), 2,
+                            NULL, "forgy", 0) :
+                    kpmeans::kmeans_coordinator::create(fn,
+                            kpmtest::TEST_NROW, kpmtest::TEST_NCOL,
+                            kpmtest::TEST_K, 10, numa_num_task_nodes(), 2,
+                            NULL, "forgy", 0))->run_kmeans();
+            }
+            BOOST_VERIFY(rets[0] == rets[1]);
+        }
+        remove(hdrfn.c_str());
+        std::cout << "\n***Mapped input passed ***\n";
+    }
+
+    /////////////////////////// Bad arguments ///////////////////////////
+    {
+        kpmeans::base_kmeans_coordinator::ptr kc =
+            kpmprune::kmeans_task_coordinator::create(kpmtest::TESTDATA_FN,
+                    kpmtest::TEST_NROW, kpmtest::TEST_NCOL, kpmtest::TEST_K,
+                    10, numa_num_task_nodes(), 2, NULL, "subsample", 0);
+        for (double frac : {0., -.5, 5.})
+            BOOST_VERIFY(kpmtest::throws<kpmbase::parameter_exception>(
+                        [&] { kc->set_sample_frac(frac); }));
+        kc->set_sample_frac(1);
+
+        kpmprune::kmeans_task_coordinator& engine =
+            *std::static_pointer_cast<kpmprune::kmeans_task_coordinator>(kc);
+        for (unsigned bad_k : {0U, 1U, unsigned(kpmtest::TEST_NROW+1)})
+            BOOST_VERIFY(kpmtest::throws<kpmbase::parameter_exception>([&] {
+                        engine.run_kmeans(bad_k, "forgy", 10, 0); }));
+        BOOST_VERIFY(kpmtest::throws<kpmbase::parameter_exception>([&] {
+                    engine.run_kmeans(kpmtest::TEST_K, "none", 10, 0); }));
+
+        BOOST_VERIFY(kpmtest::throws<kpmbase::not_implemented_exception>([] {
+                    kpmprune::kmeans_minibatch_coordinator::create(
+                        kpmtest::TESTDATA_FN, kpmtest::TEST_NROW,
+                        kpmtest::TEST_NCOL, kpmtest::TEST_K, 5,
+                        numa_num_task_nodes(), 2, kpmtest::TEST_NROW/4, NULL,
+                        "forgy", -1, "cos"); }));
+        std::cout << "\n***Bad arguments passed ***\n";
+    }
     return EXIT_SUCCESS;
 }
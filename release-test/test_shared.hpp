@@ -43,6 +43,17 @@ namespace kpmeans { namespace test {
         br.read(buff);
     }
 
+    // Whether `fn' throws an `E'
+    template <typename E, typename F>
+    bool throws(F fn) {
+        try {
+            fn();
+        } catch (E& e) {
+            return true;
+        }
+        return false;
+    }
+
 void init_log() {
     namespace logging = boost::log;
 